@@ -0,0 +1,360 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "discovery-service.h"
+#include "event-log.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <callback/calldata.h>
+#include <callback/proc.h>
+#include <callback/signal.h>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QTimer>
+#include <atomic>
+#include <mutex>
+
+static const char *kSignalDecls[] = {
+	"void holyrics_finder_endpoint_changed(string ip, int port, float rtt_ms)",
+	"void holyrics_finder_scan_finished(int request_id, bool found, string ip, int port, string error)",
+	"void holyrics_finder_sources_rebound(string ip, int port, int count)",
+	nullptr,
+};
+
+// What a lookup returns. Written on the UI thread, read from any thread.
+struct Snapshot {
+	bool found = false;
+	QByteArray ip;
+	int port = 0;
+	double rttMs = 0.0;
+	QByteArray url;
+	QByteArray endpointsJson = "[]";
+};
+
+static std::mutex s_mutex;
+static Snapshot s_snapshot;
+// Procedures can't be removed from the global proc handler, so they
+// outlive the service and check this before queuing anything
+static DiscoveryService *s_service = nullptr;
+static std::atomic<long long> s_nextRequestId{1};
+
+DiscoveryService::DiscoveryService(HolyricsFinder *finder, QObject *parent)
+	: QObject(parent),
+	  m_finder(finder),
+	  m_running(false),
+	  m_scanRequest(0)
+{
+}
+
+DiscoveryService::~DiscoveryService()
+{
+	stop();
+}
+
+void DiscoveryService::start()
+{
+	if (m_running) {
+		return;
+	}
+
+	m_running = true;
+	registerProcedures();
+
+	connect(m_finder, &HolyricsFinder::connectionSuccess, this, &DiscoveryService::refresh);
+	connect(m_finder, &HolyricsFinder::endpointsRanked, this, &DiscoveryService::refresh);
+
+	// A scan someone else started answers the requests that were waiting
+	// on it; connectionSuccess follows scanComplete, so look afterwards
+	connect(m_finder, &HolyricsFinder::scanComplete, this, [this]() {
+		if (!m_waitingOnForeignScan.isEmpty() && !m_scanRequest) {
+			QTimer::singleShot(0, this, &DiscoveryService::answerFromSnapshot);
+		}
+	});
+
+	refresh();
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_service = this;
+	}
+	obs_log(LOG_INFO, "[Discovery] Serving endpoint lookups to other plugins and scripts");
+}
+
+void DiscoveryService::stop()
+{
+	if (!m_running) {
+		return;
+	}
+
+	m_running = false;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_service = nullptr;
+		s_snapshot = Snapshot();
+	}
+
+	m_finder->disconnect(this);
+	quint64 scanRequest = m_scanRequest;
+	m_scanRequest = 0;
+	m_finder->cancelRequest(scanRequest);
+	m_tickets.clear();
+	m_waitingOnForeignScan.clear();
+}
+
+void DiscoveryService::refresh()
+{
+	Snapshot snapshot;
+	QJsonArray endpoints;
+
+	// Ranked hosts first (fastest first), then the rest of the history
+	QSet<QString> listed;
+	for (const HolyricsFinder::EndpointStats &stats : m_finder->getEndpointRanking()) {
+		listed.insert(HolyricsFinder::formatEndpoint(stats.ip, stats.port));
+		QJsonObject object;
+		object["ip"] = stats.ip;
+		object["port"] = stats.port;
+		object["rtt_ms"] = stats.medianRttMs;
+		endpoints.append(object);
+	}
+
+	QList<HolyricsFinder::ConnectionInfo> history = m_finder->getConnectionHistory();
+	for (const HolyricsFinder::ConnectionInfo &endpoint : history) {
+		if (!listed.contains(HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port))) {
+			QJsonObject object;
+			object["ip"] = endpoint.ip;
+			object["port"] = endpoint.port;
+			endpoints.append(object);
+		}
+	}
+	snapshot.endpointsJson = QJsonDocument(endpoints).toJson(QJsonDocument::Compact);
+
+	if (!history.isEmpty()) {
+		HolyricsFinder::ConnectionInfo current = m_finder->preferredEndpoint(history[0].ip, history[0].port);
+		snapshot.found = true;
+		snapshot.ip = current.ip.toUtf8();
+		snapshot.port = current.port;
+		snapshot.url = HolyricsFinder::buildUrl(current.ip, current.port, "/").toUtf8();
+		for (const HolyricsFinder::EndpointStats &stats : m_finder->getEndpointRanking()) {
+			if (stats.ip == current.ip && stats.port == current.port) {
+				snapshot.rttMs = stats.medianRttMs;
+			}
+		}
+	}
+
+	bool changed;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		changed = snapshot.found && (snapshot.ip != s_snapshot.ip || snapshot.port != s_snapshot.port);
+		s_snapshot = snapshot;
+	}
+
+	if (changed) {
+		EventLog::info("discovery", QString("Current Holyrics endpoint is %1")
+						    .arg(HolyricsFinder::formatEndpoint(QString::fromUtf8(snapshot.ip),
+											snapshot.port)));
+
+		calldata_t cd = {};
+		calldata_set_string(&cd, "ip", snapshot.ip.constData());
+		calldata_set_int(&cd, "port", snapshot.port);
+		calldata_set_float(&cd, "rtt_ms", snapshot.rttMs);
+		signal_handler_signal(obs_get_signal_handler(), "holyrics_finder_endpoint_changed", &cd);
+		calldata_free(&cd);
+	}
+}
+
+void DiscoveryService::requestScan(const Ticket &ticket)
+{
+	if (!m_running) {
+		return;
+	}
+
+	// Everyone asking while a scan runs shares it instead of starting another
+	if (m_scanRequest) {
+		m_tickets.append(ticket);
+	} else if (m_finder->isScanning()) {
+		m_waitingOnForeignScan.append(ticket);
+	} else {
+		m_tickets.append(ticket);
+		startScan();
+	}
+}
+
+void DiscoveryService::startScan()
+{
+	const Ticket &ticket = m_tickets.first();
+
+	int port = ticket.port;
+	if (port <= 0) {
+		QList<HolyricsFinder::ConnectionInfo> history = m_finder->getConnectionHistory();
+		port = history.isEmpty() ? 80 : history[0].port;
+	}
+
+	EventLog::info("discovery", QString("Scan %1 requested for %2")
+					    .arg(ticket.id)
+					    .arg(ticket.ip.isEmpty() ? QString("all interfaces")
+								     : HolyricsFinder::formatEndpoint(ticket.ip, port)));
+
+	HolyricsFinder::Request<HolyricsFinder::ScanResult> request = m_finder->scan(ticket.ip, port);
+	m_scanRequest = request.id;
+	request.future.then(this, [this](const HolyricsFinder::ScanResult &result) { onScanFinished(result); });
+}
+
+void DiscoveryService::onScanFinished(const HolyricsFinder::ScanResult &result)
+{
+	if (result.requestId != m_scanRequest) {
+		return;
+	}
+	m_scanRequest = 0;
+
+	// The dialog (or the verifier) took the scanner over; its result will do
+	if (result.error == "superseded") {
+		m_waitingOnForeignScan.append(m_tickets);
+		m_tickets.clear();
+		if (!m_finder->isScanning()) {
+			answerFromSnapshot();
+		}
+		return;
+	}
+
+	const QList<Ticket> tickets = m_tickets;
+	m_tickets.clear();
+
+	HolyricsFinder::ConnectionInfo hit{QString(), 0};
+	if (!result.found.isEmpty()) {
+		hit = result.found.first().endpoint;
+	}
+	QString error = result.error;
+	if (error.isEmpty() && result.found.isEmpty()) {
+		error = "not found";
+	}
+
+	for (const Ticket &ticket : tickets) {
+		signalScanFinished(ticket.id, error.isEmpty(), hit.ip, hit.port, error);
+	}
+}
+
+void DiscoveryService::answerFromSnapshot()
+{
+	const QList<Ticket> tickets = m_waitingOnForeignScan;
+	m_waitingOnForeignScan.clear();
+
+	Snapshot snapshot;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		snapshot = s_snapshot;
+	}
+
+	for (const Ticket &ticket : tickets) {
+		signalScanFinished(ticket.id, snapshot.found, QString::fromUtf8(snapshot.ip), snapshot.port,
+				   snapshot.found ? QString() : QString("not found"));
+	}
+}
+
+void DiscoveryService::rebind(const QString &ip, int port)
+{
+	if (!m_running) {
+		return;
+	}
+
+	int count = m_finder->rebindSources({}, {ip, port});
+
+	calldata_t cd = {};
+	calldata_set_string(&cd, "ip", ip.toUtf8().constData());
+	calldata_set_int(&cd, "port", port);
+	calldata_set_int(&cd, "count", count);
+	signal_handler_signal(obs_get_signal_handler(), "holyrics_finder_sources_rebound", &cd);
+	calldata_free(&cd);
+}
+
+void DiscoveryService::signalScanFinished(long long id, bool found, const QString &ip, int port,
+					  const QString &error)
+{
+	calldata_t cd = {};
+	calldata_set_int(&cd, "request_id", id);
+	calldata_set_bool(&cd, "found", found);
+	calldata_set_string(&cd, "ip", ip.toUtf8().constData());
+	calldata_set_int(&cd, "port", port);
+	calldata_set_string(&cd, "error", error.toUtf8().constData());
+	signal_handler_signal(obs_get_signal_handler(), "holyrics_finder_scan_finished", &cd);
+	calldata_free(&cd);
+}
+
+void DiscoveryService::registerProcedures()
+{
+	static bool registered = false;
+	if (registered) {
+		return;
+	}
+	registered = true;
+
+	signal_handler_add_array(obs_get_signal_handler(), kSignalDecls);
+
+	proc_handler_t *handler = obs_get_proc_handler();
+	proc_handler_add(handler,
+			 "void holyrics_finder_get_endpoint(out bool found, out string ip, out int port, "
+			 "out string url, out float rtt_ms)",
+			 getEndpoint, nullptr);
+	proc_handler_add(handler, "void holyrics_finder_list_endpoints(out string endpoints)", listEndpoints,
+			 nullptr);
+	proc_handler_add(handler, "void holyrics_finder_scan(in string ip, in int port, out int request_id)", scanProc,
+			 nullptr);
+	proc_handler_add(handler, "void holyrics_finder_rebind(in string ip, in int port, out bool accepted)",
+			 rebindProc, nullptr);
+}
+
+void DiscoveryService::getEndpoint(void *, calldata_t *cd)
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	calldata_set_bool(cd, "found", s_snapshot.found);
+	calldata_set_string(cd, "ip", s_snapshot.ip.constData());
+	calldata_set_int(cd, "port", s_snapshot.port);
+	calldata_set_string(cd, "url", s_snapshot.url.constData());
+	calldata_set_float(cd, "rtt_ms", s_snapshot.rttMs);
+}
+
+void DiscoveryService::listEndpoints(void *, calldata_t *cd)
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+	calldata_set_string(cd, "endpoints", s_snapshot.endpointsJson.constData());
+}
+
+void DiscoveryService::scanProc(void *, calldata_t *cd)
+{
+	Ticket ticket{s_nextRequestId.fetch_add(1), QString::fromUtf8(calldata_string(cd, "ip")),
+		      static_cast<int>(calldata_int(cd, "port"))};
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	if (!s_service) {
+		calldata_set_int(cd, "request_id", 0);
+		return;
+	}
+
+	// Callers can be on any thread; the scan itself belongs to the UI thread
+	DiscoveryService *service = s_service;
+	QMetaObject::invokeMethod(service, [service, ticket]() { service->requestScan(ticket); }, Qt::QueuedConnection);
+	calldata_set_int(cd, "request_id", ticket.id);
+}
+
+void DiscoveryService::rebindProc(void *, calldata_t *cd)
+{
+	QString ip = QString::fromUtf8(calldata_string(cd, "ip"));
+	int port = static_cast<int>(calldata_int(cd, "port"));
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	if (!s_service || ip.isEmpty() || port <= 0 || port > 65535) {
+		calldata_set_bool(cd, "accepted", false);
+		return;
+	}
+
+	DiscoveryService *service = s_service;
+	QMetaObject::invokeMethod(service, [service, ip, port]() { service->rebind(ip, port); }, Qt::QueuedConnection);
+	calldata_set_bool(cd, "accepted", true);
+}
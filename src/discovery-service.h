@@ -0,0 +1,76 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "holyrics-finder.h"
+#include <QObject>
+#include <QList>
+#include <QString>
+
+struct calldata;
+typedef struct calldata calldata_t;
+
+// Answers "where is Holyrics?" for scripts and other plugins through the
+// global OBS proc handler, so they don't have to sweep the LAN themselves:
+//
+//   holyrics_finder_get_endpoint(out bool found, out string ip, out int port,
+//                                out string url, out float rtt_ms)
+//   holyrics_finder_list_endpoints(out string endpoints)   JSON array
+//   holyrics_finder_scan(in string ip, in int port, out int request_id)
+//   holyrics_finder_rebind(in string ip, in int port, out bool accepted)
+//
+// Lookups read a snapshot kept up to date from the finder's own signals,
+// so they never touch the network and can be called from any thread.
+// Scans and rebinds run on the UI thread; their outcome comes back as a
+// signal on the global signal handler:
+//
+//   holyrics_finder_endpoint_changed(string ip, int port, float rtt_ms)
+//   holyrics_finder_scan_finished(int request_id, bool found, string ip, int port, string error)
+//   holyrics_finder_sources_rebound(string ip, int port, int count)
+class DiscoveryService : public QObject {
+	Q_OBJECT
+
+public:
+	explicit DiscoveryService(HolyricsFinder *finder, QObject *parent = nullptr);
+	~DiscoveryService();
+
+	void start();
+	void stop();
+
+	// Re-reads history and ranking into the snapshot
+	void refresh();
+
+private:
+	struct Ticket {
+		long long id;
+		QString ip;
+		int port;
+	};
+
+	HolyricsFinder *m_finder;
+	bool m_running;
+	quint64 m_scanRequest;
+	QList<Ticket> m_tickets;
+	QList<Ticket> m_waitingOnForeignScan;
+
+	void requestScan(const Ticket &ticket);
+	void startScan();
+	void onScanFinished(const HolyricsFinder::ScanResult &result);
+	void answerFromSnapshot();
+	void rebind(const QString &ip, int port);
+
+	static void registerProcedures();
+	static void getEndpoint(void *data, calldata_t *cd);
+	static void listEndpoints(void *data, calldata_t *cd);
+	static void scanProc(void *data, calldata_t *cd);
+	static void rebindProc(void *data, calldata_t *cd);
+	static void signalScanFinished(long long id, bool found, const QString &ip, int port, const QString &error);
+};
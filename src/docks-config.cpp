@@ -0,0 +1,341 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "docks-config.h"
+#include "event-log.h"
+#include "trace.h"
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+#include <plugin-support.h>
+#include <util/config-file.h>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <cstring>
+
+namespace DocksConfig {
+
+static const char *kSection = "BasicWindow";
+static const char *kKey = "ExtraBrowserDocks";
+
+static bool readJson(QString &json)
+{
+	config_t *config = obs_frontend_get_user_config();
+	if (config) {
+		const char *value = config_get_string(config, kSection, kKey);
+		json = QString::fromUtf8(value ? value : "");
+		return true;
+	}
+
+	QString userIniPath = obsConfigPath() + "/user.ini";
+	EventLog::detail("docks", QString("Looking for OBS user.ini at: %1").arg(userIniPath));
+
+	QFile file(userIniPath);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		EventLog::warning("docks", "OBS user.ini not found or cannot be opened");
+		return false;
+	}
+
+	QTextStream in(&file);
+	while (!in.atEnd()) {
+		QString line = in.readLine().trimmed();
+		if (line.startsWith(QString("%1=").arg(kKey))) {
+			json = line.mid(static_cast<int>(strlen(kKey)) + 1);
+			break;
+		}
+	}
+	return true;
+}
+
+// from endpoint -> to endpoint, for reapplyRewrites()
+static QHash<QString, HolyricsFinder::ConnectionInfo> s_rewrites;
+
+static bool writeJson(const QString &json)
+{
+	config_t *config = obs_frontend_get_user_config();
+	if (config) {
+		config_set_string(config, kSection, kKey, json.toUtf8().constData());
+		// Written to a temp file and renamed over user.ini
+		return config_save_safe(config, "tmp", nullptr) == CONFIG_SUCCESS;
+	}
+
+	QString userIniPath = obsConfigPath() + "/user.ini";
+	QFile file(userIniPath);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return false;
+	}
+	QStringList lines = QString::fromUtf8(file.readAll()).split('\n');
+	file.close();
+
+	QString prefix = QString("%1=").arg(kKey);
+	bool replaced = false;
+	for (QString &line : lines) {
+		if (line.trimmed().startsWith(prefix)) {
+			line = prefix + json;
+			replaced = true;
+			break;
+		}
+	}
+	if (!replaced) {
+		return false;
+	}
+
+	QSaveFile out(userIniPath);
+	return out.open(QIODevice::WriteOnly | QIODevice::Text) && out.write(lines.join('\n').toUtf8()) >= 0 &&
+	       out.commit();
+}
+
+// Where a string value sits in the raw JSON, quotes included
+struct Span {
+	qsizetype start = -1;
+	qsizetype length = 0;
+};
+
+struct DockSpans {
+	Span title;
+	Span url;
+};
+
+// Index just past the string opening at `at`, or -1 if it never closes
+static qsizetype skipString(const QByteArray &json, qsizetype at)
+{
+	for (qsizetype i = at + 1; i < json.size(); ++i) {
+		if (json[i] == '\\') {
+			++i;
+		} else if (json[i] == '"') {
+			return i + 1;
+		}
+	}
+	return -1;
+}
+
+// Finds the "title" and "url" strings of each object in the top-level
+// array, so a rewrite can replace those bytes and leave the rest of what
+// OBS wrote (key order, spacing, escapes, fields we don't know) untouched
+static QList<DockSpans> scanDocks(const QByteArray &json)
+{
+	QList<DockSpans> docks;
+	int depth = 0;
+	bool inObject = false;
+	bool expectKey = false;
+	Span *valueSpan = nullptr;
+
+	for (qsizetype i = 0; i < json.size(); ++i) {
+		char c = json[i];
+		if (c == '"') {
+			qsizetype end = skipString(json, i);
+			if (end < 0) {
+				return {};
+			}
+			if (depth == 2 && inObject) {
+				if (expectKey) {
+					QByteArray key = json.mid(i + 1, end - i - 2);
+					if (key == "url") {
+						valueSpan = &docks.last().url;
+					} else if (key == "title") {
+						valueSpan = &docks.last().title;
+					}
+					expectKey = false;
+				} else if (valueSpan) {
+					*valueSpan = {i, end - i};
+					valueSpan = nullptr;
+				}
+			}
+			i = end - 1;
+		} else if (c == '{' || c == '[') {
+			if (++depth == 2) {
+				docks.append(DockSpans());
+				inObject = c == '{';
+				expectKey = inObject;
+				valueSpan = nullptr;
+			}
+		} else if (c == '}' || c == ']') {
+			--depth;
+		} else if (c == ',' && depth == 2) {
+			expectKey = inObject;
+			valueSpan = nullptr;
+		}
+	}
+	return docks;
+}
+
+static QString decodeString(const QByteArray &json, const Span &span)
+{
+	if (span.start < 0) {
+		return QString();
+	}
+	QByteArray wrapped = '[' + json.mid(span.start, span.length) + ']';
+	return QJsonDocument::fromJson(wrapped).array().at(0).toString();
+}
+
+static QByteArray encodeString(const QString &value)
+{
+	QByteArray wrapped = QJsonDocument(QJsonArray{value}).toJson(QJsonDocument::Compact);
+	return wrapped.mid(1, wrapped.size() - 2);
+}
+
+static int rewriteDocks(QByteArray &json, const QHash<QString, HolyricsFinder::ConnectionInfo> &rewrites,
+			QStringList &changedTitles)
+{
+	QJsonParseError error;
+	if (!QJsonDocument::fromJson(json, &error).isArray() || error.error != QJsonParseError::NoError) {
+		return 0;
+	}
+
+	QList<DockSpans> docks = scanDocks(json);
+	int changed = 0;
+	// Back to front, so the spans still to do stay where they were found
+	for (qsizetype i = docks.size() - 1; i >= 0; --i) {
+		HolyricsFinder::ConnectionInfo endpoint;
+		QString urlPath;
+		if (!HolyricsFinder::parseEndpointUrl(decodeString(json, docks[i].url), endpoint, urlPath)) {
+			continue;
+		}
+
+		auto it = rewrites.constFind(HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port));
+		if (it == rewrites.constEnd()) {
+			continue;
+		}
+
+		changedTitles.prepend(decodeString(json, docks[i].title));
+		json.replace(docks[i].url.start, docks[i].url.length,
+			     encodeString(HolyricsFinder::buildUrl(it->ip, it->port, urlPath)));
+		changed++;
+	}
+	return changed;
+}
+
+bool rewriteEndpoints(const QList<HolyricsFinder::ConnectionInfo> &from, const HolyricsFinder::ConnectionInfo &to,
+		      QStringList &changedTitles)
+{
+	TRACE_SCOPE("DocksConfig::rewriteEndpoints");
+
+	changedTitles.clear();
+
+	QHash<QString, HolyricsFinder::ConnectionInfo> rewrites;
+	QString toKey = HolyricsFinder::formatEndpoint(to.ip, to.port);
+	for (const HolyricsFinder::ConnectionInfo &endpoint : from) {
+		QString key = HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port);
+		if (key != toKey) {
+			rewrites.insert(key, to);
+		}
+	}
+
+	if (rewrites.isEmpty()) {
+		return true;
+	}
+
+	QString json;
+	if (!readJson(json)) {
+		return false;
+	}
+
+	QByteArray rewritten = json.toUtf8();
+	if (rewriteDocks(rewritten, rewrites, changedTitles) == 0) {
+		return true;
+	}
+
+	if (!writeJson(QString::fromUtf8(rewritten))) {
+		obs_log(LOG_WARNING, "[DocksConfig] Could not write ExtraBrowserDocks");
+		changedTitles.clear();
+		return false;
+	}
+
+	// Earlier rewrites that pointed at one of `from` follow it to `to`
+	for (auto it = s_rewrites.begin(); it != s_rewrites.end(); ++it) {
+		QString target = HolyricsFinder::formatEndpoint(it->ip, it->port);
+		if (rewrites.contains(target)) {
+			it.value() = to;
+		}
+	}
+	for (auto it = rewrites.constBegin(); it != rewrites.constEnd(); ++it) {
+		s_rewrites.insert(it.key(), it.value());
+	}
+
+	obs_log(LOG_INFO, "[DocksConfig] Pointed %lld dock(s) at %s: %s", static_cast<long long>(changedTitles.size()),
+		toKey.toUtf8().constData(), changedTitles.join(", ").toUtf8().constData());
+	return true;
+}
+
+void reapplyRewrites()
+{
+	if (s_rewrites.isEmpty()) {
+		return;
+	}
+
+	QString json;
+	if (!readJson(json)) {
+		return;
+	}
+
+	QByteArray rewritten = json.toUtf8();
+	QStringList changedTitles;
+	if (rewriteDocks(rewritten, s_rewrites, changedTitles) > 0 && writeJson(QString::fromUtf8(rewritten))) {
+		obs_log(LOG_INFO, "[DocksConfig] Re-applied dock rewrites on exit: %s",
+			changedTitles.join(", ").toUtf8().constData());
+	}
+}
+
+bool read(QList<Dock> &docks)
+{
+	TRACE_SCOPE("DocksConfig::read");
+
+	docks.clear();
+
+	QString json;
+	if (!readJson(json)) {
+		return false;
+	}
+
+	parse(json, docks);
+	return true;
+}
+
+void parse(const QString &json, QList<Dock> &docks)
+{
+	docks.clear();
+
+	for (const QJsonValue &value : QJsonDocument::fromJson(json.toUtf8()).array()) {
+		QJsonObject object = value.toObject();
+		Dock dock;
+		dock.title = object.value("title").toString();
+		dock.url = object.value("url").toString();
+		dock.uuid = object.value("uuid").toString();
+		if (!dock.url.isEmpty()) {
+			docks.append(dock);
+		}
+	}
+}
+
+QString obsConfigPath()
+{
+	// On Windows, OBS stores config in %APPDATA%/obs-studio
+	QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+	
+	// QStandardPaths::AppDataLocation returns something like:
+	// C:/Users/Username/AppData/Roaming/obs-holyrics-plugin-finder
+	// We need to get to C:/Users/Username/AppData/Roaming/obs-studio
+	
+	QDir appDataDir(appDataPath);
+	appDataDir.cdUp(); // Go to Roaming directory
+	QString obsConfigPath = appDataDir.absolutePath() + "/obs-studio";
+	
+	EventLog::detail("docks", QString("Detected OBS config path: %1").arg(obsConfigPath));
+	
+	return obsConfigPath;
+}
+
+} // namespace DocksConfig
@@ -0,0 +1,49 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "holyrics-finder.h"
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+// Access to OBS's custom browser docks ("ExtraBrowserDocks" in the
+// BasicWindow section of user.ini), shared by the dialog and the
+// background endpoint checks.
+namespace DocksConfig {
+
+struct Dock {
+	QString title;
+	QString url;
+	QString uuid;
+};
+
+// Reads the live frontend config, falling back to user.ini on disk.
+// Returns false only when neither could be read.
+bool read(QList<Dock> &docks);
+// The JSON half of read(), independent of OBS
+void parse(const QString &json, QList<Dock> &docks);
+
+// Points every dock on one of `from` at `to`, keeping the path, in a single
+// atomic config write. Only those urls change: every other byte of the dock
+// list stays as OBS wrote it. `from` should only hold Holyrics hosts, since
+// every dock on them moves. Returns false if the config couldn't be read or
+// written.
+bool rewriteEndpoints(const QList<HolyricsFinder::ConnectionInfo> &from, const HolyricsFinder::ConnectionInfo &to,
+		      QStringList &changedTitles);
+
+// OBS writes its in-memory dock list back on exit, so rewrites made this
+// session are re-applied from the EXIT event to make them stick
+void reapplyRewrites();
+
+QString obsConfigPath();
+
+} // namespace DocksConfig
@@ -0,0 +1,384 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "endpoint-verifier.h"
+#include "docks-config.h"
+#include "event-log.h"
+#include "host-resolver.h"
+#include "trace.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <QHostAddress>
+#include <QSet>
+#include <cstring>
+
+// Let browser sources finish loading before competing with them
+static const int kSettleDelayMs = 3000;
+static const int kProbeTimeoutMs = 1500;
+// After a network move the old endpoint is usually just gone; give up on
+// it quickly so the rescan starts within about a second
+static const int kNetworkChangeProbeTimeoutMs = 700;
+
+EndpointVerifier::EndpointVerifier(HolyricsFinder *finder, QObject *parent)
+	: QObject(parent),
+	  m_finder(finder),
+	  m_running(false),
+	  m_verifyRequest(0),
+	  m_discoveryRequest(0),
+	  m_discoveryPort(0)
+{
+	m_debounce.setSingleShot(true);
+	m_debounce.setInterval(kSettleDelayMs);
+	connect(&m_debounce, &QTimer::timeout, this, &EndpointVerifier::verifyNow);
+}
+
+EndpointVerifier::~EndpointVerifier()
+{
+	stop();
+}
+
+void EndpointVerifier::start()
+{
+	if (m_running) {
+		return;
+	}
+
+	m_running = true;
+	obs_frontend_add_event_callback(onFrontendEvent, this);
+	// Started from FINISHED_LOADING, which this callback won't see again
+	m_debounce.start();
+
+	HostResolver *resolver = m_finder->resolver();
+	connect(resolver, &HostResolver::resolved, this, &EndpointVerifier::onHostResolved, Qt::UniqueConnection);
+	connect(resolver, &HostResolver::failed, this, &EndpointVerifier::onHostFailed, Qt::UniqueConnection);
+}
+
+void EndpointVerifier::stop()
+{
+	if (!m_running) {
+		return;
+	}
+
+	m_running = false;
+	m_debounce.stop();
+	obs_frontend_remove_event_callback(onFrontendEvent, this);
+	cancelPass();
+	m_discoveryHints.clear();
+}
+
+void EndpointVerifier::cancelPass()
+{
+	// Results of a cancelled request still arrive, but no longer match
+	quint64 verifyRequest = m_verifyRequest;
+	m_verifyRequest = 0;
+	m_finder->cancelRequest(verifyRequest);
+	m_hostChecks.clear();
+
+	// A discovery on the network we just left won't find anything
+	quint64 discoveryRequest = m_discoveryRequest;
+	endDiscovery();
+	m_finder->cancelRequest(discoveryRequest);
+}
+
+void EndpointVerifier::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+	EndpointVerifier *verifier = static_cast<EndpointVerifier *>(data);
+
+	if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING || event == OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED) {
+		verifier->m_debounce.start();
+	}
+}
+
+QList<HolyricsFinder::ConnectionInfo> EndpointVerifier::collectEndpoints() const
+{
+	struct Collected {
+		HolyricsFinder *finder;
+		QSet<QString> paths;
+		QSet<QString> seen;
+		QList<HolyricsFinder::ConnectionInfo> endpoints;
+	} collected;
+	collected.finder = m_finder;
+
+	for (const HolyricsFinder::HolyricsSource &definition : HolyricsFinder::getSourceDefinitions()) {
+		collected.paths.insert(definition.urlPath);
+	}
+
+	obs_enum_sources(
+		[](void *param, obs_source_t *source) {
+			if (strcmp(obs_source_get_id(source), "browser_source") != 0) {
+				return true;
+			}
+
+			auto *collected = static_cast<Collected *>(param);
+			obs_data_t *settings = obs_source_get_settings(source);
+			QString url = QString::fromUtf8(obs_data_get_string(settings, "url"));
+			obs_data_release(settings);
+
+			HolyricsFinder::ConnectionInfo endpoint;
+			QString urlPath;
+			if (HolyricsFinder::parseEndpointUrl(url, endpoint, urlPath) && collected->paths.contains(urlPath)) {
+				// Sources on the local proxy stand for the host behind it
+				endpoint = collected->finder->resolveEndpoint(endpoint);
+				QString key = HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port);
+				if (!collected->seen.contains(key)) {
+					collected->seen.insert(key);
+					collected->endpoints.append(endpoint);
+				}
+			}
+			return true;
+		},
+		&collected);
+
+	// Docks can hold any page, so only count those that look like Holyrics
+	// or point at a host we've already connected to
+	QSet<QString> known = collected.seen;
+	for (const HolyricsFinder::ConnectionInfo &endpoint : m_finder->getConnectionHistory()) {
+		known.insert(HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port));
+	}
+
+	QList<DocksConfig::Dock> docks;
+	DocksConfig::read(docks);
+	for (const DocksConfig::Dock &dock : docks) {
+		HolyricsFinder::ConnectionInfo endpoint;
+		QString urlPath;
+		if (!HolyricsFinder::parseEndpointUrl(dock.url, endpoint, urlPath)) {
+			continue;
+		}
+
+		QString key = HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port);
+		if ((collected.paths.contains(urlPath) || known.contains(key)) && !collected.seen.contains(key)) {
+			collected.seen.insert(key);
+			collected.endpoints.append(endpoint);
+		}
+	}
+
+	return collected.endpoints;
+}
+
+void EndpointVerifier::verifyNow()
+{
+	runVerification(kProbeTimeoutMs);
+}
+
+void EndpointVerifier::verifyAfterNetworkChange(const QList<QHostAddress> &newLocalAddresses)
+{
+	if (!m_running) {
+		return;
+	}
+
+	m_debounce.stop();
+	cancelPass();
+	m_discoveryHints = newLocalAddresses;
+	runVerification(kNetworkChangeProbeTimeoutMs);
+}
+
+void EndpointVerifier::runVerification(int probeTimeoutMs)
+{
+	TRACE_SCOPE("EndpointVerifier::verifyNow");
+
+	if (m_verifyRequest || m_discoveryRequest || !m_hostChecks.isEmpty()) {
+		return;
+	}
+
+	QList<HolyricsFinder::ConnectionInfo> endpoints = collectEndpoints();
+	if (endpoints.isEmpty()) {
+		m_discoveryHints.clear();
+		return;
+	}
+
+	EventLog::info("verifier", QString("Checking %1 Holyrics endpoint(s)").arg(endpoints.size()));
+
+	// All at once: a dead host costs the timeout, not the timeout times N
+	HolyricsFinder::Request<HolyricsFinder::VerifyResult> request = m_finder->verify(endpoints, probeTimeoutMs);
+	m_verifyRequest = request.id;
+	request.future.then(this, [this](const HolyricsFinder::VerifyResult &result) { onVerified(result); });
+}
+
+void EndpointVerifier::onVerified(const HolyricsFinder::VerifyResult &result)
+{
+	if (result.requestId != m_verifyRequest) {
+		return;
+	}
+	m_verifyRequest = 0;
+
+	QList<HolyricsFinder::ConnectionInfo> unreachable;
+	for (const HolyricsFinder::ProbeResult &probe : result.unreachable) {
+		obs_log(LOG_WARNING, "[EndpointVerifier] %s is not answering: %s",
+			HolyricsFinder::formatEndpoint(probe.endpoint.ip, probe.endpoint.port).toUtf8().constData(),
+			probe.error.toUtf8().constData());
+		if (HostResolver::isHostname(probe.endpoint.ip)) {
+			m_hostChecks.append(probe.endpoint);
+		} else {
+			unreachable.append(probe.endpoint);
+		}
+	}
+
+	EventLog::info("verifier", QString("%1 reachable, %2 unreachable")
+					   .arg(result.reachable.size())
+					   .arg(result.unreachable.size()));
+	emit verified(result.reachable.size(), result.unreachable.size());
+
+	if (!unreachable.isEmpty()) {
+		discover(unreachable);
+	}
+
+	// Hostnames get a fresh lookup before anything is scanned
+	QSet<QString> hostnames;
+	for (const HolyricsFinder::ConnectionInfo &endpoint : m_hostChecks) {
+		hostnames.insert(endpoint.ip);
+	}
+	for (const QString &hostname : hostnames) {
+		m_finder->resolver()->resolve(hostname);
+	}
+	if (m_hostChecks.isEmpty()) {
+		m_discoveryHints.clear();
+	}
+}
+
+QList<HolyricsFinder::ConnectionInfo> EndpointVerifier::takeHostChecks(const QString &hostname)
+{
+	QList<HolyricsFinder::ConnectionInfo> taken;
+	for (auto it = m_hostChecks.begin(); it != m_hostChecks.end();) {
+		if (it->ip == hostname) {
+			taken.append(*it);
+			it = m_hostChecks.erase(it);
+		} else {
+			++it;
+		}
+	}
+	return taken;
+}
+
+void EndpointVerifier::onHostResolved(const QString &hostname, const QList<QHostAddress> &addresses)
+{
+	QList<HolyricsFinder::ConnectionInfo> endpoints = takeHostChecks(hostname);
+	if (endpoints.isEmpty()) {
+		return;
+	}
+
+	// The name is fine, so a scan would only find Holyrics where the name
+	// already points; the sources will load once it is back
+	obs_log(LOG_WARNING, "[EndpointVerifier] %s still resolves to %s; Holyrics isn't answering there",
+		hostname.toUtf8().constData(),
+		addresses.isEmpty() ? "nothing" : addresses.first().toString().toUtf8().constData());
+	if (m_hostChecks.isEmpty()) {
+		m_discoveryHints.clear();
+	}
+}
+
+void EndpointVerifier::onHostFailed(const QString &hostname, const QString &error)
+{
+	QList<HolyricsFinder::ConnectionInfo> endpoints = takeHostChecks(hostname);
+	if (endpoints.isEmpty()) {
+		return;
+	}
+
+	// Sweep near where the name used to point, or the network we're on
+	QString seedIp;
+	for (const QHostAddress &address : m_finder->resolver()->addresses(hostname)) {
+		if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+			seedIp = address.toString();
+			break;
+		}
+	}
+	if (seedIp.isEmpty()) {
+		seedIp = m_finder->getWinningInterfaceAddress().toString();
+	}
+
+	obs_log(LOG_WARNING, "[EndpointVerifier] %s no longer resolves (%s); falling back to a scan",
+		hostname.toUtf8().constData(), error.toUtf8().constData());
+	discover(endpoints, seedIp);
+	if (m_hostChecks.isEmpty()) {
+		m_discoveryHints.clear();
+	}
+}
+
+void EndpointVerifier::discover(const QList<HolyricsFinder::ConnectionInfo> &unreachable, const QString &seedIp)
+{
+	if (m_discoveryRequest) {
+		return;
+	}
+	if (m_finder->isScanning()) {
+		EventLog::info("verifier", "A scan is already running; not starting discovery");
+		return;
+	}
+
+	// One discovery per pass; endpoints on the same port move together
+	const HolyricsFinder::ConnectionInfo &seed = unreachable.first();
+	QString sweepIp = seedIp.isEmpty() ? seed.ip : seedIp;
+
+	// After a network move, sweep only the network we just joined
+	for (const QHostAddress &hint : m_discoveryHints) {
+		if (hint.protocol() == QAbstractSocket::IPv4Protocol) {
+			sweepIp = hint.toString();
+			break;
+		}
+	}
+
+	QHostAddress seedAddress(sweepIp);
+	if (seedAddress.isNull() || seedAddress.isLoopback()) {
+		return;
+	}
+
+	m_discoveryPort = seed.port;
+	m_discoveryFrom.clear();
+	for (const HolyricsFinder::ConnectionInfo &endpoint : unreachable) {
+		if (endpoint.port == m_discoveryPort) {
+			m_discoveryFrom.append(endpoint);
+		}
+	}
+
+	EventLog::info("verifier", QString("Looking for Holyrics near %1")
+					   .arg(HolyricsFinder::formatEndpoint(sweepIp, m_discoveryPort)));
+	HolyricsFinder::Request<HolyricsFinder::ScanResult> request = m_finder->scan(sweepIp, m_discoveryPort);
+	m_discoveryRequest = request.id;
+	request.future.then(this, [this](const HolyricsFinder::ScanResult &result) { onDiscovered(result); });
+}
+
+void EndpointVerifier::onDiscovered(const HolyricsFinder::ScanResult &result)
+{
+	if (result.requestId != m_discoveryRequest) {
+		return;
+	}
+
+	int port = m_discoveryPort;
+	QList<HolyricsFinder::ConnectionInfo> from = m_discoveryFrom;
+	endDiscovery();
+
+	if (!result.error.isEmpty()) {
+		obs_log(LOG_WARNING, "[EndpointVerifier] Discovery on port %d stopped: %s", port,
+			result.error.toUtf8().constData());
+		return;
+	}
+	if (result.found.isEmpty()) {
+		obs_log(LOG_WARNING, "[EndpointVerifier] Discovery found no Holyrics on port %d", port);
+		return;
+	}
+
+	// The first host to answer is the one the scan reports to everyone else
+	HolyricsFinder::ConnectionInfo to{result.found.first().endpoint.ip, port};
+	int rebound = m_finder->rebindSources(from, to);
+
+	QStringList docks;
+	DocksConfig::rewriteEndpoints(from, to, docks);
+	for (const HolyricsFinder::ConnectionInfo &endpoint : from) {
+		QString fromEndpoint = HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port);
+		EventLog::info("verifier", QString("%1 moved to %2")
+						   .arg(fromEndpoint, HolyricsFinder::formatEndpoint(to.ip, to.port)));
+		emit endpointMoved(fromEndpoint, to.ip, to.port, rebound);
+		rebound = 0;
+	}
+}
+
+void EndpointVerifier::endDiscovery()
+{
+	m_discoveryRequest = 0;
+	m_discoveryFrom.clear();
+}
@@ -0,0 +1,67 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "holyrics-finder.h"
+#include <obs-frontend-api.h>
+#include <QObject>
+#include <QHostAddress>
+#include <QList>
+#include <QTimer>
+
+// Checks, in the background, that every Holyrics endpoint referenced by a
+// browser source or custom dock still answers. Runs once started (after
+// OBS finishes loading) and after each scene-collection switch; if an endpoint has gone
+// away it runs a discovery on that network and rebinds the sources.
+// Sources bound to a hostname are only rescanned for when the name no
+// longer resolves; if it still does, Holyrics itself is what's down.
+// After a network change it checks straight away and, if needed, looks
+// for Holyrics on the network the machine just joined.
+class EndpointVerifier : public QObject {
+	Q_OBJECT
+
+public:
+	explicit EndpointVerifier(HolyricsFinder *finder, QObject *parent = nullptr);
+	~EndpointVerifier();
+
+	void start();
+	void stop();
+	void verifyNow();
+	void verifyAfterNetworkChange(const QList<QHostAddress> &newLocalAddresses);
+
+signals:
+	void verified(int reachable, int unreachable);
+	void endpointMoved(const QString &fromEndpoint, const QString &toIp, int toPort, int reboundSources);
+
+private:
+	HolyricsFinder *m_finder;
+	QTimer m_debounce;
+	bool m_running;
+	quint64 m_verifyRequest;
+	quint64 m_discoveryRequest;
+	QList<HolyricsFinder::ConnectionInfo> m_discoveryFrom;
+	int m_discoveryPort;
+	QList<QHostAddress> m_discoveryHints;
+	QList<HolyricsFinder::ConnectionInfo> m_hostChecks;
+
+	static void onFrontendEvent(enum obs_frontend_event event, void *data);
+
+	QList<HolyricsFinder::ConnectionInfo> collectEndpoints() const;
+	void runVerification(int probeTimeoutMs);
+	void cancelPass();
+	void onVerified(const HolyricsFinder::VerifyResult &result);
+	void discover(const QList<HolyricsFinder::ConnectionInfo> &unreachable, const QString &seedIp = QString());
+	QList<HolyricsFinder::ConnectionInfo> takeHostChecks(const QString &hostname);
+	void onHostResolved(const QString &hostname, const QList<QHostAddress> &addresses);
+	void onHostFailed(const QString &hostname, const QString &error);
+	void onDiscovered(const HolyricsFinder::ScanResult &result);
+	void endDiscovery();
+};
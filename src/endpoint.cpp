@@ -0,0 +1,99 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "endpoint.h"
+#include <QHashFunctions>
+#include <QNetworkInterface>
+#include <cstring>
+
+// ::ffff:0:0/96
+static const quint8 kV4MappedPrefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+
+Endpoint::Endpoint(const QHostAddress &address, quint16 port) : m_port(port)
+{
+	if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+		*this = fromIPv4(address.toIPv4Address(), port);
+		return;
+	}
+	if (address.protocol() != QAbstractSocket::IPv6Protocol) {
+		return;
+	}
+
+	Q_IPV6ADDR ipv6 = address.toIPv6Address();
+	std::memcpy(m_address, ipv6.c, sizeof(m_address));
+
+	QString scope = address.scopeId();
+	if (!scope.isEmpty()) {
+		bool numeric = false;
+		m_scopeId = scope.toUInt(&numeric);
+		if (!numeric) {
+			m_scopeId = quint32(qMax(0, QNetworkInterface::interfaceIndexFromName(scope)));
+		}
+	}
+	m_valid = true;
+}
+
+Endpoint Endpoint::fromIPv4(quint32 address, quint16 port)
+{
+	Endpoint endpoint;
+	std::memcpy(endpoint.m_address, kV4MappedPrefix, sizeof(kV4MappedPrefix));
+	endpoint.m_address[12] = quint8(address >> 24);
+	endpoint.m_address[13] = quint8(address >> 16);
+	endpoint.m_address[14] = quint8(address >> 8);
+	endpoint.m_address[15] = quint8(address);
+	endpoint.m_port = port;
+	endpoint.m_valid = true;
+	return endpoint;
+}
+
+bool Endpoint::isIPv4() const
+{
+	return m_valid && std::memcmp(m_address, kV4MappedPrefix, sizeof(kV4MappedPrefix)) == 0;
+}
+
+quint32 Endpoint::toIPv4() const
+{
+	return (quint32(m_address[12]) << 24) | (quint32(m_address[13]) << 16) | (quint32(m_address[14]) << 8) |
+	       quint32(m_address[15]);
+}
+
+QHostAddress Endpoint::address() const
+{
+	if (!m_valid) {
+		return QHostAddress();
+	}
+	if (isIPv4()) {
+		return QHostAddress(toIPv4());
+	}
+
+	QHostAddress address(m_address);
+	if (m_scopeId) {
+		QString name = QNetworkInterface::interfaceNameFromIndex(int(m_scopeId));
+		address.setScopeId(name.isEmpty() ? QString::number(m_scopeId) : name);
+	}
+	return address;
+}
+
+QString Endpoint::ip() const
+{
+	return address().toString();
+}
+
+bool Endpoint::operator==(const Endpoint &other) const
+{
+	return m_valid == other.m_valid && m_port == other.m_port && m_scopeId == other.m_scopeId &&
+	       std::memcmp(m_address, other.m_address, sizeof(m_address)) == 0;
+}
+
+size_t qHash(const Endpoint &endpoint, size_t seed)
+{
+	seed = qHashBits(endpoint.m_address, sizeof(endpoint.m_address), seed);
+	return qHashMulti(seed, endpoint.m_scopeId, endpoint.m_port);
+}
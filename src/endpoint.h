@@ -0,0 +1,49 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QHostAddress>
+#include <QString>
+#include <QtGlobal>
+
+// An address and port in a fixed 24 bytes, with nothing on the heap.
+// IPv4 is stored v4-mapped so both families share one layout; an IPv6
+// scope ("%eth0") is kept as the interface index. Used where the scan
+// handles thousands of hosts; ConnectionInfo stays the type for anything
+// that may hold a hostname.
+class Endpoint {
+public:
+	Endpoint() = default;
+	Endpoint(const QHostAddress &address, quint16 port);
+	static Endpoint fromIPv4(quint32 address, quint16 port);
+
+	bool isNull() const { return !m_valid; }
+	bool isIPv4() const;
+	quint32 toIPv4() const;
+	quint16 port() const { return m_port; }
+
+	QHostAddress address() const;
+	// Same text as QHostAddress::toString(), only built when asked for
+	QString ip() const;
+
+	bool operator==(const Endpoint &other) const;
+	bool operator!=(const Endpoint &other) const { return !(*this == other); }
+
+private:
+	quint8 m_address[16] = {};
+	quint32 m_scopeId = 0;
+	quint16 m_port = 0;
+	bool m_valid = false;
+
+	friend size_t qHash(const Endpoint &endpoint, size_t seed);
+};
+
+size_t qHash(const Endpoint &endpoint, size_t seed = 0);
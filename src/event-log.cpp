@@ -0,0 +1,182 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "event-log.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSaveFile>
+#include <mutex>
+
+namespace EventLog {
+
+static const int kCapacity = 4096;
+
+// Per category, this many lines reach the OBS log in each window
+static const int kBurst = 5;
+static const uint64_t kWindowNs = 10ULL * 1000000000ULL;
+
+struct Event {
+	qint64 timeMs;
+	Level level;
+	const char *category;
+	QString message;
+};
+
+struct Budget {
+	uint64_t windowStartNs;
+	int written;
+	int suppressed;
+};
+
+static std::mutex s_mutex;
+static Event s_ring[kCapacity];
+static int s_next = 0;
+static int s_count = 0;
+// Keyed by the category's text: the same literal can have a different
+// address in each translation unit
+static QHash<QByteArray, Budget> s_budgets;
+
+static int obsLevel(Level level)
+{
+	switch (level) {
+	case Error:
+		return LOG_ERROR;
+	case Warning:
+		return LOG_WARNING;
+	default:
+		return LOG_INFO;
+	}
+}
+
+static const char *levelName(Level level)
+{
+	switch (level) {
+	case Detail:
+		return "detail";
+	case Info:
+		return "info";
+	case Warning:
+		return "warning";
+	case Error:
+		return "error";
+	}
+	return "";
+}
+
+static void reportHeldBack(const char *category, int suppressed)
+{
+	obs_log(LOG_INFO, "[%s] %d similar message(s) held back; save the detailed log to see them", category,
+		suppressed);
+}
+
+void write(Level level, const char *category, const QString &message)
+{
+	int suppressed = 0;
+	bool passes = false;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_ring[s_next] = Event{QDateTime::currentMSecsSinceEpoch(), level, category, message};
+		s_next = (s_next + 1) % kCapacity;
+		s_count = qMin(s_count + 1, kCapacity);
+
+		if (level == Detail) {
+			return;
+		}
+
+		uint64_t now = os_gettime_ns();
+		auto found = s_budgets.find(QByteArray::fromRawData(category, qstrlen(category)));
+		if (found == s_budgets.end()) {
+			found = s_budgets.insert(QByteArray(category), Budget{now, 0, 0});
+		}
+		Budget &budget = found.value();
+		if (now - budget.windowStartNs >= kWindowNs) {
+			suppressed = budget.suppressed;
+			budget = Budget{now, 0, 0};
+		}
+
+		// Warnings and errors always reach the OBS log and don't use up
+		// the budget, so a flood of them can't hide the info lines either
+		if (level >= Warning) {
+			passes = true;
+		} else if (budget.written < kBurst) {
+			budget.written++;
+			passes = true;
+		} else {
+			budget.suppressed++;
+		}
+	}
+
+	// Formatting and the file write happen outside the lock
+	if (suppressed) {
+		reportHeldBack(category, suppressed);
+	}
+	if (passes) {
+		obs_log(obsLevel(level), "[%s] %s", category, message.toUtf8().constData());
+	}
+}
+
+void flush()
+{
+	QList<QPair<QByteArray, int>> heldBack;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		for (auto it = s_budgets.begin(); it != s_budgets.end(); ++it) {
+			if (it->suppressed > 0) {
+				heldBack.append(qMakePair(it.key(), it->suppressed));
+				it->suppressed = 0;
+			}
+		}
+	}
+
+	for (const auto &entry : heldBack) {
+		reportHeldBack(entry.first.constData(), entry.second);
+	}
+}
+
+int dump(const QString &path)
+{
+	flush();
+
+	QByteArray text;
+	int written = 0;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		int first = (s_next - s_count + kCapacity) % kCapacity;
+		for (int i = 0; i < s_count; ++i) {
+			const Event &event = s_ring[(first + i) % kCapacity];
+			text += QDateTime::fromMSecsSinceEpoch(event.timeMs).toString(Qt::ISODateWithMs).toUtf8();
+			text += ' ';
+			text += levelName(event.level);
+			text += " [";
+			text += event.category;
+			text += "] ";
+			text += event.message.toUtf8();
+			text += '\n';
+		}
+		written = s_count;
+	}
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly) || file.write(text) < 0 || !file.commit()) {
+		obs_log(LOG_WARNING, "[EventLog] Could not write %s: %s", path.toUtf8().constData(),
+			file.errorString().toUtf8().constData());
+		return -1;
+	}
+
+	obs_log(LOG_INFO, "[EventLog] Wrote %d event(s) to %s", written, path.toUtf8().constData());
+	return written;
+}
+
+} // namespace EventLog
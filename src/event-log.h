@@ -0,0 +1,60 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QString>
+
+// Leveled plugin events kept in a fixed in-memory ring. Detail events only
+// go to the ring; the rest are also written to the OBS log. Info is held
+// to a few lines per category every few seconds, with a count of what was
+// held back; warnings and errors always get through. The ring can be saved
+// to a text file for support cases.
+namespace EventLog {
+
+enum Level {
+	Detail,
+	Info,
+	Warning,
+	Error,
+};
+
+// `category` must outlive the log (use string literals)
+void write(Level level, const char *category, const QString &message);
+
+inline void detail(const char *category, const QString &message)
+{
+	write(Detail, category, message);
+}
+
+inline void info(const char *category, const QString &message)
+{
+	write(Info, category, message);
+}
+
+inline void warning(const char *category, const QString &message)
+{
+	write(Warning, category, message);
+}
+
+inline void error(const char *category, const QString &message)
+{
+	write(Error, category, message);
+}
+
+// Writes the held-back counts not reported yet to the OBS log. The next
+// line in a category reports them too; this is for when none comes.
+void flush();
+
+// Writes the ring to `path`, after flush(); returns the number of events
+// written, or -1
+int dump(const QString &path);
+
+} // namespace EventLog
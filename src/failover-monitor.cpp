@@ -0,0 +1,330 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "failover-monitor.h"
+#include "event-log.h"
+#include "trace.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSet>
+#include <QSettings>
+#include <QUrl>
+#include <cstring>
+
+// Three missed checks at this spacing put detection at ~1.5 s; the
+// timeout keeps a dead host from holding a check past the next tick
+static const int kCheckIntervalMs = 500;
+static const int kCheckTimeoutMs = 400;
+static const int kFailureThreshold = 3;
+
+// After an endpoint has passed the full check on "/", staying up only
+// takes an HTTP answer of any kind to a HEAD on the small text feed
+static const char *kLivenessPath = "/stage-view/text.json";
+
+static const char *kEndpointIndexProperty = "failoverIndex";
+static const char *kFullCheckProperty = "failoverFullCheck";
+
+FailoverMonitor::FailoverMonitor(HolyricsFinder *finder, QObject *parent)
+	: QObject(parent),
+	  m_finder(finder),
+	  m_network(nullptr),
+	  m_enabled(false),
+	  m_running(false),
+	  m_reportedAllDown(false),
+	  m_active(0)
+{
+	m_timer.setInterval(kCheckIntervalMs);
+	connect(&m_timer, &QTimer::timeout, this, &FailoverMonitor::probeAll);
+}
+
+FailoverMonitor::~FailoverMonitor()
+{
+	stop();
+}
+
+void FailoverMonitor::start()
+{
+	if (m_running) {
+		return;
+	}
+
+	QSettings settings("OBS", "HolyricsFinder");
+	m_enabled = settings.value("failover/enabled", false).toBool();
+	m_endpoints.clear();
+	for (const QString &text : settings.value("failover/endpoints").toStringList()) {
+		HolyricsFinder::ConnectionInfo endpoint;
+		if (HolyricsFinder::parseEndpoint(text, endpoint)) {
+			m_endpoints.append(endpoint);
+		}
+	}
+
+	m_running = true;
+	resetHealth();
+	m_active = locateActive();
+
+	if (m_enabled && m_endpoints.size() > 1) {
+		const HolyricsFinder::ConnectionInfo &active = m_endpoints[m_active];
+		EventLog::info("failover", QString("Watching %1 endpoint(s), sources on %2")
+						   .arg(m_endpoints.size())
+						   .arg(HolyricsFinder::formatEndpoint(active.ip, active.port)));
+		m_timer.start();
+		probeAll();
+	}
+}
+
+void FailoverMonitor::stop()
+{
+	m_running = false;
+	m_timer.stop();
+	abortProbes();
+}
+
+void FailoverMonitor::setEnabled(bool enabled)
+{
+	if (m_enabled == enabled) {
+		return;
+	}
+
+	m_enabled = enabled;
+	saveSettings();
+	EventLog::info("failover", enabled ? "enabled" : "disabled");
+
+	if (!m_running) {
+		return;
+	}
+
+	abortProbes();
+	resetHealth();
+	m_active = locateActive();
+	if (enabled && m_endpoints.size() > 1) {
+		m_timer.start();
+		probeAll();
+	} else {
+		m_timer.stop();
+	}
+}
+
+void FailoverMonitor::setEndpoints(const QList<HolyricsFinder::ConnectionInfo> &endpoints)
+{
+	abortProbes();
+	m_endpoints = endpoints;
+	saveSettings();
+	resetHealth();
+	m_active = locateActive();
+
+	if (m_running && m_enabled && m_endpoints.size() > 1) {
+		m_timer.start();
+		probeAll();
+	} else {
+		m_timer.stop();
+	}
+}
+
+void FailoverMonitor::saveSettings() const
+{
+	QStringList endpoints;
+	for (const HolyricsFinder::ConnectionInfo &endpoint : m_endpoints) {
+		endpoints.append(HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port));
+	}
+
+	QSettings settings("OBS", "HolyricsFinder");
+	settings.setValue("failover/enabled", m_enabled);
+	settings.setValue("failover/endpoints", endpoints);
+}
+
+void FailoverMonitor::resetHealth()
+{
+	m_health.clear();
+	for (int i = 0; i < m_endpoints.size(); ++i) {
+		m_health.append(Health{0, true, false, nullptr});
+	}
+	m_reportedAllDown = false;
+}
+
+int FailoverMonitor::locateActive() const
+{
+	// Where the sources are now, not the primary: after a failover and a
+	// restart they are still on the standby
+	struct Located {
+		HolyricsFinder *finder;
+		const QList<HolyricsFinder::ConnectionInfo> *endpoints;
+		QSet<QString> paths;
+		QList<int> counts;
+	} located;
+	located.finder = m_finder;
+	located.endpoints = &m_endpoints;
+	located.counts = QList<int>(m_endpoints.size(), 0);
+
+	for (const HolyricsFinder::HolyricsSource &definition : HolyricsFinder::getSourceDefinitions()) {
+		located.paths.insert(definition.urlPath);
+	}
+
+	obs_enum_sources(
+		[](void *param, obs_source_t *source) {
+			if (strcmp(obs_source_get_id(source), "browser_source") != 0) {
+				return true;
+			}
+
+			auto *located = static_cast<Located *>(param);
+			obs_data_t *settings = obs_source_get_settings(source);
+			QString url = QString::fromUtf8(obs_data_get_string(settings, "url"));
+			obs_data_release(settings);
+
+			HolyricsFinder::ConnectionInfo endpoint;
+			QString urlPath;
+			if (!HolyricsFinder::parseEndpointUrl(url, endpoint, urlPath) || !located->paths.contains(urlPath)) {
+				return true;
+			}
+			for (int i = 0; i < located->endpoints->size(); ++i) {
+				if (located->finder->pointsAt(endpoint, located->endpoints->at(i))) {
+					located->counts[i]++;
+					break;
+				}
+			}
+			return true;
+		},
+		&located);
+
+	int active = 0;
+	for (int i = 1; i < located.counts.size(); ++i) {
+		if (located.counts[i] > located.counts[active]) {
+			active = i;
+		}
+	}
+	return active;
+}
+
+void FailoverMonitor::probeAll()
+{
+	if (!m_network) {
+		m_network = new QNetworkAccessManager(this);
+	}
+
+	for (int i = 0; i < m_endpoints.size(); ++i) {
+		// A check still in flight from the last tick will time out on its own
+		if (m_health[i].inFlight) {
+			continue;
+		}
+
+		const HolyricsFinder::ConnectionInfo &endpoint = m_endpoints[i];
+		bool fullCheck = !m_health[i].verified;
+		QNetworkRequest request{
+			QUrl(HolyricsFinder::buildUrl(endpoint.ip, endpoint.port, fullCheck ? "/" : kLivenessPath))};
+		request.setTransferTimeout(kCheckTimeoutMs);
+
+		QNetworkReply *reply = fullCheck ? m_network->get(request) : m_network->head(request);
+		reply->setProperty(kEndpointIndexProperty, i);
+		reply->setProperty(kFullCheckProperty, fullCheck);
+		connect(reply, &QNetworkReply::finished, this, &FailoverMonitor::onProbeFinished);
+		m_health[i].inFlight = reply;
+	}
+}
+
+void FailoverMonitor::abortProbes()
+{
+	for (Health &health : m_health) {
+		QNetworkReply *reply = health.inFlight;
+		health.inFlight = nullptr;
+		if (reply) {
+			reply->abort();
+			reply->deleteLater();
+		}
+	}
+}
+
+void FailoverMonitor::onProbeFinished()
+{
+	QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+	if (!reply) {
+		return;
+	}
+	reply->deleteLater();
+
+	int index = reply->property(kEndpointIndexProperty).toInt();
+	if (index < 0 || index >= m_health.size() || m_health[index].inFlight != reply) {
+		return;
+	}
+
+	Health &health = m_health[index];
+	health.inFlight = nullptr;
+
+	// A 404 or 405 to the HEAD still means Holyrics' server is up; a
+	// timeout or refused connection has no status at all
+	bool fullCheck = reply->property(kFullCheckProperty).toBool();
+	bool ok;
+	if (fullCheck) {
+		ok = reply->error() == QNetworkReply::NoError && HolyricsFinder::isHolyricsResponse(reply->readAll());
+	} else {
+		ok = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() > 0;
+	}
+
+	if (ok) {
+		health.verified = health.verified || fullCheck;
+		if (!health.healthy) {
+			const HolyricsFinder::ConnectionInfo &endpoint = m_endpoints[index];
+			EventLog::info("failover", QString("%1 is answering again")
+							   .arg(HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port)));
+		}
+		health.consecutiveFailures = 0;
+		health.healthy = true;
+	} else if (++health.consecutiveFailures >= kFailureThreshold && health.healthy) {
+		// Whatever answers at this address next has to prove it's Holyrics
+		health.healthy = false;
+		health.verified = false;
+		obs_log(LOG_WARNING, "[Failover] %s missed %d checks",
+			HolyricsFinder::formatEndpoint(m_endpoints[index].ip, m_endpoints[index].port).toUtf8().constData(),
+			health.consecutiveFailures);
+	}
+
+	if (index == m_active) {
+		checkActive();
+	}
+}
+
+void FailoverMonitor::checkActive()
+{
+	if (m_health[m_active].healthy) {
+		m_reportedAllDown = false;
+		return;
+	}
+
+	// First healthy standby in profile order
+	int next = -1;
+	for (int i = 0; i < m_endpoints.size(); ++i) {
+		if (i != m_active && m_health[i].healthy && m_health[i].consecutiveFailures == 0) {
+			next = i;
+			break;
+		}
+	}
+
+	if (next < 0) {
+		if (!m_reportedAllDown) {
+			m_reportedAllDown = true;
+			obs_log(LOG_WARNING, "[Failover] No healthy standby; leaving sources where they are");
+			emit allEndpointsDown();
+		}
+		return;
+	}
+
+	TRACE_SCOPE("FailoverMonitor::switchover");
+
+	QString from = HolyricsFinder::formatEndpoint(m_endpoints[m_active].ip, m_endpoints[m_active].port);
+	const HolyricsFinder::ConnectionInfo &to = m_endpoints[next];
+	int rebound = m_finder->rebindSources(m_endpoints, to);
+	m_active = next;
+	m_reportedAllDown = false;
+
+	obs_log(LOG_WARNING, "[Failover] %s is down; moved %d source(s) to %s", from.toUtf8().constData(), rebound,
+		HolyricsFinder::formatEndpoint(to.ip, to.port).toUtf8().constData());
+	emit failedOver(from, to.ip, to.port, rebound);
+}
@@ -0,0 +1,76 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "holyrics-finder.h"
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QTimer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Health-checks an ordered list of Holyrics endpoints (primary first) and,
+// when the one the sources are bound to stops answering, moves every
+// Holyrics source to the first healthy standby in one batched rewrite.
+// It never fails back on its own: a primary that comes back mid-service
+// shouldn't yank the sources around again.
+class FailoverMonitor : public QObject {
+	Q_OBJECT
+
+public:
+	explicit FailoverMonitor(HolyricsFinder *finder, QObject *parent = nullptr);
+	~FailoverMonitor();
+
+	void start();
+	void stop();
+
+	bool isEnabled() const { return m_enabled; }
+	void setEnabled(bool enabled);
+
+	QList<HolyricsFinder::ConnectionInfo> endpoints() const { return m_endpoints; }
+	void setEndpoints(const QList<HolyricsFinder::ConnectionInfo> &endpoints);
+	int activeIndex() const { return m_active; }
+
+signals:
+	void failedOver(const QString &fromEndpoint, const QString &toIp, int toPort, int reboundSources);
+	void allEndpointsDown();
+
+private slots:
+	void onProbeFinished();
+
+private:
+	struct Health {
+		int consecutiveFailures;
+		bool healthy;
+		// Answered the full Holyrics check since it was last down
+		bool verified;
+		QNetworkReply *inFlight;
+	};
+
+	HolyricsFinder *m_finder;
+	QNetworkAccessManager *m_network;
+	QTimer m_timer;
+	bool m_enabled;
+	bool m_running;
+	bool m_reportedAllDown;
+	int m_active;
+	QList<HolyricsFinder::ConnectionInfo> m_endpoints;
+	QList<Health> m_health;
+
+	void saveSettings() const;
+	void resetHealth();
+	int locateActive() const;
+	void probeAll();
+	void abortProbes();
+	void checkActive();
+};
@@ -10,11 +10,19 @@ the Free Software Foundation; either version 2 of the License, or
 
 #include "holyrics-dialog.h"
 #include "holyrics-finder.h"
+#include "docks-config.h"
+#include "event-log.h"
+#include "failover-monitor.h"
+#include "source-catalog.h"
+#include "source-governor.h"
+#include "text-mirror.h"
+#include "trace.h"
 #include "translations.h"
 #include <obs-module.h>
 #include <obs-frontend-api.h>
 #include <plugin-support.h>
 #include <QVBoxLayout>
+#include <QComboBox>
 #include <QHBoxLayout>
 #include <QGroupBox>
 #include <QIntValidator>
@@ -23,16 +31,21 @@ the Free Software Foundation; either version 2 of the License, or
 #include <QRegularExpression>
 #include <QClipboard>
 #include <QApplication>
-#include <QStandardPaths>
-#include <QFile>
-#include <QTextStream>
 #include <QSettings>
-#include <QDir>
+#include <QSet>
+#include <QDockWidget>
+#include <QMainWindow>
 
-HolyricsDialog::HolyricsDialog(QWidget *parent, HolyricsFinder *finder)
+HolyricsDialog::HolyricsDialog(QWidget *parent, HolyricsFinder *finder, SourceGovernor *governor,
+			       TextMirror *textMirror, FailoverMonitor *failover)
 	: QDialog(parent),
-	  m_finder(finder)
+	  m_finder(finder),
+	  m_governor(governor),
+	  m_textMirror(textMirror),
+	  m_failover(failover)
 {
+	TRACE_SCOPE("HolyricsDialog::HolyricsDialog");
+
 	// Language is already set in plugin-main.cpp
 	setWindowTitle(Translations::get("window.title"));
 	setMinimumWidth(600);
@@ -51,6 +64,19 @@ HolyricsDialog::HolyricsDialog(QWidget *parent, HolyricsFinder *finder)
 		&HolyricsDialog::onScanProgress);
 	connect(m_finder, &HolyricsFinder::scanComplete, this,
 		&HolyricsDialog::onScanComplete);
+	connect(m_finder, &HolyricsFinder::endpointsRanked, this,
+		&HolyricsDialog::onEndpointsRanked);
+	connect(m_finder, &HolyricsFinder::interfaceScanProgress, this,
+		&HolyricsDialog::onInterfaceScanProgress);
+	connect(m_governor, &SourceGovernor::statsChanged, this,
+		&HolyricsDialog::onGovernorStatsChanged);
+	connect(m_failover, &FailoverMonitor::failedOver, this,
+		&HolyricsDialog::onFailedOver);
+	connect(m_finder, &HolyricsFinder::hostnameBound, this,
+		&HolyricsDialog::onHostnameBound);
+	connect(m_finder->loadVerifier(), &LoadVerifier::batchFinished, this,
+		&HolyricsDialog::onSourcesLoadChecked);
+	onGovernorStatsChanged();
 }
 
 HolyricsDialog::~HolyricsDialog() 
@@ -61,6 +87,14 @@ HolyricsDialog::~HolyricsDialog()
 		disconnect(m_finder, nullptr, this, nullptr);
 		obs_log(LOG_DEBUG, "[HolyricsDialog] Disconnected signals from finder");
 	}
+
+	if (m_governor) {
+		disconnect(m_governor, nullptr, this, nullptr);
+	}
+
+	if (m_failover) {
+		disconnect(m_failover, nullptr, this, nullptr);
+	}
 	
 	if (m_sourcesList) {
 		m_sourcesList->clear();
@@ -133,6 +167,15 @@ void HolyricsDialog::setupUI()
 
 	connectionLayout->addLayout(ipLayout);
 
+	QHBoxLayout *ipv6Layout = new QHBoxLayout();
+	ipv6Layout->addWidget(new QLabel(Translations::get("connection.ipv6_label"), this));
+	m_ipv6Input = new QLineEdit(this);
+	m_ipv6Input->setPlaceholderText("fe80::1%eth0");
+	m_ipv6Input->setMaximumWidth(300);
+	ipv6Layout->addWidget(m_ipv6Input);
+	ipv6Layout->addStretch();
+	connectionLayout->addLayout(ipv6Layout);
+
 	QHBoxLayout *buttonLayout = new QHBoxLayout();
 	
 	m_testButton = new QPushButton(Translations::get("connection.test_button"), this);
@@ -145,12 +188,17 @@ void HolyricsDialog::setupUI()
 		&HolyricsDialog::onScanNetwork);
 	buttonLayout->addWidget(m_scanButton);
 
+	m_scanAllButton = new QPushButton(Translations::get("connection.scan_all_button"), this);
+	connect(m_scanAllButton, &QPushButton::clicked, this,
+		&HolyricsDialog::onScanAllInterfaces);
+	buttonLayout->addWidget(m_scanAllButton);
+
 	m_copyIpButton = new QPushButton(Translations::get("connection.copy_button"), this);
 	m_copyIpButton->setVisible(false);
 	connect(m_copyIpButton, &QPushButton::clicked, this, [this]() {
 		QString ip = getIpFromInputs();
 		int port = getPortFromInput();
-		QString ipPort = QString("%1:%2").arg(ip).arg(port);
+		QString ipPort = HolyricsFinder::formatEndpoint(ip, port);
 		
 		QClipboard *clipboard = QApplication::clipboard();
 		clipboard->setText(ipPort);
@@ -161,6 +209,40 @@ void HolyricsDialog::setupUI()
 
 	connectionLayout->addLayout(buttonLayout);
 
+	m_autoFastestCheck = new QCheckBox(Translations::get("connection.auto_fastest"), this);
+	m_autoFastestCheck->setChecked(m_finder->isAutoSelectFastest());
+	connect(m_autoFastestCheck, &QCheckBox::toggled, this, [this](bool checked) {
+		m_finder->setAutoSelectFastest(checked);
+	});
+	connectionLayout->addWidget(m_autoFastestCheck);
+
+	QHBoxLayout *failoverLayout = new QHBoxLayout();
+	m_failoverCheck = new QCheckBox(Translations::get("failover.enabled"), this);
+	m_failoverCheck->setChecked(m_failover->isEnabled());
+	connect(m_failoverCheck, &QCheckBox::toggled, this, [this](bool checked) {
+		m_failover->setEnabled(checked);
+	});
+	failoverLayout->addWidget(m_failoverCheck);
+
+	QStringList failoverEndpoints;
+	for (const HolyricsFinder::ConnectionInfo &endpoint : m_failover->endpoints()) {
+		failoverEndpoints.append(HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port));
+	}
+	m_failoverInput = new QLineEdit(failoverEndpoints.join(", "), this);
+	m_failoverInput->setPlaceholderText(Translations::get("failover.placeholder"));
+	connect(m_failoverInput, &QLineEdit::editingFinished, this, [this]() {
+		QList<HolyricsFinder::ConnectionInfo> endpoints;
+		for (const QString &text : m_failoverInput->text().split(',', Qt::SkipEmptyParts)) {
+			HolyricsFinder::ConnectionInfo endpoint;
+			if (HolyricsFinder::parseEndpoint(text.trimmed(), endpoint)) {
+				endpoints.append(endpoint);
+			}
+		}
+		m_failover->setEndpoints(endpoints);
+	});
+	failoverLayout->addWidget(m_failoverInput, 1);
+	connectionLayout->addLayout(failoverLayout);
+
 	m_statusLabel = new QLabel(Translations::get("status.ready"), this);
 	m_statusLabel->setWordWrap(true);
 	connectionLayout->addWidget(m_statusLabel);
@@ -181,6 +263,13 @@ void HolyricsDialog::setupUI()
 	QLabel *sourcesLabel = new QLabel(Translations::get("sources.label"), this);
 	sourcesLayout->addWidget(sourcesLabel);
 
+	m_sourcesSearch = new QLineEdit(this);
+	m_sourcesSearch->setPlaceholderText(Translations::get("sources.search_placeholder"));
+	m_sourcesSearch->setClearButtonEnabled(true);
+	connect(m_sourcesSearch, &QLineEdit::textChanged, this,
+		&HolyricsDialog::onSourcesFilterChanged);
+	sourcesLayout->addWidget(m_sourcesSearch);
+
 	m_sourcesList = new QListWidget(this);
 	connect(m_sourcesList, &QListWidget::itemPressed, this, [this](QListWidgetItem *item) {
 		Qt::CheckState newState = (item->checkState() == Qt::Checked) ? Qt::Unchecked : Qt::Checked;
@@ -213,6 +302,11 @@ void HolyricsDialog::setupUI()
 		&HolyricsDialog::refreshSourcesList);
 	sourcesButtonLayout->addWidget(refreshButton);
 
+	m_selectByCombo = new QComboBox(this);
+	connect(m_selectByCombo, QOverload<int>::of(&QComboBox::activated), this,
+		&HolyricsDialog::onSelectByPredicate);
+	sourcesButtonLayout->addWidget(m_selectByCombo);
+
 	sourcesButtonLayout->addStretch();
 	sourcesLayout->addLayout(sourcesButtonLayout);
 
@@ -222,6 +316,82 @@ void HolyricsDialog::setupUI()
 		&HolyricsDialog::onUpdateSources);
 	sourcesLayout->addWidget(m_updateButton);
 
+	QHBoxLayout *createLayout = new QHBoxLayout();
+
+	m_groupSourcesCheck = new QCheckBox(Translations::get("sources.create_grouped"), this);
+	createLayout->addWidget(m_groupSourcesCheck);
+	createLayout->addStretch();
+
+	m_createButton = new QPushButton(Translations::get("sources.create_button"), this);
+	m_createButton->setEnabled(false);
+	connect(m_createButton, &QPushButton::clicked, this,
+		&HolyricsDialog::onCreateSources);
+	createLayout->addWidget(m_createButton);
+
+	sourcesLayout->addLayout(createLayout);
+
+	m_textMirrorCheck = new QCheckBox(Translations::get("text_mirror.enabled"), this);
+	m_textMirrorCheck->setChecked(m_textMirror->isRunning());
+	connect(m_textMirrorCheck, &QCheckBox::toggled, this, [this](bool checked) {
+		if (!checked) {
+			m_textMirror->stop();
+			return;
+		}
+
+		QString ip = getIpFromInputs();
+		int port = getPortFromInput();
+		if (m_textMirror->start(ip, port)) {
+			updateStatus(Translations::get("status.text_mirror_started").arg(HolyricsFinder::formatEndpoint(ip, port)));
+			refreshSourcesList();
+		} else {
+			updateStatus(Translations::get("status.text_mirror_failed"), true);
+			QSignalBlocker blocker(m_textMirrorCheck);
+			m_textMirrorCheck->setChecked(false);
+		}
+	});
+	sourcesLayout->addWidget(m_textMirrorCheck);
+
+	m_governorCheck = new QCheckBox(Translations::get("governor.enabled"), this);
+	m_governorCheck->setChecked(m_governor->isEnabled());
+	connect(m_governorCheck, &QCheckBox::toggled, this, [this](bool checked) {
+		m_governor->setEnabled(checked);
+	});
+	sourcesLayout->addWidget(m_governorCheck);
+
+	m_proxyCheck = new QCheckBox(Translations::get("proxy.enabled").arg(m_finder->proxyPort()), this);
+	m_proxyCheck->setChecked(m_finder->isProxyEnabled());
+	connect(m_proxyCheck, &QCheckBox::toggled, this, [this](bool checked) {
+		HolyricsFinder::ConnectionInfo upstream{getIpFromInputs(), getPortFromInput()};
+		if (m_finder->setProxyEnabled(checked, upstream)) {
+			refreshSourcesList();
+			return;
+		}
+
+		updateStatus(Translations::get("status.proxy_failed").arg(m_finder->proxyPort()), true);
+		QSignalBlocker blocker(m_proxyCheck);
+		m_proxyCheck->setChecked(false);
+	});
+	sourcesLayout->addWidget(m_proxyCheck);
+
+	QHBoxLayout *hostnameLayout = new QHBoxLayout();
+	hostnameLayout->addWidget(new QLabel(Translations::get("hostname.label"), this));
+	m_hostnameInput = new QLineEdit(m_finder->boundHostname(), this);
+	m_hostnameInput->setPlaceholderText(Translations::get("hostname.placeholder"));
+	hostnameLayout->addWidget(m_hostnameInput, 1);
+	QPushButton *bindHostnameButton = new QPushButton(Translations::get("hostname.bind"), this);
+	connect(bindHostnameButton, &QPushButton::clicked, this, [this]() {
+		HolyricsFinder::ConnectionInfo current{getIpFromInputs(), getPortFromInput()};
+		if (!m_finder->bindHostname(m_hostnameInput->text(), current)) {
+			updateStatus(Translations::get("status.hostname_invalid").arg(m_hostnameInput->text()), true);
+		}
+	});
+	hostnameLayout->addWidget(bindHostnameButton);
+	sourcesLayout->addLayout(hostnameLayout);
+
+	m_governorStatsLabel = new QLabel(this);
+	m_governorStatsLabel->setStyleSheet("QLabel { color: gray; }");
+	sourcesLayout->addWidget(m_governorStatsLabel);
+
 	// Docks Tab
 	QWidget *docksTab = new QWidget(this);
 	QVBoxLayout *docksLayout = new QVBoxLayout(docksTab);
@@ -233,10 +403,19 @@ void HolyricsDialog::setupUI()
 	m_docksList = new QListWidget(this);
 	docksLayout->addWidget(m_docksList);
 
+	QHBoxLayout *docksButtonLayout = new QHBoxLayout();
+
 	QPushButton *refreshDocksButton = new QPushButton(Translations::get("docks.refresh"), this);
 	connect(refreshDocksButton, &QPushButton::clicked, this,
 		&HolyricsDialog::refreshDocksList);
-	docksLayout->addWidget(refreshDocksButton);
+	docksButtonLayout->addWidget(refreshDocksButton);
+
+	QPushButton *updateDocksButton = new QPushButton(Translations::get("docks.update_all"), this);
+	connect(updateDocksButton, &QPushButton::clicked, this,
+		&HolyricsDialog::onUpdateDocks);
+	docksButtonLayout->addWidget(updateDocksButton);
+
+	docksLayout->addLayout(docksButtonLayout);
 
 	// Add tabs to tab widget
 	m_tabWidget->addTab(sourcesTab, Translations::get("sources.tab_title"));
@@ -268,47 +447,53 @@ void HolyricsDialog::detectLocalIP()
 		}
 	}
 	
+	// IPv6-only networks: scanning from an IPv6 base probes the neighbor table
+	if (currentDeviceIp.isEmpty()) {
+		for (const QHostAddress &address : addresses) {
+			if (address.protocol() == QAbstractSocket::IPv6Protocol &&
+			    !address.isLoopback() && !address.isLinkLocal()) {
+				currentDeviceIp = address.toString();
+				break;
+			}
+		}
+	}
+	
 	QList<HolyricsFinder::ConnectionInfo> history = m_finder->getConnectionHistory();
 	
 	if (!history.isEmpty()) {
 		const HolyricsFinder::ConnectionInfo &lastConnection = history.first();
 		
-		obs_log(LOG_INFO, "[HolyricsDialog] Found connection history. Last: %s:%d",
-			lastConnection.ip.toUtf8().constData(), lastConnection.port);
-		
 		setIpToInputs(lastConnection.ip);
 		m_portInput->setValue(lastConnection.port);
 		
-		obs_log(LOG_INFO, "[HolyricsDialog] Loaded IP from history: %s:%d",
-			lastConnection.ip.toUtf8().constData(), lastConnection.port);
+		EventLog::detail("dialog", QString("Loaded IP from history: %1")
+						   .arg(HolyricsFinder::formatEndpoint(lastConnection.ip, lastConnection.port)));
 		return;
 	}
 	
-	obs_log(LOG_INFO, "[HolyricsDialog] No connection history found");
+	EventLog::detail("dialog", "No connection history found");
 	
 	if (!currentDeviceIp.isEmpty()) {
-		QStringList parts = currentDeviceIp.split('.');
-		if (parts.size() == 4) {
-			m_octet1->setValue(parts[0].toInt());
-			m_octet2->setValue(parts[1].toInt());
-			m_octet3->setValue(parts[2].toInt());
-			m_octet4->setValue(parts[3].toInt());
-			
-			obs_log(LOG_INFO, "[HolyricsDialog] Using current device IP: %s",
-				currentDeviceIp.toUtf8().constData());
-			return;
-		}
+		setIpToInputs(currentDeviceIp);
+		
+		EventLog::detail("dialog", QString("Using current device IP: %1").arg(currentDeviceIp));
+		return;
 	}
 	
 	m_octet1->setValue(192);
 	m_octet2->setValue(168);
 	m_octet3->setValue(0);
 	m_octet4->setValue(1);
-	obs_log(LOG_INFO, "[HolyricsDialog] Using default IP: 192.168.0.1");
+	EventLog::detail("dialog", "Using default IP: 192.168.0.1");
 }
 
 QString HolyricsDialog::getIpFromInputs() const
 {
+	QHostAddress ipv6(m_ipv6Input->text().trimmed());
+	if (ipv6.protocol() == QAbstractSocket::IPv6Protocol) {
+		return ipv6.toString();
+	}
+
 	return QString("%1.%2.%3.%4")
 		.arg(m_octet1->value())
 		.arg(m_octet2->value())
@@ -323,6 +508,12 @@ int HolyricsDialog::getPortFromInput() const
 
 void HolyricsDialog::setIpToInputs(const QString &ip)
 {
+	if (QHostAddress(ip).protocol() == QAbstractSocket::IPv6Protocol) {
+		m_ipv6Input->setText(ip);
+		return;
+	}
+
+	m_ipv6Input->clear();
 	QStringList parts = ip.split('.');
 	if (parts.size() == 4) {
 		m_octet1->setValue(parts[0].toInt());
@@ -340,6 +531,7 @@ void HolyricsDialog::onTestConnection()
 	updateStatus(Translations::get("status.testing").arg(ip).arg(port));
 	m_testButton->setEnabled(false);
 	m_scanButton->setEnabled(false);
+	m_scanAllButton->setEnabled(false);
 	m_updateButton->setEnabled(false);
 
 	m_finder->testConnection(ip, port);
@@ -355,25 +547,58 @@ void HolyricsDialog::onScanNetwork()
 	m_progressBar->setValue(0);
 	m_testButton->setEnabled(false);
 	m_scanButton->setEnabled(false);
+	m_scanAllButton->setEnabled(false);
 	m_updateButton->setEnabled(false);
 
 	m_finder->scanNetwork(ip, port);
 }
 
+void HolyricsDialog::onScanAllInterfaces()
+{
+	int port = getPortFromInput();
+
+	m_interfaceProgress.clear();
+	updateStatus(Translations::get("status.scanning_interfaces"));
+	m_progressBar->setVisible(true);
+	m_progressBar->setValue(0);
+	m_testButton->setEnabled(false);
+	m_scanButton->setEnabled(false);
+	m_scanAllButton->setEnabled(false);
+	m_updateButton->setEnabled(false);
+
+	m_finder->scanAllInterfaces(port);
+}
+
+void HolyricsDialog::onInterfaceScanProgress(const QString &interfaceName, int current, int total)
+{
+	m_interfaceProgress[interfaceName] = qMakePair(current, total);
+
+	QStringList parts;
+	for (auto it = m_interfaceProgress.constBegin(); it != m_interfaceProgress.constEnd(); ++it) {
+		parts.append(QString("%1 %2/%3").arg(it.key()).arg(it.value().first).arg(it.value().second));
+	}
+	updateStatus(Translations::get("status.scanning_interfaces_progress").arg(parts.join(", ")));
+}
+
 void HolyricsDialog::onUpdateSources()
 {
+	TRACE_SCOPE("HolyricsDialog::onUpdateSources");
+
 	QString ip = getIpFromInputs();
 	int port = getPortFromInput();
 
+	HolyricsFinder::ConnectionInfo bound = m_finder->sourceEndpointFor({ip, port});
+
 	int updatedCount = 0;
 	for (int i = 0; i < m_sourcesList->count(); ++i) {
 		QListWidgetItem *item = m_sourcesList->item(i);
 		if (item->checkState() == Qt::Checked) {
-			QString sourceName = item->text().section(" - ", 0, 0);
+			// Names like "Holyrics - Text" contain the display separator
+			QString sourceName = i < m_catalog.size() ? m_catalog[i].name : item->text().section(" - ", 0, 0);
 			QString urlPath = item->data(Qt::UserRole + 1).toString();
 			
 			if (!urlPath.isEmpty()) {
-				QString newUrl = QString("http://%1:%2%3").arg(ip).arg(port).arg(urlPath);
+				QString newUrl = HolyricsFinder::buildUrl(bound.ip, bound.port, urlPath);
 				m_finder->updateBrowserSourceUrl(sourceName, newUrl);
 				updatedCount++;
 			}
@@ -388,11 +613,97 @@ void HolyricsDialog::onUpdateSources()
 	}
 }
 
+void HolyricsDialog::onCreateSources()
+{
+	TRACE_SCOPE("HolyricsDialog::onCreateSources");
+
+	QString groupName = m_groupSourcesCheck->isChecked() ? QStringLiteral("Holyrics") : QString();
+	HolyricsFinder::ProvisionResult result =
+		m_finder->createHolyricsSources(getIpFromInputs(), getPortFromInput(), groupName);
+
+	if (!result.failed.isEmpty()) {
+		updateStatus(Translations::get("status.sources_provision_failed").arg(result.failed.join(", ")), true);
+	} else {
+		updateStatus(Translations::get("status.sources_provisioned")
+				     .arg(result.created.size())
+				     .arg(result.referenced.size())
+				     .arg(result.reused.size()));
+	}
+
+	refreshSourcesList();
+}
+
+void HolyricsDialog::onFailedOver(const QString &fromEndpoint, const QString &toIp, int toPort, int reboundSources)
+{
+	setIpToInputs(toIp);
+	m_portInput->setValue(toPort);
+	updateStatus(Translations::get("status.failed_over")
+			     .arg(fromEndpoint)
+			     .arg(reboundSources)
+			     .arg(HolyricsFinder::formatEndpoint(toIp, toPort)),
+		     true);
+	refreshSourcesList();
+}
+
+void HolyricsDialog::onHostnameBound(const QString &hostname, bool ok, int rebound)
+{
+	if (!ok) {
+		updateStatus(Translations::get("status.hostname_failed").arg(hostname, getIpFromInputs()), true);
+		return;
+	}
+
+	if (hostname.isEmpty()) {
+		m_hostnameInput->clear();
+		updateStatus(Translations::get("status.hostname_unbound").arg(rebound));
+	} else {
+		updateStatus(Translations::get("status.hostname_bound").arg(hostname).arg(rebound));
+	}
+	refreshSourcesList();
+}
+
+void HolyricsDialog::onSourcesLoadChecked(const QList<LoadVerifier::Result> &results)
+{
+	QStringList failed;
+	for (const LoadVerifier::Result &result : results) {
+		if (!result.loaded) {
+			failed.append(QString("%1 (%2)").arg(result.source, result.error));
+		}
+	}
+
+	if (failed.isEmpty()) {
+		updateStatus(Translations::get("status.sources_loaded").arg(results.size()));
+	} else {
+		updateStatus(Translations::get("status.sources_not_loaded")
+				     .arg(failed.size())
+				     .arg(results.size())
+				     .arg(failed.join(", ")),
+			     true);
+	}
+}
+
+void HolyricsDialog::onGovernorStatsChanged()
+{
+	if (!m_governor->isEnabled()) {
+		m_governorStatsLabel->clear();
+		return;
+	}
+
+	SourceGovernor::Stats stats = m_governor->stats();
+	m_governorStatsLabel->setText(Translations::get("governor.stats")
+					      .arg(stats.tracked)
+					      .arg(stats.idle)
+					      .arg(stats.unloaded)
+					      .arg(qRound(stats.framesAvoidedPerSecond))
+					      .arg(stats.estimatedMemorySavedMb));
+}
+
 void HolyricsDialog::onConnectionSuccess(const QString &ip)
 {
 	m_testButton->setEnabled(true);
 	m_scanButton->setEnabled(true);
+	m_scanAllButton->setEnabled(true);
 	m_updateButton->setEnabled(true);
+	m_createButton->setEnabled(true);
 	m_copyIpButton->setVisible(true);
 
 	updateStatus(Translations::get("status.connection_success").arg(ip));
@@ -407,16 +718,13 @@ void HolyricsDialog::onConnectionSuccess(const QString &ip)
 	
 	for (int i = 0; i < m_sourcesList->count(); ++i) {
 		QListWidgetItem *item = m_sourcesList->item(i);
-		QString itemText = item->text();
+		HolyricsFinder::ConnectionInfo sourceEndpoint;
+		QString urlPath;
 		
-		QRegularExpression ipPortRegex("([0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}):([0-9]{1,5})");
-		QRegularExpressionMatch match = ipPortRegex.match(itemText);
-		
-		if (match.hasMatch()) {
-			QString sourceIp = match.captured(1);
-			int sourcePort = match.captured(2).toInt();
-			
-			if (sourceIp != ip || sourcePort != port) {
+		if (HolyricsFinder::parseEndpointUrl(item->data(Qt::UserRole).toString(), sourceEndpoint, urlPath)) {
+			// Sources on the proxy or the bound hostname are current as long
+			// as they lead to this address
+			if (!m_finder->pointsAt(sourceEndpoint, {ip, port})) {
 				item->setCheckState(Qt::Checked);
 				selectedCount++;
 			} else {
@@ -438,7 +746,9 @@ void HolyricsDialog::onConnectionFailed(const QString &ip)
 {
 	m_testButton->setEnabled(true);
 	m_scanButton->setEnabled(true);
+	m_scanAllButton->setEnabled(true);
 	m_updateButton->setEnabled(false);
+	m_createButton->setEnabled(false);
 	m_copyIpButton->setVisible(false);
 
 	updateStatus(Translations::get("status.connection_failed").arg(ip), true);
@@ -448,17 +758,49 @@ void HolyricsDialog::onScanProgress(int current, int total)
 {
 	m_progressBar->setMaximum(total);
 	m_progressBar->setValue(current);
-	updateStatus(Translations::get("status.scanning_progress").arg(current).arg(total));
+
+	// Interface scans report per-NIC progress through onInterfaceScanProgress
+	if (m_interfaceProgress.isEmpty()) {
+		updateStatus(Translations::get("status.scanning_progress").arg(current).arg(total));
+	}
 }
 
 void HolyricsDialog::onScanComplete()
 {
+	m_interfaceProgress.clear();
 	m_progressBar->setVisible(false);
 	m_testButton->setEnabled(true);
 	m_scanButton->setEnabled(true);
+	m_scanAllButton->setEnabled(true);
 	updateStatus(Translations::get("status.scan_complete"));
 }
 
+void HolyricsDialog::onEndpointsRanked()
+{
+	QList<HolyricsFinder::EndpointStats> ranking = m_finder->getEndpointRanking();
+	if (ranking.isEmpty() || ranking.first().samples == 0) {
+		return;
+	}
+
+	const HolyricsFinder::EndpointStats &best = ranking.first();
+	bool isCurrent = (best.ip == getIpFromInputs() && best.port == getPortFromInput());
+
+	if (!isCurrent && m_finder->isAutoSelectFastest()) {
+		obs_log(LOG_INFO, "[HolyricsDialog] Switching to fastest Holyrics host: %s:%d",
+			best.ip.toUtf8().constData(), best.port);
+		m_portInput->setValue(best.port);
+		m_finder->addConnectionToHistory(best.ip, best.port);
+		onConnectionSuccess(best.ip);
+		isCurrent = true;
+	}
+
+	QString key = isCurrent ? "status.fastest_selected" : "status.fastest_available";
+	updateStatus(Translations::get(key)
+		.arg(best.ip).arg(best.port)
+		.arg(best.medianRttMs, 0, 'f', 1)
+		.arg(best.jitterMs, 0, 'f', 1));
+}
+
 void HolyricsDialog::updateStatus(const QString &message, bool isError)
 {
 	m_statusLabel->setText(message);
@@ -472,96 +814,185 @@ void HolyricsDialog::updateStatus(const QString &message, bool isError)
 	}
 }
 
+void HolyricsDialog::onSourcesFilterChanged(const QString &text)
+{
+	// Only the prebuilt keys are searched; OBS isn't touched per keystroke
+	QStringList terms = SourceCatalog::queryTerms(text);
+	
+	m_sourcesList->setUpdatesEnabled(false);
+	for (int i = 0; i < m_sourcesList->count() && i < m_searchIndex.size(); ++i) {
+		m_sourcesList->item(i)->setHidden(!SourceCatalog::matches(m_searchIndex[i], terms));
+	}
+	m_sourcesList->setUpdatesEnabled(true);
+}
+
+void HolyricsDialog::onSelectByPredicate(int index)
+{
+	QString predicate = m_selectByCombo->itemData(index).toString();
+	if (predicate.isEmpty()) {
+		return;
+	}
+
+	QString ip = getIpFromInputs();
+	int port = getPortFromInput();
+	QString scene = predicate.startsWith("scene:") ? predicate.mid(6) : QString();
+
+	for (int i = 0; i < m_sourcesList->count() && i < m_catalog.size(); ++i) {
+		const SourceCatalog::Entry &entry = m_catalog[i];
+		QListWidgetItem *item = m_sourcesList->item(i);
+
+		bool selected = false;
+		if (predicate == "stale") {
+			selected = !m_finder->pointsAt(entry.endpoint, {ip, port});
+		} else if (predicate == "matching") {
+			selected = !item->isHidden();
+		} else if (!scene.isEmpty()) {
+			selected = entry.scenes.contains(scene);
+		}
+		item->setCheckState(selected ? Qt::Checked : Qt::Unchecked);
+	}
+
+	m_selectByCombo->setCurrentIndex(0);
+}
+
 void HolyricsDialog::refreshSourcesList()
 {
+	TRACE_SCOPE("HolyricsDialog::refreshSourcesList");
+
+	// One repaint for the whole list instead of one per item
+	m_sourcesList->setUpdatesEnabled(false);
 	m_sourcesList->clear();
 
-	obs_enum_sources([](void *param, obs_source_t *source) {
-		HolyricsDialog *dialog = static_cast<HolyricsDialog *>(param);
-		
-		const char *sourceId = obs_source_get_id(source);
-		if (strcmp(sourceId, "browser_source") != 0) {
-			return true;
+	m_catalog = SourceCatalog::snapshot();
+	m_searchIndex.clear();
+	m_searchIndex.reserve(m_catalog.size());
+
+	QStringList sceneNames;
+	for (const SourceCatalog::Entry &entry : m_catalog) {
+		m_searchIndex.append(SourceCatalog::searchKey(entry));
+		for (const QString &scene : entry.scenes) {
+			if (!sceneNames.contains(scene)) {
+				sceneNames.append(scene);
+			}
 		}
 
-		obs_data_t *settings = obs_source_get_settings(source);
-		const char *url = obs_data_get_string(settings, "url");
-		QString urlStr = QString::fromUtf8(url);
-		obs_data_release(settings);
+		QString displayText = QString("%1 - %2").arg(entry.name)
+			.arg(HolyricsFinder::formatEndpoint(entry.endpoint.ip, entry.endpoint.port));
+		
+		QListWidgetItem *item = new QListWidgetItem(displayText, m_sourcesList);
+		item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+		item->setCheckState(Qt::Unchecked);
+		item->setData(Qt::UserRole, entry.url);
+		item->setData(Qt::UserRole + 1, entry.urlPath);
+	}
+
+	m_selectByCombo->clear();
+	m_selectByCombo->addItem(Translations::get("sources.select_by"), QString());
+	m_selectByCombo->addItem(Translations::get("sources.select_stale"), QStringLiteral("stale"));
+	m_selectByCombo->addItem(Translations::get("sources.select_matching"), QStringLiteral("matching"));
+	sceneNames.sort(Qt::CaseInsensitive);
+	for (const QString &scene : sceneNames) {
+		m_selectByCombo->addItem(Translations::get("sources.select_scene").arg(scene), QStringLiteral("scene:") + scene);
+	}
 
-		QRegularExpression ipPortRegex("https?://([0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}):([0-9]{1,5})(.*)");
-		QRegularExpressionMatch match = ipPortRegex.match(urlStr);
+	// Keep whatever the user was searching for applied to the new list
+	onSourcesFilterChanged(m_sourcesSearch->text());
+	m_sourcesList->setUpdatesEnabled(true);
+	m_updateButton->setEnabled(m_sourcesList->count() > 0);
+}
 
-		if (match.hasMatch()) {
-			QString sourceIp = match.captured(1);
-			QString sourcePort = match.captured(2);
-			QString urlPath = match.captured(3);
-			const char *sourceName = obs_source_get_name(source);
-			
-			QString displayText = QString("%1 - %2:%3").arg(sourceName).arg(sourceIp).arg(sourcePort);
-			
-			QListWidgetItem *item = new QListWidgetItem(displayText, dialog->m_sourcesList);
-			item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
-			item->setCheckState(Qt::Unchecked);
-			item->setData(Qt::UserRole, urlStr);
-			item->setData(Qt::UserRole + 1, urlPath);
+void HolyricsDialog::onUpdateDocks()
+{
+	TRACE_SCOPE("HolyricsDialog::onUpdateDocks");
+
+	HolyricsFinder::ConnectionInfo to{getIpFromInputs(), getPortFromInput()};
+
+	QList<DocksConfig::Dock> docks;
+	DocksConfig::read(docks);
+
+	// Docks can hold any page, so only move those that look like Holyrics
+	// or point at a host we've already connected to, as the verifier does
+	QSet<QString> paths;
+	for (const HolyricsFinder::HolyricsSource &definition : HolyricsFinder::getSourceDefinitions()) {
+		paths.insert(definition.urlPath);
+	}
+	QSet<QString> known;
+	for (const HolyricsFinder::ConnectionInfo &endpoint : m_finder->getConnectionHistory()) {
+		known.insert(HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port));
+	}
+
+	QList<HolyricsFinder::ConnectionInfo> from;
+	for (const DocksConfig::Dock &dock : docks) {
+		HolyricsFinder::ConnectionInfo endpoint;
+		QString urlPath;
+		if (!HolyricsFinder::parseEndpointUrl(dock.url, endpoint, urlPath) ||
+		    m_finder->pointsAt(endpoint, to)) {
+			continue;
+		}
+		QString key = HolyricsFinder::formatEndpoint(endpoint.ip, endpoint.port);
+		if (paths.contains(urlPath) || known.contains(key)) {
+			from.append(endpoint);
 		}
+	}
 
-		return true;
-	}, this);
+	QStringList changedTitles;
+	if (!DocksConfig::rewriteEndpoints(from, to, changedTitles)) {
+		updateStatus(Translations::get("status.docks_update_failed"), true);
+		return;
+	}
 
-	m_updateButton->setEnabled(m_sourcesList->count() > 0);
+	if (changedTitles.isEmpty()) {
+		updateStatus(Translations::get("status.docks_up_to_date"));
+	} else {
+		// OBS builds each dock's browser once from the config and only its
+		// own Custom Browser Docks dialog can point it elsewhere, so docks
+		// already created keep the old page until OBS restarts
+		QStringList loaded = loadedDocks(changedTitles);
+		if (loaded.isEmpty()) {
+			updateStatus(Translations::get("status.docks_updated").arg(changedTitles.size()));
+		} else {
+			updateStatus(Translations::get("status.docks_updated_restart")
+					     .arg(changedTitles.size())
+					     .arg(loaded.join(", ")));
+		}
+	}
+	refreshDocksList();
 }
 
-QString HolyricsDialog::getObsConfigPath() const
+QStringList HolyricsDialog::loadedDocks(const QStringList &titles) const
 {
-	// On Windows, OBS stores config in %APPDATA%/obs-studio
-	QString appDataPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
-	
-	// QStandardPaths::AppDataLocation returns something like:
-	// C:/Users/Username/AppData/Roaming/obs-holyrics-plugin-finder
-	// We need to get to C:/Users/Username/AppData/Roaming/obs-studio
-	
-	QDir appDataDir(appDataPath);
-	appDataDir.cdUp(); // Go to Roaming directory
-	QString obsConfigPath = appDataDir.absolutePath() + "/obs-studio";
-	
-	obs_log(LOG_INFO, "Detected OBS config path: %s", obsConfigPath.toUtf8().constData());
-	
-	return obsConfigPath;
+	QStringList loaded;
+	auto *mainWindow = static_cast<QMainWindow *>(obs_frontend_get_main_window());
+	if (!mainWindow) {
+		return loaded;
+	}
+
+	// OBS names custom browser docks after their title
+	for (QDockWidget *dock : mainWindow->findChildren<QDockWidget *>()) {
+		for (const QString &title : titles) {
+			if ((dock->objectName() == title + "_extraBrowser" || dock->windowTitle() == title) &&
+			    !loaded.contains(title)) {
+				loaded.append(title);
+			}
+		}
+	}
+	return loaded;
 }
 
 void HolyricsDialog::refreshDocksList()
 {
+	TRACE_SCOPE("HolyricsDialog::refreshDocksList");
+
 	m_docksList->clear();
 
-	QString configPath = getObsConfigPath();
-	QString userIniPath = configPath + "/user.ini";
-	
-	obs_log(LOG_INFO, "Looking for OBS user.ini at: %s", userIniPath.toUtf8().constData());
-	
-	QFile file(userIniPath);
-	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-		obs_log(LOG_WARNING, "OBS user.ini not found or cannot be opened");
+	QList<DocksConfig::Dock> docks;
+	if (!DocksConfig::read(docks)) {
 		QListWidgetItem *item = new QListWidgetItem(Translations::get("docks.not_found"), m_docksList);
 		item->setFlags(item->flags() & ~Qt::ItemIsEnabled);
 		return;
 	}
 	
-	QString docksJson;
-	QTextStream in(&file);
-	while (!in.atEnd()) {
-		QString line = in.readLine().trimmed();
-		if (line.startsWith("ExtraBrowserDocks=")) {
-			docksJson = line.mid(18);
-			break;
-		}
-	}
-	file.close();
-	
-	obs_log(LOG_INFO, "ExtraBrowserDocks JSON: %s", docksJson.toUtf8().constData());
-	
-	if (docksJson.isEmpty() || docksJson == "[]") {
+	if (docks.isEmpty()) {
 		QListWidgetItem *item = new QListWidgetItem(Translations::get("docks.none_found"), m_docksList);
 		item->setFlags(item->flags() & ~Qt::ItemIsEnabled);
 		return;
@@ -569,39 +1000,29 @@ void HolyricsDialog::refreshDocksList()
 	
 	QString ip = getIpFromInputs();
 	int port = getPortFromInput();
-	QRegularExpression ipPortRegex("https?://([0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}):([0-9]{1,5})(.*)");
-	QRegularExpression dockRegex("\\{\"title\":\\s*\"([^\"]+)\"\\s*,\\s*\"url\":\\s*\"([^\"]+)\"");
-	QRegularExpressionMatchIterator matches = dockRegex.globalMatch(docksJson);
-	
-	int totalDocks = 0;
 	int matchedDocks = 0;
 	
-	while (matches.hasNext()) {
-		QRegularExpressionMatch match = matches.next();
-		QString dockTitle = match.captured(1);
-		QString dockUrl = match.captured(2);
-		
-		if (dockUrl.isEmpty()) continue;
+	for (const DocksConfig::Dock &dock : docks) {
+		const QString &dockTitle = dock.title;
+		const QString &dockUrl = dock.url;
 		
-		totalDocks++;
-		obs_log(LOG_INFO, "Dock '%s' URL: %s", dockTitle.toUtf8().constData(), dockUrl.toUtf8().constData());
+		EventLog::detail("docks", QString("Dock '%1' URL: %2").arg(dockTitle, dockUrl));
 		
-		QRegularExpressionMatch urlMatch = ipPortRegex.match(dockUrl);
-		if (urlMatch.hasMatch()) {
+		HolyricsFinder::ConnectionInfo dockEndpoint;
+		QString urlPath;
+		if (HolyricsFinder::parseEndpointUrl(dockUrl, dockEndpoint, urlPath)) {
 			matchedDocks++;
-			QString dockIp = urlMatch.captured(1);
-			int dockPort = urlMatch.captured(2).toInt();
-			QString urlPath = urlMatch.captured(3);
 			
-			bool needsUpdate = (dockIp != ip || dockPort != port);
-			QString displayText = QString("%1 - %2:%3 %4")
-				.arg(dockTitle).arg(dockIp).arg(dockPort)
+			bool needsUpdate = !m_finder->pointsAt(dockEndpoint, {ip, port});
+			QString displayText = QString("%1 - %2 %3")
+				.arg(dockTitle)
+				.arg(HolyricsFinder::formatEndpoint(dockEndpoint.ip, dockEndpoint.port))
 				.arg(needsUpdate ? "⚠" : "✓");
 			
 			QListWidgetItem *item = new QListWidgetItem(m_docksList);
 			
 			if (needsUpdate) {
-				QString newUrl = QString("http://%1:%2%3").arg(ip).arg(port).arg(urlPath);
+				QString newUrl = HolyricsFinder::buildUrl(ip, port, urlPath);
 				
 				QWidget *itemWidget = new QWidget();
 				QHBoxLayout *itemLayout = new QHBoxLayout(itemWidget);
@@ -633,5 +1054,5 @@ void HolyricsDialog::refreshDocksList()
 		item->setFlags(item->flags() & ~Qt::ItemIsEnabled);
 	}
 	
-	obs_log(LOG_INFO, "Found %d docks (%d matched IP:port)", m_docksList->count(), matchedDocks);
+	EventLog::detail("docks", QString("Found %1 docks (%2 matched IP:port)").arg(m_docksList->count()).arg(matchedDocks));
 }
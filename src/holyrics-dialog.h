@@ -18,44 +18,86 @@ the Free Software Foundation; either version 2 of the License, or
 #include <QProgressBar>
 #include <QListWidget>
 #include <QTabWidget>
+#include <QCheckBox>
+#include <QMap>
+#include <QPair>
+#include <QStringList>
+#include "load-verifier.h"
+#include "source-catalog.h"
 
 class HolyricsFinder;
+class QComboBox;
+class SourceGovernor;
+class TextMirror;
+class FailoverMonitor;
 
 class HolyricsDialog : public QDialog {
 	Q_OBJECT
 
 public:
-	explicit HolyricsDialog(QWidget *parent, HolyricsFinder *finder);
+	explicit HolyricsDialog(QWidget *parent, HolyricsFinder *finder, SourceGovernor *governor,
+				TextMirror *textMirror, FailoverMonitor *failover);
 	~HolyricsDialog();
 
 private slots:
 	void onTestConnection();
 	void onScanNetwork();
+	void onScanAllInterfaces();
+	void onInterfaceScanProgress(const QString &interfaceName, int current, int total);
 	void onUpdateSources();
+	void onCreateSources();
 	void onConnectionSuccess(const QString &ip);
 	void onConnectionFailed(const QString &ip);
 	void onScanProgress(int current, int total);
 	void onScanComplete();
+	void onEndpointsRanked();
+	void onGovernorStatsChanged();
+	void onFailedOver(const QString &fromEndpoint, const QString &toIp, int toPort, int reboundSources);
+	void onHostnameBound(const QString &hostname, bool ok, int rebound);
+	void onSourcesLoadChecked(const QList<LoadVerifier::Result> &results);
 	void refreshSourcesList();
+	void onSourcesFilterChanged(const QString &text);
+	void onSelectByPredicate(int index);
 	void refreshDocksList();
+	void onUpdateDocks();
 
 private:
 	HolyricsFinder *m_finder;
+	SourceGovernor *m_governor;
+	TextMirror *m_textMirror;
+	FailoverMonitor *m_failover;
 
 	QSpinBox *m_octet1;
 	QSpinBox *m_octet2;
 	QSpinBox *m_octet3;
 	QSpinBox *m_octet4;
 	QSpinBox *m_portInput;
+	QLineEdit *m_ipv6Input;
 	QPushButton *m_testButton;
 	QPushButton *m_scanButton;
+	QPushButton *m_scanAllButton;
 	QPushButton *m_updateButton;
 	QPushButton *m_copyIpButton;
+	QPushButton *m_createButton;
+	QCheckBox *m_groupSourcesCheck;
+	QCheckBox *m_governorCheck;
+	QCheckBox *m_textMirrorCheck;
+	QCheckBox *m_proxyCheck;
+	QLineEdit *m_hostnameInput;
+	QCheckBox *m_failoverCheck;
+	QLineEdit *m_failoverInput;
+	QLabel *m_governorStatsLabel;
+	QCheckBox *m_autoFastestCheck;
 	QLabel *m_statusLabel;
 	QProgressBar *m_progressBar;
 	QTabWidget *m_tabWidget;
 	QListWidget *m_sourcesList;
+	QLineEdit *m_sourcesSearch;
+	QComboBox *m_selectByCombo;
+	QList<SourceCatalog::Entry> m_catalog;
+	QStringList m_searchIndex;
 	QListWidget *m_docksList;
+	QMap<QString, QPair<int, int>> m_interfaceProgress;
 
 	void setupUI();
 	void detectLocalIP();
@@ -63,5 +105,6 @@ private:
 	int getPortFromInput() const;
 	void setIpToInputs(const QString &ip);
 	void updateStatus(const QString &message, bool isError = false);
-	QString getObsConfigPath() const;
+	// Which of `titles` OBS has already built a dock widget for
+	QStringList loadedDocks(const QStringList &titles) const;
 };
@@ -9,6 +9,16 @@ the Free Software Foundation; either version 2 of the License, or
 */
 
 #include "holyrics-finder.h"
+#include "event-log.h"
+#include "host-resolver.h"
+#include "load-verifier.h"
+#include "marker-matcher.h"
+#include "neighbor-cache.h"
+#include "scan-pacing.h"
+#include "scan-targets.h"
+#include "stage-proxy.h"
+#include "subnet-scanner.h"
+#include "trace.h"
 #include <obs-module.h>
 #include <obs-frontend-api.h>
 #include <plugin-support.h>
@@ -21,36 +31,109 @@ the Free Software Foundation; either version 2 of the License, or
 #include <QMessageBox>
 #include <QRegularExpression>
 #include <QUuid>
+#include <QFutureWatcher>
 #include <QSet>
+#include <QTimer>
+#include <QHostAddress>
+#include <QNetworkInterface>
+#include <algorithm>
+#include <cstring>
+
+static const QNetworkRequest::Attribute kProbeKindAttribute =
+	static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+static const QNetworkRequest::Attribute kProbeStartAttribute =
+	static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 2);
+static const QNetworkRequest::Attribute kProbeGenerationAttribute =
+	static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 3);
+static const QNetworkRequest::Attribute kProbeRequestAttribute =
+	static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 4);
+
+enum ProbeKind {
+	ProbeConnection = 0,
+	ProbeRank = 1
+};
+
+// How long a scan keeps listening after the first hit so that other
+// Holyrics hosts answering the same sweep can be ranked against it.
+static const int kScanCollectWindowMs = 300;
+static const int kRankProbeSpacingMs = 25;
+static const int kRankProbeTimeoutMs = 1000;
+static const int kMaxRttSamples = 16;
+static const int kDefaultInterfaceConcurrency = 64;
+// Interface sweeps cover the /24 around the local address, or the whole
+// network down to a /16 when scan/wideSubnets is turned on
+static const int kWidestSweepPrefix = 16;
+static const int kNarrowSweepPrefix = 24;
+// The default-route sweep keeps the whole /24 in flight, like it always has
+static const int kDefaultScanConcurrency = 256;
+static const int kMinBaselineSamples = 3;
+// How often a running scan re-reads the output state for pacing
+static const int kPacingCheckMs = 1000;
+static const int kDefaultProxyPort = 18091;
+static const int kConnectionTestTimeoutMs = 2000;
+
+static const char *kCancelledError = "cancelled";
+static const char *kSupersededError = "superseded";
 
 HolyricsFinder::HolyricsFinder(QObject *parent)
 	: QObject(parent),
-	  m_networkManager(new QNetworkAccessManager(this)),
-	  m_settings(new QSettings("OBS", "HolyricsFinder")),
-	  m_scanningCount(0),
-	  m_scanningTotal(0),
+	  m_networkManager(nullptr),
+	  m_settings(nullptr),
 	  m_currentPort(80),
 	  m_isShuttingDown(false),
-	  m_scanFoundConnection(false)
+	  m_nextRequestId(0),
+	  m_scanRequestId(0),
+	  m_scanRequestBound(false),
+	  m_scanFoundConnection(false),
+	  m_scanGeneration(0),
+	  m_pacingTimer(nullptr),
+	  m_scanPaced(false),
+	  m_proxy(nullptr),
+	  m_resolver(nullptr),
+	  m_loadVerifier(nullptr),
+	  m_rankOutstanding(0),
+	  m_rankGeneration(0)
 {
-	connect(m_networkManager, &QNetworkAccessManager::finished, this,
-		&HolyricsFinder::onNetworkReply);
-	
-	logConnectionHistory();
+	// Settings and the network stack are created on first use so that
+	// obs_module_load doesn't pay for disk I/O or socket setup.
+	m_clock.start();
 }
 
 HolyricsFinder::~HolyricsFinder()
 {
-	obs_log(LOG_INFO, "[HolyricsFinder] Destructor called");
+	EventLog::detail("finder", "Destructor called");
 	
-	m_isShuttingDown = true;
+	if (!m_isShuttingDown) {
+		prepareForShutdown();
+	}
 	
-	// Don't delete Qt objects during shutdown - Qt's event system is shutting down
-	// and any Qt calls can crash. Just set to nullptr and let the OS clean up.
+	// Only reached while Qt is still up (see obs_module_unload). Replies
+	// and scanner sockets are children and go with their owners.
+	delete m_networkManager;
 	m_networkManager = nullptr;
+	delete m_settings;
 	m_settings = nullptr;
 	
-	obs_log(LOG_INFO, "[HolyricsFinder] Destructor complete");
+	EventLog::detail("finder", "Destructor complete");
+}
+
+QSettings *HolyricsFinder::settings() const
+{
+	if (!m_settings) {
+		TRACE_SCOPE("HolyricsFinder::settings (load)");
+		m_settings = new QSettings("OBS", "HolyricsFinder");
+	}
+	return m_settings;
+}
+
+QNetworkAccessManager *HolyricsFinder::network()
+{
+	if (!m_networkManager) {
+		m_networkManager = new QNetworkAccessManager(this);
+		connect(m_networkManager, &QNetworkAccessManager::finished, this,
+			&HolyricsFinder::onNetworkReply);
+	}
+	return m_networkManager;
 }
 
 QList<HolyricsFinder::HolyricsSource> HolyricsFinder::getSourceDefinitions()
@@ -65,20 +148,17 @@ QList<HolyricsFinder::HolyricsSource> HolyricsFinder::getSourceDefinitions()
 
 QStringList HolyricsFinder::getIpHistory() const
 {
-	return m_settings->value("ipHistory", QStringList()).toStringList();
+	return settings()->value("ipHistory", QStringList()).toStringList();
 }
 
 QList<HolyricsFinder::ConnectionInfo> HolyricsFinder::getConnectionHistory() const
 {
 	QList<ConnectionInfo> history;
-	QStringList connections = m_settings->value("connectionHistory", QStringList()).toStringList();
+	QStringList connections = settings()->value("connectionHistory", QStringList()).toStringList();
 	
 	for (const QString &connStr : connections) {
-		QStringList parts = connStr.split(':');
-		if (parts.size() == 2) {
-			ConnectionInfo info;
-			info.ip = parts[0];
-			info.port = parts[1].toInt();
+		ConnectionInfo info;
+		if (parseEndpoint(connStr, info)) {
 			history.append(info);
 		}
 	}
@@ -88,6 +168,8 @@ QList<HolyricsFinder::ConnectionInfo> HolyricsFinder::getConnectionHistory() con
 
 void HolyricsFinder::addIpToHistory(const QString &ip)
 {
+	TRACE_SCOPE("HolyricsFinder::addIpToHistory");
+
 	QStringList history = getIpHistory();
 	
 	history.removeAll(ip);
@@ -97,14 +179,16 @@ void HolyricsFinder::addIpToHistory(const QString &ip)
 		history.removeLast();
 	}
 	
-	m_settings->setValue("ipHistory", history);
-	m_settings->sync();
+	settings()->setValue("ipHistory", history);
+	settings()->sync();
 }
 
 void HolyricsFinder::addConnectionToHistory(const QString &ip, int port)
 {
-	QString connStr = QString("%1:%2").arg(ip).arg(port);
-	QStringList history = m_settings->value("connectionHistory", QStringList()).toStringList();
+	TRACE_SCOPE("HolyricsFinder::addConnectionToHistory");
+
+	QString connStr = formatEndpoint(ip, port);
+	QStringList history = settings()->value("connectionHistory", QStringList()).toStringList();
 	
 	history.removeAll(connStr);
 	history.prepend(connStr);
@@ -113,172 +197,419 @@ void HolyricsFinder::addConnectionToHistory(const QString &ip, int port)
 		history.removeLast();
 	}
 	
-	m_settings->setValue("connectionHistory", history);
-	m_settings->sync();
+	settings()->setValue("connectionHistory", history);
+	settings()->sync();
 	
-	obs_log(LOG_INFO, "[HolyricsFinder] Added connection to history: %s:%d",
-		ip.toUtf8().constData(), port);
+	EventLog::detail("history", QString("Added %1").arg(connStr));
 	
 	addIpToHistory(ip);
-	
-	logConnectionHistory();
 }
 
 void HolyricsFinder::scanNetwork(const QString &baseIp, int port)
 {
-	QStringList parts = baseIp.split('.');
-	if (parts.size() != 4) {
+	QHostAddress base(baseIp);
+	if (base.isNull()) {
 		obs_log(LOG_WARNING, "Invalid IP format for scanning: %s",
 			baseIp.toUtf8().constData());
 		return;
 	}
 
-	abortPendingRequests();
-	
-	m_currentPort = port;
-	m_scanFoundConnection = false;
+	resetScan(port);
 
 	QList<ConnectionInfo> history = getConnectionHistory();
-	QSet<QString> historyIps;
-	int historyTestCount = 0;
+	ScanTargets targets(quint16(port));
 	
-	for (const ConnectionInfo &conn : history) {
-		if (conn.port == port) {
-			historyIps.insert(conn.ip);
-			historyTestCount++;
-		}
+	// IPv4 subnets are small enough to sweep; IPv6 ones are not, so IPv6
+	// candidates come from the neighbor table and are probed concurrently.
+	QString networkKey = baseIp;
+	if (base.protocol() == QAbstractSocket::IPv4Protocol) {
+		quint32 subnet = base.toIPv4Address() & 0xFFFFFF00u;
+		networkKey = QString("%1/24").arg(QHostAddress(subnet).toString());
+		targets.setRange(subnet | 1, subnet | 254);
 	}
-
-	QString base = QString("%1.%2.%3.").arg(parts[0], parts[1], parts[2]);
-	QStringList ipsToScan;
 	
+	// History hosts go first and are taken out of the sweep
 	for (const ConnectionInfo &conn : history) {
 		if (conn.port == port) {
-			ipsToScan.prepend(conn.ip);
+			targets.addHost(QHostAddress(conn.ip));
 		}
 	}
+	int historyTestCount = targets.listedCount();
 	
-	for (int i = 1; i <= 254; ++i) {
-		QString ip = base + QString::number(i);
-		if (!historyIps.contains(ip)) {
-			ipsToScan.append(ip);
-		}
+	for (const QHostAddress &neighbor : NeighborCache::ipv6Candidates()) {
+		targets.addHost(neighbor);
 	}
+	int neighborCount = targets.listedCount() - historyTestCount;
+	int sweepCount = targets.size() - targets.listedCount();
 	
-	m_scanningCount = 0;
-	m_scanningTotal = ipsToScan.size();
+	EventLog::info("scan", QString("Scanning %1 connection(s) from history, %2 subnet IPs and %3 IPv6 neighbor(s)")
+				       .arg(historyTestCount)
+				       .arg(sweepCount)
+				       .arg(neighborCount));
 	
-	if (historyTestCount > 0) {
-		obs_log(LOG_INFO, "Testing %d connection(s) from history first, then %d other IPs",
-			historyTestCount, m_scanningTotal - historyTestCount);
+	if (targets.isEmpty()) {
+		settleScanRequest({}, QString());
+		emit scanComplete();
+		return;
 	}
 	
-	for (const QString &ip : ipsToScan) {
-		testConnection(ip, port);
-	}
+	SubnetScanner *scanner = addScanner(networkKey, QHostAddress(), networkKey, targets,
+					    kDefaultScanConcurrency);
+	scanner->setPatientTargets(historyTestCount);
+	startScanners();
 }
 
 void HolyricsFinder::testConnection(const QString &ip, int port)
 {
-	if (m_scanFoundConnection && m_scanningTotal > 0) {
+	// Starting a scan cancels the test quietly (see abortPendingRequests)
+	quint64 id = startProbe({ip, port}, kConnectionTestTimeoutMs, [this](const ProbeResult &result) {
+		m_connectionTests.removeOne(result.requestId);
+		if (result.ok) {
+			addConnectionToHistory(result.endpoint.ip, result.endpoint.port);
+			emit connectionSuccess(result.endpoint.ip);
+		} else if (result.error != kCancelledError) {
+			emit connectionFailed(result.endpoint.ip);
+		}
+	});
+	m_connectionTests.append(id);
+}
+
+// Settles a request's future; a no-op if the caller already cancelled it
+template<typename Result>
+static void settle(const std::shared_ptr<QPromise<Result>> &promise, const Result &result)
+{
+	promise->addResult(result);
+	promise->finish();
+}
+
+template<typename Result>
+HolyricsFinder::Request<Result> HolyricsFinder::watchRequest(quint64 id,
+							     const std::shared_ptr<QPromise<Result>> &promise)
+{
+	QFuture<Result> future = promise->future();
+
+	// Cancelling the future from the caller's side stops the work as well
+	auto *watcher = new QFutureWatcher<Result>(this);
+	connect(watcher, &QFutureWatcherBase::canceled, this, [this, id]() { cancelRequest(id); });
+	connect(watcher, &QFutureWatcherBase::finished, watcher, &QObject::deleteLater);
+	watcher->setFuture(future);
+
+	return {id, future};
+}
+
+quint64 HolyricsFinder::startProbe(const ConnectionInfo &endpoint, int timeoutMs,
+				   std::function<void(const ProbeResult &)> done)
+{
+	quint64 id = ++m_nextRequestId;
+
+	QNetworkRequest request(QUrl(buildUrl(endpoint.ip, endpoint.port, "/")));
+	request.setAttribute(kProbeKindAttribute, ProbeConnection);
+	request.setAttribute(kProbeStartAttribute, m_clock.nsecsElapsed());
+	request.setAttribute(kProbeRequestAttribute, QVariant::fromValue(id));
+	request.setTransferTimeout(timeoutMs);
+
+	PendingProbe pending;
+	pending.endpoint = endpoint;
+	pending.reply = network()->get(request);
+	pending.done = std::move(done);
+	m_probes.insert(id, pending);
+
+	// Flagged first: a transfer timeout aborts the reply the same way
+	m_cancellers.insert(id, [this, id]() {
+		auto it = m_probes.find(id);
+		if (it != m_probes.end() && it->reply->isRunning()) {
+			it->cancelled = true;
+			it->reply->abort();
+		}
+	});
+	return id;
+}
+
+void HolyricsFinder::finishProbe(quint64 requestId, QNetworkReply *reply, double rttMs)
+{
+	PendingProbe pending = m_probes.take(requestId);
+	m_cancellers.remove(requestId);
+	if (!pending.done) {
 		return;
 	}
-	
-	QUrl qurl(QString("http://%1:%2/").arg(ip).arg(port));
-	QNetworkRequest request;
-	request.setUrl(qurl);
-	request.setAttribute(QNetworkRequest::Attribute::User, QVariant(ip));
-	request.setTransferTimeout(2000);
 
-	QNetworkReply *reply = m_networkManager->get(request);
-	if (m_scanningTotal > 0) {
-		m_pendingReplies.append(reply);
+	ProbeResult result;
+	result.requestId = requestId;
+	result.endpoint = pending.endpoint;
+	result.rttMs = rttMs;
+
+	if (pending.cancelled) {
+		result.error = kCancelledError;
+	} else if (reply->error() != QNetworkReply::NoError) {
+		result.error = reply->errorString();
+	} else {
+		QByteArray response = reply->readAll();
+		if (isHolyricsResponse(response)) {
+			EventLog::info("scan", QString("Holyrics found at %1 (%2 ms)")
+						       .arg(formatEndpoint(result.endpoint.ip, result.endpoint.port))
+						       .arg(rttMs, 0, 'f', 1));
+			recordRtt(result.endpoint.ip, result.endpoint.port, rttMs);
+			result.ok = true;
+			result.fingerprint = responseFingerprint(response);
+		} else {
+			result.error = "not a Holyrics page";
+		}
 	}
+
+	pending.done(result);
 }
 
-void HolyricsFinder::onNetworkReply(QNetworkReply *reply)
+HolyricsFinder::Request<HolyricsFinder::ProbeResult> HolyricsFinder::probe(const ConnectionInfo &endpoint,
+									    int timeoutMs)
 {
-	m_pendingReplies.removeOne(reply);
-	reply->deleteLater();
+	auto promise = std::make_shared<QPromise<ProbeResult>>();
+	promise->start();
 
-	QString ip = reply->request().attribute(QNetworkRequest::User).toString();
+	quint64 id = startProbe(endpoint, timeoutMs, [promise](const ProbeResult &result) { settle(promise, result); });
+	return watchRequest(id, promise);
+}
 
-	bool wasScanning = (m_scanningTotal > 0);
-	
-	if (wasScanning) {
-		m_scanningCount++;
-		emit scanProgress(m_scanningCount, m_scanningTotal);
+HolyricsFinder::Request<HolyricsFinder::VerifyResult>
+HolyricsFinder::verify(const QList<ConnectionInfo> &endpoints, int timeoutMs)
+{
+	struct State {
+		VerifyResult result;
+		QList<quint64> probes;
+		int outstanding = 0;
+	};
+
+	auto promise = std::make_shared<QPromise<VerifyResult>>();
+	promise->start();
+	auto state = std::make_shared<State>();
+	quint64 id = ++m_nextRequestId;
+	state->result.requestId = id;
+
+	if (endpoints.isEmpty()) {
+		settle(promise, state->result);
+		return {id, promise->future()};
 	}
 
-	if (reply->error() == QNetworkReply::NoError) {
-		QString response = reply->readAll();
-		
-		if (isHolyricsResponse(response) || response.contains("holyrics", Qt::CaseInsensitive)) {
-			obs_log(LOG_INFO, "Holyrics found at: %s",
-				ip.toUtf8().constData());
-			
-			int port = reply->request().url().port();
-			addConnectionToHistory(ip, port);
-			
-			if (wasScanning) {
-				m_scanFoundConnection = true;
-				m_scanningCount = 0;
-				m_scanningTotal = 0;
-				abortPendingRequests();
-				emit scanComplete();
+	state->outstanding = endpoints.size();
+	for (const ConnectionInfo &endpoint : endpoints) {
+		state->probes.append(startProbe(endpoint, timeoutMs, [this, id, promise, state](const ProbeResult &result) {
+			(result.ok ? state->result.reachable : state->result.unreachable).append(result);
+			if (--state->outstanding == 0) {
+				m_cancellers.remove(id);
+				settle(promise, state->result);
 			}
-			
-			emit connectionSuccess(ip);
-			return;
-		} else if (!wasScanning) {
-			emit connectionFailed(ip);
+		}));
+	}
+
+	m_cancellers.insert(id, [this, state]() {
+		state->result.error = kCancelledError;
+		const QList<quint64> probes = state->probes;
+		for (quint64 probe : probes) {
+			cancelRequest(probe);
 		}
-	} else if (!wasScanning) {
-		emit connectionFailed(ip);
+	});
+	return watchRequest(id, promise);
+}
+
+HolyricsFinder::Request<HolyricsFinder::ScanResult> HolyricsFinder::scan(const QString &baseIp, int port)
+{
+	settleScanRequest({}, kSupersededError);
+
+	m_scanPromise = std::make_shared<QPromise<ScanResult>>();
+	m_scanPromise->start();
+	m_scanRequestId = ++m_nextRequestId;
+	m_scanRequestBound = false;
+
+	quint64 id = m_scanRequestId;
+	m_cancellers.insert(id, [this]() {
+		stopScanning();
+		settleScanRequest({}, kCancelledError);
+	});
+	Request<ScanResult> request = watchRequest(id, m_scanPromise);
+
+	// Binds to the scan in resetScan, which may also finish it synchronously
+	if (baseIp.isEmpty()) {
+		scanAllInterfaces(port);
+	} else {
+		scanNetwork(baseIp, port);
 	}
-	
-	if (wasScanning && m_scanningTotal > 0 && m_scanningCount >= m_scanningTotal) {
-		m_scanningCount = 0;
-		m_scanningTotal = 0;
-		abortPendingRequests();
-		emit scanComplete();
+
+	// scanNetwork turns a bad address away before touching any scan state
+	if (m_scanRequestId == id && !m_scanRequestBound) {
+		settleScanRequest({}, QString("invalid address %1").arg(baseIp));
 	}
+	return request;
 }
 
-bool HolyricsFinder::isHolyricsResponse(const QString &response)
+void HolyricsFinder::settleScanRequest(const QList<ConnectionInfo> &found, const QString &error)
 {
-	return response.contains("holyrics", Qt::CaseInsensitive) ||
-	       response.contains("stage-view", Qt::CaseInsensitive);
+	if (!m_scanPromise) {
+		return;
+	}
+
+	ScanResult result;
+	result.requestId = m_scanRequestId;
+	result.error = error;
+	for (const ConnectionInfo &endpoint : found) {
+		ProbeResult hit;
+		hit.requestId = m_scanRequestId;
+		hit.endpoint = endpoint;
+		hit.ok = true;
+		const QList<double> samples = m_rttSamples.value(endpointKey(endpoint.ip, endpoint.port));
+		hit.rttMs = samples.isEmpty() ? 0.0 : samples.last();
+		result.found.append(hit);
+	}
+
+	// Cleared first: whoever awaits this may start the next scan right away
+	std::shared_ptr<QPromise<ScanResult>> promise = std::move(m_scanPromise);
+	m_cancellers.remove(m_scanRequestId);
+	m_scanRequestId = 0;
+	m_scanRequestBound = false;
+	settle(promise, result);
 }
 
-void HolyricsFinder::createHolyricsSources(const QString &ip, int port)
+bool HolyricsFinder::cancelRequest(quint64 requestId)
 {
-	addConnectionToHistory(ip, port);
-
-	auto sources = getSourceDefinitions();
-	for (const auto &source : sources) {
-		QString url = QString("http://%1:%2%3").arg(ip).arg(port).arg(source.urlPath);
-		createBrowserSource(source.name, url);
+	// Taken out first: cancelling re-enters the code that settles the request
+	std::function<void()> cancel = m_cancellers.take(requestId);
+	if (!cancel) {
+		return false;
 	}
 
-	obs_log(LOG_INFO, "Created %d Holyrics sources for IP: %s:%d",
-		sources.size(), ip.toUtf8().constData(), port);
+	EventLog::detail("requests", QString("Cancelling request %1").arg(requestId));
+	cancel();
+	return true;
 }
 
-void HolyricsFinder::createBrowserSource(const QString &name, const QString &url)
+// The page title tells Holyrics builds (and rebranded ones) apart
+QString HolyricsFinder::responseFingerprint(const QByteArray &response)
 {
-	obs_source_t *currentSceneSource = obs_frontend_get_current_scene();
-	if (!currentSceneSource) {
-		obs_log(LOG_WARNING, "No current scene available");
+	static const QRegularExpression title("<title[^>]*>([^<]*)</title>",
+					      QRegularExpression::CaseInsensitiveOption);
+	QRegularExpressionMatch match = title.match(QString::fromUtf8(response.left(16384)));
+	return match.hasMatch() ? match.captured(1).simplified().left(120) : QString();
+}
+
+void HolyricsFinder::onNetworkReply(QNetworkReply *reply)
+{
+	reply->deleteLater();
+
+	const QNetworkRequest request = reply->request();
+	double rttMs = (m_clock.nsecsElapsed() - request.attribute(kProbeStartAttribute).toLongLong()) / 1e6;
+
+	if (request.attribute(kProbeKindAttribute).toInt() == ProbeRank) {
+		QString ip = request.attribute(QNetworkRequest::User).toString();
+		int port = request.url().port(80);
+		m_rankReplies.removeOne(reply);
+		if (request.attribute(kProbeGenerationAttribute).toInt() != m_rankGeneration) {
+			return;
+		}
+
+		if (reply->error() == QNetworkReply::NoError && isHolyricsResponse(reply->readAll())) {
+			recordRtt(ip, port, rttMs);
+		} else {
+			m_rttFailures[endpointKey(ip, port)]++;
+		}
+
+		if (--m_rankOutstanding == 0) {
+			finishRanking();
+		}
 		return;
 	}
 
-	obs_scene_t *currentScene = obs_scene_from_source(currentSceneSource);
-	if (!currentScene) {
-		obs_log(LOG_WARNING, "Could not get scene from source");
-		obs_source_release(currentSceneSource);
+	finishProbe(request.attribute(kProbeRequestAttribute).toULongLong(), reply, rttMs);
+}
+
+void HolyricsFinder::finishScan(int generation)
+{
+	if (generation != m_scanGeneration || !m_scanFoundConnection || m_isShuttingDown) {
 		return;
 	}
+	
+	m_scanGeneration++;
+	saveRttBaselines();
+	stopScanners();
+	
+	QList<ConnectionInfo> candidates = m_scanCandidates;
+	m_scanCandidates.clear();
+	
+	// Remember which NIC reached Holyrics so health checks can use it later
+	QString winningInterface = m_scanHitInterfaces.value(m_scanFirstHit);
+	m_scanHitInterfaces.clear();
+	if (!winningInterface.isEmpty()) {
+		EventLog::detail("scan", QString("Holyrics reached via interface %1").arg(winningInterface));
+		settings()->setValue("winningInterface", winningInterface);
+		settings()->sync();
+	}
+	
+	// Add in reverse so the first responder ends up at the top of the history
+	for (int i = candidates.size() - 1; i >= 0; --i) {
+		addConnectionToHistory(candidates[i].ip, candidates[i].port);
+	}
+	
+	settleScanRequest(candidates, QString());
+	emit scanComplete();
+	emit connectionSuccess(m_scanFirstHit);
+	
+	if (candidates.size() > 1) {
+		EventLog::info("scan",
+			       QString("Scan found %1 Holyrics hosts, ranking by latency").arg(candidates.size()));
+		rankEndpoints(candidates);
+	}
+}
+
+// Extra markers (e.g. a rebranded build's title) come from probe/fingerprints
+// and are read once; changing them takes an OBS restart
+static const MarkerMatcher &responseMatcher()
+{
+	static const MarkerMatcher matcher = []() {
+		QList<QByteArray> markers{"holyrics", "stage-view"};
+		QSettings settings("OBS", "HolyricsFinder");
+		for (const QString &fingerprint : settings.value("probe/fingerprints").toStringList()) {
+			markers.append(fingerprint.trimmed().toUtf8());
+		}
+		EventLog::info("scan", QString("Response matcher: %1 marker(s), %2")
+					       .arg(markers.size())
+					       .arg(MarkerMatcher::implementation()));
+		return MarkerMatcher(markers);
+	}();
+	return matcher;
+}
+
+bool HolyricsFinder::isHolyricsResponse(const QByteArray &response)
+{
+	return responseMatcher().containsAny(response);
+}
+
+struct SceneBatch {
+	QString groupName;
+	QList<obs_source_t *> sources;
+};
+
+// Runs under the scene lock so all items (and the group) land in one pass
+static void addBatchToScene(void *param, obs_scene_t *scene)
+{
+	SceneBatch *batch = static_cast<SceneBatch *>(param);
+	obs_sceneitem_t *group = nullptr;
+	
+	if (!batch->groupName.isEmpty()) {
+		QByteArray groupName = batch->groupName.toUtf8();
+		group = obs_scene_get_group(scene, groupName.constData());
+		if (!group) {
+			group = obs_scene_add_group2(scene, groupName.constData(), true);
+		}
+	}
+	
+	for (obs_source_t *source : batch->sources) {
+		obs_sceneitem_t *item = obs_scene_add(scene, source);
+		if (item && group) {
+			obs_sceneitem_group_add_item(group, item);
+		}
+	}
+}
+
+static obs_source_t *createBrowserSource(const QString &name, const QString &url)
+{
+	TRACE_SCOPE("createBrowserSource");
 
 	obs_data_t *settings = obs_data_create();
 	obs_data_set_string(settings, "url", url.toUtf8().constData());
@@ -291,25 +622,128 @@ void HolyricsFinder::createBrowserSource(const QString &name, const QString &url
 						 settings, nullptr);
 
 	if (source) {
-		obs_scene_add(currentScene, source);
-		obs_source_release(source);
-		obs_log(LOG_INFO, "Created source: %s with URL: %s",
-			name.toUtf8().constData(),
-			url.toUtf8().constData());
+		EventLog::detail("sources", QString("Created %1 with URL %2").arg(name, url));
 	} else {
-		obs_log(LOG_ERROR, "Failed to create browser source: %s",
-			name.toUtf8().constData());
+		EventLog::error("sources", QString("Failed to create browser source %1").arg(name));
 	}
 
 	obs_data_release(settings);
+	return source;
+}
+
+HolyricsFinder::ProvisionResult HolyricsFinder::createHolyricsSources(const QString &requestedIp, int requestedPort,
+								      const QString &groupName)
+{
+	TRACE_SCOPE("HolyricsFinder::createHolyricsSources");
+
+	ProvisionResult result;
+	ConnectionInfo endpoint = preferredEndpoint(requestedIp, requestedPort);
+	const QString &ip = endpoint.ip;
+	int port = endpoint.port;
+	
+	addConnectionToHistory(ip, port);
+	ConnectionInfo bound = sourceEndpointFor(endpoint);
+
+	obs_source_t *currentSceneSource = obs_frontend_get_current_scene();
+	if (!currentSceneSource) {
+		obs_log(LOG_WARNING, "No current scene available");
+		return result;
+	}
+
+	obs_scene_t *currentScene = obs_scene_from_source(currentSceneSource);
+	if (!currentScene) {
+		obs_log(LOG_WARNING, "Could not get scene from source");
+		obs_source_release(currentSceneSource);
+		return result;
+	}
+
+	// One enumeration to find Holyrics sources that already exist under another name
+	QHash<QString, QString> nameByUrl;
+	obs_enum_sources([](void *param, obs_source_t *source) {
+		if (strcmp(obs_source_get_id(source), "browser_source") != 0) {
+			return true;
+		}
+		
+		auto *names = static_cast<QHash<QString, QString> *>(param);
+		obs_data_t *settings = obs_source_get_settings(source);
+		names->insert(QString::fromUtf8(obs_data_get_string(settings, "url")),
+			      QString::fromUtf8(obs_source_get_name(source)));
+		obs_data_release(settings);
+		return true;
+	}, &nameByUrl);
+
+	SceneBatch batch;
+	batch.groupName = groupName;
+
+	for (const HolyricsSource &definition : getSourceDefinitions()) {
+		QString url = buildUrl(bound.ip, bound.port, definition.urlPath);
+		obs_source_t *source = obs_get_source_by_name(definition.name.toUtf8().constData());
+		bool isNew = false;
+
+		if (source && strcmp(obs_source_get_id(source), "browser_source") != 0) {
+			EventLog::warning("sources",
+					  QString("Source '%1' exists but is not a browser source").arg(definition.name));
+			result.failed.append(definition.name);
+			obs_source_release(source);
+			continue;
+		}
+
+		if (!source && nameByUrl.contains(url)) {
+			source = obs_get_source_by_name(nameByUrl.value(url).toUtf8().constData());
+		}
+
+		if (source) {
+			obs_data_t *settings = obs_source_get_settings(source);
+			if (url != QString::fromUtf8(obs_data_get_string(settings, "url"))) {
+				obs_data_set_string(settings, "url", url.toUtf8().constData());
+				obs_source_update(source, settings);
+			}
+			obs_data_release(settings);
+		} else {
+			source = createBrowserSource(definition.name, url);
+			isNew = true;
+			if (!source) {
+				result.failed.append(definition.name);
+				continue;
+			}
+		}
+
+		QString name = QString::fromUtf8(obs_source_get_name(source));
+		if (obs_scene_find_source_recursive(currentScene, name.toUtf8().constData())) {
+			result.reused.append(name);
+			obs_source_release(source);
+		} else {
+			(isNew ? result.created : result.referenced).append(name);
+			batch.sources.append(source);
+		}
+	}
+
+	if (!batch.sources.isEmpty()) {
+		obs_scene_atomic_update(currentScene, addBatchToScene, &batch);
+	}
+
+	for (obs_source_t *source : batch.sources) {
+		obs_source_release(source);
+	}
 	obs_source_release(currentSceneSource);
+
+	EventLog::info("sources", QString("Provisioned for %1: %2 created, %3 added to scene, %4 already present, %5 failed")
+					  .arg(formatEndpoint(ip, port))
+					  .arg(result.created.size())
+					  .arg(result.referenced.size())
+					  .arg(result.reused.size())
+					  .arg(result.failed.size()));
+
+	return result;
 }
 
 void HolyricsFinder::updateBrowserSourceUrl(const QString &name, const QString &url)
 {
+	TRACE_SCOPE("HolyricsFinder::updateBrowserSourceUrl");
+
 	obs_source_t *source = obs_get_source_by_name(name.toUtf8().constData());
 	if (!source) {
-		obs_log(LOG_WARNING, "Source not found: %s", name.toUtf8().constData());
+		EventLog::warning("sources", QString("Source not found: %1").arg(name));
 		return;
 	}
 
@@ -317,54 +751,1013 @@ void HolyricsFinder::updateBrowserSourceUrl(const QString &name, const QString &
 	obs_data_set_string(settings, "url", url.toUtf8().constData());
 	obs_source_update(source, settings);
 	
-	obs_log(LOG_INFO, "Updated source: %s with URL: %s",
-		name.toUtf8().constData(),
-		url.toUtf8().constData());
+	EventLog::detail("sources", QString("Updated %1 with URL %2").arg(name, url));
 
 	obs_data_release(settings);
 	obs_source_release(source);
+
+	loadVerifier()->track(name, url);
+}
+
+LoadVerifier *HolyricsFinder::loadVerifier()
+{
+	if (!m_loadVerifier) {
+		m_loadVerifier = new LoadVerifier(this);
+	}
+	return m_loadVerifier;
+}
+
+int HolyricsFinder::rebindSources(const QList<ConnectionInfo> &from, const ConnectionInfo &to)
+{
+	TRACE_SCOPE("HolyricsFinder::rebindSources");
+
+	struct RebindContext {
+		QSet<QString> from;
+		QSet<QString> holyricsPaths;
+		QString proxyKey;
+		QList<QPair<QString, QString>> proxied;
+		QList<QPair<obs_source_t *, QString>> targets;
+	} context;
+
+	for (const ConnectionInfo &endpoint : from) {
+		context.from.insert(formatEndpoint(endpoint.ip, endpoint.port));
+	}
+
+	// Sources (and a proxy) on the bound hostname are on whichever of
+	// `from` it resolves to
+	QString hostname = boundHostname();
+	if (!hostname.isEmpty()) {
+		for (const ConnectionInfo &endpoint : from) {
+			if (hostnameResolvesTo(hostname, endpoint.ip)) {
+				context.from.insert(formatEndpoint(hostname, endpoint.port));
+			}
+		}
+	}
+
+	// Sources on the proxy follow it when it is retargeted. A source still
+	// pointing straight at the host that moved is brought onto the proxy.
+	bool viaProxy = false;
+	if (isProxyEnabled()) {
+		context.proxyKey = formatEndpoint(StageProxy::loopbackHost(), m_proxy->port());
+		viaProxy = from.isEmpty() || m_proxy->upstreamIp().isEmpty() ||
+			   context.from.contains(formatEndpoint(m_proxy->upstreamIp(), m_proxy->upstreamPort()));
+	}
+
+	for (const HolyricsSource &definition : getSourceDefinitions()) {
+		context.holyricsPaths.insert(definition.urlPath);
+	}
+
+	// Collect first, then update, so no source settings change while enumerating
+	obs_enum_sources([](void *param, obs_source_t *source) {
+		if (strcmp(obs_source_get_id(source), "browser_source") != 0) {
+			return true;
+		}
+
+		auto *context = static_cast<RebindContext *>(param);
+		obs_data_t *settings = obs_source_get_settings(source);
+		QString url = QString::fromUtf8(obs_data_get_string(settings, "url"));
+		obs_data_release(settings);
+
+		ConnectionInfo endpoint;
+		QString urlPath;
+		if (!parseEndpointUrl(url, endpoint, urlPath) || !context->holyricsPaths.contains(urlPath)) {
+			return true;
+		}
+		if (!context->proxyKey.isEmpty() && formatEndpoint(endpoint.ip, endpoint.port) == context->proxyKey) {
+			context->proxied.append(qMakePair(QString::fromUtf8(obs_source_get_name(source)), url));
+			return true;
+		}
+		if (!context->from.isEmpty() && !context->from.contains(formatEndpoint(endpoint.ip, endpoint.port))) {
+			return true;
+		}
+
+		context->targets.append(qMakePair(obs_source_get_ref(source), urlPath));
+		return true;
+	}, &context);
+
+	int rebound = 0;
+	ConnectionInfo bound = to;
+	if (viaProxy) {
+		bool moved = m_proxy->upstreamIp() != to.ip || m_proxy->upstreamPort() != to.port;
+		retargetProxy(to);
+		bound = {StageProxy::loopbackHost(), m_proxy->port()};
+		if (moved) {
+			// Same URL, but the pages behind it now come from somewhere else
+			rebound += int(context.proxied.size());
+			for (const auto &proxied : context.proxied) {
+				loadVerifier()->track(proxied.first, proxied.second);
+			}
+		}
+	}
+
+	for (const auto &target : context.targets) {
+		QString url = buildUrl(bound.ip, bound.port, target.second);
+		obs_data_t *settings = obs_source_get_settings(target.first);
+		if (url != QString::fromUtf8(obs_data_get_string(settings, "url"))) {
+			obs_data_set_string(settings, "url", url.toUtf8().constData());
+			obs_source_update(target.first, settings);
+			loadVerifier()->track(QString::fromUtf8(obs_source_get_name(target.first)), url);
+			rebound++;
+		}
+		obs_data_release(settings);
+		obs_source_release(target.first);
+	}
+
+	EventLog::info("sources",
+		       QString("Rebound %1 Holyrics source(s) to %2").arg(rebound).arg(formatEndpoint(to.ip, to.port)));
+	return rebound;
 }
 
 void HolyricsFinder::prepareForShutdown()
 {
-	obs_log(LOG_INFO, "[HolyricsFinder] Preparing for shutdown");
+	EventLog::detail("finder", "Preparing for shutdown");
 	m_isShuttingDown = true;
+	abortRanking();
+	
+	settleScanRequest({}, kCancelledError);
+	const QList<quint64> requests = m_cancellers.keys();
+	for (quint64 requestId : requests) {
+		cancelRequest(requestId);
+	}
+	
+	// Cancel without emitting scanComplete; nobody should react any more
+	m_scanGeneration++;
+	m_scanFoundConnection = false;
+	m_scanCandidates.clear();
+	stopScanners();
+	abortPendingRequests();
+	if (m_loadVerifier) {
+		m_loadVerifier->cancel();
+	}
+	if (m_proxy) {
+		m_proxy->stop();
+	}
+	
+	if (m_settings) {
+		m_settings->sync();
+	}
 }
 
-void HolyricsFinder::stopScanning()
+bool HolyricsFinder::isProxyEnabled() const
 {
-	if (m_scanningTotal > 0) {
-		obs_log(LOG_INFO, "Stopping network scan");
-		m_scanningCount = 0;
-		m_scanningTotal = 0;
-		m_scanFoundConnection = false;
-		abortPendingRequests();
-		emit scanComplete();
-	}
+	return m_proxy && m_proxy->isRunning();
 }
 
-void HolyricsFinder::abortPendingRequests()
+int HolyricsFinder::proxyPort() const
 {
-	for (QNetworkReply *reply : m_pendingReplies) {
-		if (reply && reply->isRunning()) {
-			reply->abort();
+	return settings()->value("proxy/port", kDefaultProxyPort).toInt();
+}
+
+bool HolyricsFinder::setProxyEnabled(bool enabled, const ConnectionInfo &upstream)
+{
+	TRACE_SCOPE("HolyricsFinder::setProxyEnabled");
+
+	if (enabled) {
+		if (!m_proxy) {
+			m_proxy = new StageProxy(this);
+		}
+		if (!m_proxy->start(quint16(proxyPort()))) {
+			return false;
 		}
+		settings()->setValue("proxy/enabled", true);
+		retargetProxy(upstream);
+		// Everything still pointing straight at Holyrics moves onto the proxy
+		rebindSources({}, upstream);
+		return true;
+	}
+
+	settings()->setValue("proxy/enabled", false);
+	settings()->sync();
+	if (!isProxyEnabled()) {
+		return true;
+	}
+
+	ConnectionInfo local{StageProxy::loopbackHost(), m_proxy->port()};
+	ConnectionInfo target{m_proxy->upstreamIp(), m_proxy->upstreamPort()};
+	m_proxy->stop();
+	if (!target.ip.isEmpty()) {
+		rebindSources({local}, target);
 	}
-	m_pendingReplies.clear();
+	return true;
 }
 
-void HolyricsFinder::logConnectionHistory() const
+void HolyricsFinder::restoreProxy()
 {
-	QList<ConnectionInfo> history = getConnectionHistory();
-	
-	if (history.isEmpty()) {
-		obs_log(LOG_INFO, "[HolyricsFinder] Connection history is empty");
+	if (!settings()->value("proxy/enabled", false).toBool()) {
 		return;
 	}
-	
-	obs_log(LOG_INFO, "[HolyricsFinder] Connection history (%d entries):", history.size());
-	for (int i = 0; i < history.size(); ++i) {
-		obs_log(LOG_INFO, "  [%d] %s:%d", i + 1,
-			history[i].ip.toUtf8().constData(), history[i].port);
+
+	// Runs once the collection has loaded; sources on the proxy found it
+	// closed and are reloaded below
+	if (!m_proxy) {
+		m_proxy = new StageProxy(this);
+	}
+	if (!m_proxy->start(quint16(proxyPort()))) {
+		return;
+	}
+
+	ConnectionInfo upstream;
+	if (!parseEndpoint(settings()->value("proxy/upstream").toString(), upstream)) {
+		QList<ConnectionInfo> history = getConnectionHistory();
+		if (history.isEmpty()) {
+			return;
+		}
+		upstream = history.first();
 	}
+	m_proxy->setUpstream(upstream.ip, upstream.port);
+	EventLog::info("proxy", QString("Proxy on port %1 forwarding to %2")
+					.arg(m_proxy->port())
+					.arg(formatEndpoint(upstream.ip, upstream.port)));
+
+	struct ProxiedSources {
+		QString proxyKey;
+		QList<QPair<QString, QString>> sources;
+	} proxied;
+	proxied.proxyKey = formatEndpoint(StageProxy::loopbackHost(), m_proxy->port());
+
+	obs_enum_sources([](void *param, obs_source_t *source) {
+		if (strcmp(obs_source_get_id(source), "browser_source") != 0) {
+			return true;
+		}
+
+		auto *proxied = static_cast<ProxiedSources *>(param);
+		obs_data_t *settings = obs_source_get_settings(source);
+		QString url = QString::fromUtf8(obs_data_get_string(settings, "url"));
+		obs_data_release(settings);
+
+		ConnectionInfo endpoint;
+		QString urlPath;
+		if (parseEndpointUrl(url, endpoint, urlPath) &&
+		    formatEndpoint(endpoint.ip, endpoint.port) == proxied->proxyKey) {
+			proxied->sources.append(qMakePair(QString::fromUtf8(obs_source_get_name(source)), url));
+		}
+		return true;
+	}, &proxied);
+
+	for (const auto &source : proxied.sources) {
+		loadVerifier()->track(source.first, source.second);
+	}
+}
+
+void HolyricsFinder::retargetProxy(const ConnectionInfo &upstream)
+{
+	m_proxy->setUpstream(upstream.ip, upstream.port);
+	settings()->setValue("proxy/upstream", formatEndpoint(upstream.ip, upstream.port));
+	settings()->sync();
+}
+
+HolyricsFinder::ConnectionInfo HolyricsFinder::sourceEndpointFor(const ConnectionInfo &upstream)
+{
+	ConnectionInfo target = upstream;
+	QString hostname = boundHostname();
+	if (!hostname.isEmpty() && hostnameResolvesTo(hostname, upstream.ip)) {
+		target = {hostname, upstream.port};
+	}
+
+	if (!isProxyEnabled()) {
+		return target;
+	}
+
+	retargetProxy(target);
+	return {StageProxy::loopbackHost(), m_proxy->port()};
+}
+
+HolyricsFinder::ConnectionInfo HolyricsFinder::resolveEndpoint(const ConnectionInfo &endpoint) const
+{
+	if (isProxyEnabled() && !m_proxy->upstreamIp().isEmpty() && endpoint.ip == StageProxy::loopbackHost() &&
+	    endpoint.port == m_proxy->port()) {
+		return {m_proxy->upstreamIp(), m_proxy->upstreamPort()};
+	}
+	return endpoint;
+}
+
+bool HolyricsFinder::pointsAt(const ConnectionInfo &sourceEndpoint, const ConnectionInfo &endpoint) const
+{
+	ConnectionInfo upstream = resolveEndpoint(sourceEndpoint);
+	if (upstream.port != endpoint.port) {
+		return false;
+	}
+	if (formatEndpoint(upstream.ip, upstream.port) == formatEndpoint(endpoint.ip, endpoint.port)) {
+		return true;
+	}
+
+	QString hostname = boundHostname();
+	if (hostname.isEmpty()) {
+		return false;
+	}
+	return (upstream.ip == hostname && hostnameResolvesTo(hostname, endpoint.ip)) ||
+	       (endpoint.ip == hostname && hostnameResolvesTo(hostname, upstream.ip));
+}
+
+HostResolver *HolyricsFinder::resolver()
+{
+	if (!m_resolver) {
+		m_resolver = new HostResolver(this);
+		connect(m_resolver, &HostResolver::resolved, this, &HolyricsFinder::onHostResolved);
+		connect(m_resolver, &HostResolver::failed, this, &HolyricsFinder::onHostFailed);
+	}
+	return m_resolver;
+}
+
+QString HolyricsFinder::boundHostname() const
+{
+	return settings()->value("host/name").toString();
+}
+
+bool HolyricsFinder::hostnameResolvesTo(const QString &hostname, const QString &ip) const
+{
+	if (ip == hostname) {
+		return true;
+	}
+	if (!m_resolver) {
+		return false;
+	}
+
+	QHostAddress address(ip);
+	for (const QHostAddress &resolved : m_resolver->addresses(hostname)) {
+		if (resolved.isEqual(address, QHostAddress::ConvertV4MappedToIPv4)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool HolyricsFinder::bindHostname(const QString &hostname, const ConnectionInfo &current)
+{
+	TRACE_SCOPE("HolyricsFinder::bindHostname");
+
+	QString name = hostname.trimmed().toLower();
+	QString previous = boundHostname();
+
+	if (name.isEmpty()) {
+		m_pendingHostBind.clear();
+		if (previous.isEmpty()) {
+			return true;
+		}
+
+		settings()->remove("host/name");
+		settings()->sync();
+		resolver()->unwatch(previous);
+
+		// Back to the literal address the name last resolved to
+		ConnectionInfo literal = current;
+		if (HostResolver::isHostname(literal.ip)) {
+			QList<QHostAddress> addresses = resolver()->addresses(previous);
+			literal.ip = addresses.isEmpty() ? QString() : addresses.first().toString();
+		}
+		int rebound = literal.ip.isEmpty() ? 0 : rebindSources({{previous, current.port}}, literal);
+		emit hostnameBound(QString(), true, rebound);
+		return true;
+	}
+
+	if (!HostResolver::isHostname(name)) {
+		return false;
+	}
+
+	m_pendingHostBind = name;
+	m_pendingHostFrom = current;
+	resolver()->resolve(name);
+	return true;
+}
+
+void HolyricsFinder::restoreHostBinding()
+{
+	QString hostname = boundHostname();
+	if (!hostname.isEmpty()) {
+		resolver()->watch(hostname);
+	}
+}
+
+void HolyricsFinder::onHostResolved(const QString &hostname, const QList<QHostAddress> &addresses)
+{
+	if (hostname != m_pendingHostBind) {
+		return;
+	}
+	m_pendingHostBind.clear();
+
+	// Only bind a name that really is this Holyrics, not a typo that
+	// happens to resolve to something else
+	if (!hostnameResolvesTo(hostname, m_pendingHostFrom.ip)) {
+		EventLog::warning("sources", QString("%1 resolves to %2, not %3; not binding")
+						     .arg(hostname, addresses.isEmpty() ? QString("nothing")
+											 : addresses.first().toString(),
+							  m_pendingHostFrom.ip));
+		emit hostnameBound(hostname, false, 0);
+		return;
+	}
+
+	QString previous = boundHostname();
+	QList<ConnectionInfo> from{m_pendingHostFrom};
+	if (!previous.isEmpty() && previous != hostname) {
+		resolver()->unwatch(previous);
+		from.append({previous, m_pendingHostFrom.port});
+	}
+
+	settings()->setValue("host/name", hostname);
+	settings()->sync();
+	resolver()->watch(hostname);
+
+	int rebound = rebindSources(from, {hostname, m_pendingHostFrom.port});
+	EventLog::info("sources", QString("Sources bound to hostname %1").arg(hostname));
+	emit hostnameBound(hostname, true, rebound);
+}
+
+void HolyricsFinder::onHostFailed(const QString &hostname, const QString &error)
+{
+	Q_UNUSED(error);
+	if (hostname != m_pendingHostBind) {
+		return;
+	}
+	m_pendingHostBind.clear();
+	emit hostnameBound(hostname, false, 0);
+}
+
+void HolyricsFinder::stopScanning()
+{
+	if (!m_scanners.isEmpty()) {
+		EventLog::info("scan", "Stopping network scan");
+		m_scanFoundConnection = false;
+		m_scanCandidates.clear();
+		m_scanGeneration++;
+		stopScanners();
+		settleScanRequest({}, kCancelledError);
+		emit scanComplete();
+	}
+}
+
+void HolyricsFinder::abortPendingRequests()
+{
+	// Cancelling re-enters onNetworkReply, which edits m_connectionTests
+	const QList<quint64> tests = m_connectionTests;
+	m_connectionTests.clear();
+	
+	for (quint64 requestId : tests) {
+		cancelRequest(requestId);
+	}
+}
+
+void HolyricsFinder::logConnectionHistory() const
+{
+	QList<ConnectionInfo> history = getConnectionHistory();
+	
+	if (history.isEmpty()) {
+		EventLog::info("history", "Connection history is empty");
+		return;
+	}
+	
+	EventLog::info("history", QString("%1 connection(s) in history, last %2")
+					  .arg(history.size())
+					  .arg(formatEndpoint(history[0].ip, history[0].port)));
+	for (int i = 0; i < history.size(); ++i) {
+		EventLog::detail("history",
+				 QString("[%1] %2").arg(i + 1).arg(formatEndpoint(history[i].ip, history[i].port)));
+	}
+}
+
+QString HolyricsFinder::endpointKey(const QString &ip, int port)
+{
+	return formatEndpoint(ip, port);
+}
+
+QString HolyricsFinder::formatHost(const QString &ip)
+{
+	return ip.contains(':') ? QString("[%1]").arg(ip) : ip;
+}
+
+QString HolyricsFinder::formatEndpoint(const QString &ip, int port)
+{
+	return QString("%1:%2").arg(formatHost(ip)).arg(port);
+}
+
+QString HolyricsFinder::buildUrl(const QString &ip, int port, const QString &path)
+{
+	// RFC 6874: the '%' of a zone id must itself be percent-encoded in a URL
+	QString host = formatHost(ip);
+	host.replace("%", "%25");
+	return QString("http://%1:%2%3").arg(host).arg(port).arg(path);
+}
+
+// Host names as in RFC 1123; at least one letter keeps "1.2.3" out
+static const char *kHostnamePattern = "[A-Za-z0-9](?:[A-Za-z0-9-]{0,61}[A-Za-z0-9])?"
+				      "(?:\\.[A-Za-z0-9](?:[A-Za-z0-9-]{0,61}[A-Za-z0-9])?)*";
+
+bool HolyricsFinder::parseEndpoint(const QString &text, ConnectionInfo &endpoint)
+{
+	static const QRegularExpression endpointRegex(
+		QString("^(?:\\[([0-9A-Fa-f:.]+(?:%[^\\]]+)?)\\]|([0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3})|(") +
+		kHostnamePattern + ")):([0-9]{1,5})$");
+	
+	QRegularExpressionMatch match = endpointRegex.match(text);
+	if (!match.hasMatch()) {
+		return false;
+	}
+	
+	if (!match.captured(3).isEmpty()) {
+		static const QRegularExpression letter("[A-Za-z]");
+		if (!match.captured(3).contains(letter)) {
+			return false;
+		}
+		endpoint.ip = match.captured(3).toLower();
+	} else if (match.captured(1).isEmpty()) {
+		endpoint.ip = match.captured(2);
+	} else {
+		// Normalise so "FE80::0001" and "fe80::1" compare equal
+		QHostAddress address(match.captured(1));
+		endpoint.ip = address.isNull() ? match.captured(1) : address.toString();
+	}
+	endpoint.port = match.captured(4).toInt();
+	return true;
+}
+
+bool HolyricsFinder::parseEndpointUrl(const QString &url, ConnectionInfo &endpoint, QString &urlPath)
+{
+	static const QRegularExpression urlRegex(
+		QString("^https?://(\\[[0-9A-Fa-f:.]+(?:%25[^\\]]+)?\\]|[0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}\\.[0-9]{1,3}|") +
+		kHostnamePattern + "):([0-9]{1,5})(.*)$");
+	
+	QRegularExpressionMatch match = urlRegex.match(url);
+	if (!match.hasMatch()) {
+		return false;
+	}
+	
+	QString host = match.captured(1);
+	host.replace("%25", "%");
+	
+	if (!parseEndpoint(QString("%1:%2").arg(host, match.captured(2)), endpoint)) {
+		return false;
+	}
+	
+	urlPath = match.captured(3);
+	return true;
+}
+
+void HolyricsFinder::recordRtt(const QString &ip, int port, double rttMs)
+{
+	QList<double> &samples = m_rttSamples[endpointKey(ip, port)];
+	samples.append(rttMs);
+	
+	while (samples.size() > kMaxRttSamples) {
+		samples.removeFirst();
+	}
+}
+
+void HolyricsFinder::rankEndpoints(const QList<ConnectionInfo> &candidates, int probesPerEndpoint)
+{
+	abortRanking();
+	
+	m_rankCandidates = candidates;
+	m_rankOutstanding = candidates.size() * probesPerEndpoint;
+	
+	for (const ConnectionInfo &endpoint : candidates) {
+		m_rttFailures.remove(endpointKey(endpoint.ip, endpoint.port));
+	}
+	
+	if (m_rankOutstanding <= 0) {
+		finishRanking();
+		return;
+	}
+	
+	EventLog::detail("ranking", QString("Ranking %1 Holyrics endpoint(s) with %2 probe(s) each")
+					    .arg(candidates.size())
+					    .arg(probesPerEndpoint));
+	
+	// Spread each burst out a little so the probes measure the path, not the queue
+	int generation = m_rankGeneration;
+	for (int i = 0; i < probesPerEndpoint; ++i) {
+		for (const ConnectionInfo &endpoint : candidates) {
+			QTimer::singleShot(i * kRankProbeSpacingMs, this, [this, endpoint, generation]() {
+				if (generation == m_rankGeneration && !m_isShuttingDown) {
+					sendRankProbe(endpoint);
+				}
+			});
+		}
+	}
+}
+
+void HolyricsFinder::sendRankProbe(const ConnectionInfo &endpoint)
+{
+	QNetworkRequest request(QUrl(buildUrl(endpoint.ip, endpoint.port, "/")));
+	request.setAttribute(QNetworkRequest::Attribute::User, QVariant(endpoint.ip));
+	request.setAttribute(kProbeKindAttribute, ProbeRank);
+	request.setAttribute(kProbeStartAttribute, m_clock.nsecsElapsed());
+	request.setAttribute(kProbeGenerationAttribute, m_rankGeneration);
+	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+	request.setTransferTimeout(kRankProbeTimeoutMs);
+	
+	m_rankReplies.append(network()->get(request));
+}
+
+void HolyricsFinder::abortRanking()
+{
+	m_rankGeneration++;
+	m_rankOutstanding = 0;
+	
+	const QList<QNetworkReply*> replies = m_rankReplies;
+	m_rankReplies.clear();
+	
+	for (QNetworkReply *reply : replies) {
+		if (reply && reply->isRunning()) {
+			reply->abort();
+		}
+	}
+}
+
+void HolyricsFinder::finishRanking()
+{
+	m_ranking.clear();
+	
+	for (const ConnectionInfo &endpoint : m_rankCandidates) {
+		QString key = endpointKey(endpoint.ip, endpoint.port);
+		QList<double> samples = m_rttSamples.value(key);
+		
+		EndpointStats stats;
+		stats.ip = endpoint.ip;
+		stats.port = endpoint.port;
+		stats.medianRttMs = -1.0;
+		stats.jitterMs = 0.0;
+		stats.samples = samples.size();
+		stats.failures = m_rttFailures.value(key);
+		
+		if (!samples.isEmpty()) {
+			std::sort(samples.begin(), samples.end());
+			int n = samples.size();
+			stats.medianRttMs = (n % 2) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2.0;
+			
+			double deviation = 0.0;
+			for (double sample : samples) {
+				deviation += qAbs(sample - stats.medianRttMs);
+			}
+			stats.jitterMs = deviation / n;
+		}
+		
+		m_ranking.append(stats);
+	}
+	
+	// Lost probes count as a full timeout so a flaky link can't win on a lucky median
+	auto score = [](const EndpointStats &stats) {
+		double lossRatio = double(stats.failures) / (stats.samples + stats.failures);
+		return stats.medianRttMs + 2.0 * stats.jitterMs + lossRatio * kRankProbeTimeoutMs;
+	};
+	
+	std::stable_sort(m_ranking.begin(), m_ranking.end(),
+		[&score](const EndpointStats &a, const EndpointStats &b) {
+			if ((a.samples > 0) != (b.samples > 0)) {
+				return a.samples > 0;
+			}
+			return a.samples > 0 && score(a) < score(b);
+		});
+	
+	for (int i = 0; i < m_ranking.size(); ++i) {
+		const EndpointStats &stats = m_ranking[i];
+		EventLog::detail("ranking", QString("[%1] %2 median %3 ms, jitter %4 ms, %5/%6 probes answered")
+						    .arg(i + 1)
+						    .arg(formatEndpoint(stats.ip, stats.port))
+						    .arg(stats.medianRttMs, 0, 'f', 1)
+						    .arg(stats.jitterMs, 0, 'f', 1)
+						    .arg(stats.samples)
+						    .arg(stats.samples + stats.failures));
+	}
+	if (!m_ranking.isEmpty()) {
+		EventLog::info("ranking", QString("Fastest of %1 endpoint(s): %2")
+						  .arg(m_ranking.size())
+						  .arg(formatEndpoint(m_ranking[0].ip, m_ranking[0].port)));
+	}
+	
+	emit endpointsRanked();
+}
+
+QList<HolyricsFinder::EndpointStats> HolyricsFinder::getEndpointRanking() const
+{
+	return m_ranking;
+}
+
+HolyricsFinder::ConnectionInfo HolyricsFinder::preferredEndpoint(const QString &ip, int port) const
+{
+	ConnectionInfo requested{ip, port};
+	
+	if (!isAutoSelectFastest() || m_ranking.isEmpty() || m_ranking.first().samples == 0) {
+		return requested;
+	}
+	
+	// Only swap hosts that took part in the ranking; a manually typed IP is left alone
+	for (const EndpointStats &stats : m_ranking) {
+		if (stats.ip == ip && stats.port == port) {
+			return {m_ranking.first().ip, m_ranking.first().port};
+		}
+	}
+	
+	return requested;
+}
+
+bool HolyricsFinder::isAutoSelectFastest() const
+{
+	return settings()->value("autoSelectFastest", false).toBool();
+}
+
+void HolyricsFinder::setAutoSelectFastest(bool enabled)
+{
+	settings()->setValue("autoSelectFastest", enabled);
+	settings()->sync();
+}
+
+void HolyricsFinder::scanAllInterfaces(int port)
+{
+	resetScan(port);
+	
+	int maxInFlight = settings()->value("interfaceConcurrency", kDefaultInterfaceConcurrency).toInt();
+	QList<ConnectionInfo> history = getConnectionHistory();
+	bool wideSubnets = settings()->value("scan/wideSubnets", false).toBool();
+	int widestPrefix = wideSubnets ? kWidestSweepPrefix : kNarrowSweepPrefix;
+	
+	for (const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
+		QNetworkInterface::InterfaceFlags flags = iface.flags();
+		if (!(flags & QNetworkInterface::IsUp) || !(flags & QNetworkInterface::IsRunning) ||
+		    (flags & QNetworkInterface::IsLoopBack)) {
+			continue;
+		}
+		
+		for (const QNetworkAddressEntry &entry : iface.addressEntries()) {
+			QHostAddress local = entry.ip();
+			if (local.protocol() != QAbstractSocket::IPv4Protocol || local.isLinkLocal()) {
+				continue;
+			}
+			
+			int prefix = qBound(widestPrefix, entry.prefixLength(), 30);
+			quint32 mask = 0xFFFFFFFFu << (32 - prefix);
+			quint32 network = local.toIPv4Address() & mask;
+			quint32 broadcast = network | ~mask;
+			
+			ScanTargets targets(quint16(port));
+			targets.setRange(network + 1, broadcast - 1);
+			for (const ConnectionInfo &conn : history) {
+				QHostAddress address(conn.ip);
+				if (conn.port == port && address.protocol() == QAbstractSocket::IPv4Protocol &&
+				    (address.toIPv4Address() & mask) == network) {
+					targets.addHost(address);
+				}
+			}
+			int historyCount = targets.listedCount();
+			// Holyrics on this machine is only found through history
+			targets.exclude(local);
+			
+			// On a wide network the local /24 goes first; Holyrics is
+			// usually on the same switch
+			bool wide = prefix < kNarrowSweepPrefix;
+			if (wide) {
+				quint32 nearby = local.toIPv4Address() & 0xFFFFFF00u;
+				for (quint32 host = nearby + 1; host < nearby + 255; ++host) {
+					if (host != local.toIPv4Address()) {
+						targets.addHost(QHostAddress(host));
+					}
+				}
+			}
+			
+			QString networkKey = QString("%1/%2").arg(QHostAddress(network).toString()).arg(prefix);
+			SubnetScanner *scanner = addScanner(iface.humanReadableName(), local, networkKey, targets,
+							    maxInFlight);
+			scanner->setPatientTargets(historyCount);
+			connect(scanner, &SubnetScanner::progress, this, &HolyricsFinder::interfaceScanProgress);
+			if (wide) {
+				m_wideScanners.insert(scanner);
+			}
+		}
+	}
+	
+	if (m_scanners.isEmpty()) {
+		obs_log(LOG_WARNING, "No IPv4 interfaces available for scanning");
+		settleScanRequest({}, "no IPv4 interface to scan");
+		emit scanComplete();
+		return;
+	}
+	
+	EventLog::info("scan", QString("Scanning %1 interface subnet(s) in parallel").arg(m_scanners.size()));
+	startScanners();
+}
+
+void HolyricsFinder::resetScan(int port)
+{
+	abortPendingRequests();
+	stopScanners();
+	
+	m_currentPort = port;
+	m_scanFoundConnection = false;
+	m_scanFirstHit.clear();
+	m_scanCandidates.clear();
+	m_scanHitInterfaces.clear();
+	m_scanGeneration++;
+	
+	// A scan() request binds to the first scan it starts; any later one
+	// replaces it
+	if (m_scanPromise && m_scanRequestBound) {
+		settleScanRequest({}, kSupersededError);
+	}
+	m_scanRequestBound = m_scanPromise != nullptr;
+}
+
+SubnetScanner *HolyricsFinder::addScanner(const QString &name, const QHostAddress &localAddress,
+					  const QString &networkKey, const ScanTargets &targets,
+					  int maxInFlight)
+{
+	SubnetScanner *scanner = new SubnetScanner(name, localAddress, targets, m_currentPort, maxInFlight, this);
+	
+	// Start from what this network looked like last time instead of the 2 s ceiling
+	QStringList baseline = settings()->value(baselineSettingsKey(networkKey)).toStringList();
+	if (baseline.size() == 2) {
+		scanner->seedRtt(baseline[0].toDouble(), baseline[1].toDouble());
+	}
+	
+	connect(scanner, &SubnetScanner::progress, this, &HolyricsFinder::onScannerProgress);
+	connect(scanner, &SubnetScanner::found, this, &HolyricsFinder::onScannerFound);
+	connect(scanner, &SubnetScanner::finished, this, &HolyricsFinder::onScannerFinished);
+	
+	m_scanners.append(scanner);
+	m_scannerNetworks.insert(scanner, networkKey);
+	return scanner;
+}
+
+void HolyricsFinder::startScanners()
+{
+	if (!m_pacingTimer) {
+		m_pacingTimer = new QTimer(this);
+		m_pacingTimer->setInterval(kPacingCheckMs);
+		connect(m_pacingTimer, &QTimer::timeout, this, &HolyricsFinder::applyScanPacing);
+	}
+	m_scanPaced = false;
+	applyScanPacing();
+	m_pacingTimer->start();
+	
+	// Copy: a scanner with nothing to do finishes synchronously inside start()
+	const QList<SubnetScanner*> scanners = m_scanners;
+	for (SubnetScanner *scanner : scanners) {
+		scanner->start();
+	}
+}
+
+void HolyricsFinder::applyScanPacing()
+{
+	if (m_scanners.isEmpty()) {
+		return;
+	}
+	
+	ScanPacing::Budget budget = ScanPacing::current();
+	
+	if (budget.paced) {
+		// Parallel interface sweeps share one budget
+		int count = m_scanners.size();
+		const QList<SubnetScanner*> scanners = m_scanners;
+		for (SubnetScanner *scanner : scanners) {
+			scanner->setPacing(budget.packetsPerSecond / count, budget.bytesPerSecond / count,
+					   budget.maxResponseBytes);
+		}
+		
+		if (!m_scanPaced) {
+			EventLog::info("scan", QString("Output is live (%1); pacing scan to %2 packets/s and %3 KB/s")
+						       .arg(budget.reason)
+						       .arg(budget.packetsPerSecond, 0, 'f', 0)
+						       .arg(budget.bytesPerSecond / 1024.0, 0, 'f', 0));
+		}
+		m_scanPaced = true;
+	} else {
+		// Wide sweeps stay paced, sharing their own budget; the rest run free
+		ScanPacing::Budget wide = ScanPacing::wideSweep();
+		int wideCount = m_wideScanners.size();
+		bool lifted = m_scanPaced;
+		m_scanPaced = false;
+		const QList<SubnetScanner*> scanners = m_scanners;
+		for (SubnetScanner *scanner : scanners) {
+			if (m_wideScanners.contains(scanner)) {
+				scanner->setPacing(wide.packetsPerSecond / wideCount, wide.bytesPerSecond / wideCount,
+						   wide.maxResponseBytes);
+			} else if (lifted) {
+				scanner->setPacing(0.0, 0.0, 0);
+			}
+		}
+		if (lifted) {
+			EventLog::info("scan", "Output no longer live; scan pacing lifted");
+		}
+	}
+}
+
+QString HolyricsFinder::baselineSettingsKey(const QString &networkKey)
+{
+	// '/' is QSettings' group separator
+	QString key = networkKey;
+	key.replace('/', '_');
+	return QString("rttBaseline/%1").arg(key);
+}
+
+void HolyricsFinder::saveRttBaselines()
+{
+	TRACE_SCOPE("HolyricsFinder::saveRttBaselines");
+
+	for (SubnetScanner *scanner : m_scanners) {
+		const RttEstimator &rtt = scanner->rtt();
+		if (rtt.sampleCount() < kMinBaselineSamples) {
+			continue;
+		}
+		
+		QStringList baseline = {QString::number(rtt.smoothedRttMs()), QString::number(rtt.rttVarianceMs())};
+		settings()->setValue(baselineSettingsKey(m_scannerNetworks.value(scanner)), baseline);
+	}
+	settings()->sync();
+}
+
+void HolyricsFinder::stopScanners()
+{
+	if (m_pacingTimer) {
+		m_pacingTimer->stop();
+	}
+	
+	const QList<SubnetScanner*> scanners = m_scanners;
+	m_scanners.clear();
+	m_scannerNetworks.clear();
+	m_wideScanners.clear();
+	
+	for (SubnetScanner *scanner : scanners) {
+		scanner->disconnect(this);
+		scanner->stop();
+		scanner->deleteLater();
+	}
+}
+
+void HolyricsFinder::onScannerFound(const QString &interfaceName, const QString &ip, int port, double rttMs)
+{
+	EventLog::info("scan",
+		       QString("Holyrics found at %1 via %2 (%3 ms)").arg(ip, interfaceName).arg(rttMs, 0, 'f', 1));
+	
+	recordRtt(ip, port, rttMs);
+	
+	bool known = false;
+	for (const ConnectionInfo &candidate : m_scanCandidates) {
+		known = known || (candidate.ip == ip && candidate.port == port);
+	}
+	if (!known) {
+		m_scanCandidates.append({ip, port});
+	}
+	
+	SubnetScanner *scanner = qobject_cast<SubnetScanner*>(sender());
+	if (scanner && !scanner->localAddress().isNull()) {
+		m_scanHitInterfaces.insert(ip, interfaceName);
+	}
+	
+	if (!m_scanFoundConnection) {
+		m_scanFoundConnection = true;
+		m_scanFirstHit = ip;
+		int generation = m_scanGeneration;
+		QTimer::singleShot(kScanCollectWindowMs, this, [this, generation]() { finishScan(generation); });
+	}
+}
+
+void HolyricsFinder::onScannerProgress()
+{
+	int current = 0;
+	int total = 0;
+	for (SubnetScanner *scanner : m_scanners) {
+		current += scanner->completed();
+		total += scanner->total();
+	}
+	emit scanProgress(current, total);
+}
+
+void HolyricsFinder::onScannerFinished()
+{
+	for (SubnetScanner *scanner : m_scanners) {
+		if (!scanner->isFinished()) {
+			return;
+		}
+	}
+	
+	if (m_scanFoundConnection) {
+		finishScan(m_scanGeneration);
+		return;
+	}
+	
+	EventLog::info("scan", "Network scan complete, no Holyrics found");
+	saveRttBaselines();
+	stopScanners();
+	settleScanRequest({}, QString());
+	emit scanComplete();
+}
+
+QString HolyricsFinder::getWinningInterface() const
+{
+	return settings()->value("winningInterface").toString();
+}
+
+QHostAddress HolyricsFinder::getWinningInterfaceAddress() const
+{
+	QString name = getWinningInterface();
+	
+	for (const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
+		if (iface.humanReadableName() != name) {
+			continue;
+		}
+		for (const QNetworkAddressEntry &entry : iface.addressEntries()) {
+			if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol) {
+				return entry.ip();
+			}
+		}
+	}
+	
+	return QHostAddress();
 }
@@ -15,8 +15,23 @@ the Free Software Foundation; either version 2 of the License, or
 #include <QStringList>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QSet>
 #include <QSettings>
 #include <QList>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QHostAddress>
+#include <QFuture>
+#include <QPromise>
+#include <functional>
+#include <memory>
+
+class HostResolver;
+class LoadVerifier;
+class ScanTargets;
+class SubnetScanner;
+class StageProxy;
 
 class HolyricsFinder : public QObject {
 	Q_OBJECT
@@ -35,41 +50,213 @@ public:
 		int port;
 	};
 
+	struct ProvisionResult {
+		QStringList created;
+		QStringList referenced;
+		QStringList reused;
+		QStringList failed;
+	};
+
+	// Outcome of one probe. `error` is empty on success, "cancelled" when the
+	// request was cancelled, otherwise a short description of the failure
+	struct ProbeResult {
+		quint64 requestId = 0;
+		ConnectionInfo endpoint{QString(), 0};
+		bool ok = false;
+		double rttMs = 0.0;
+		// Page title of the answering host; empty for scan hits
+		QString fingerprint;
+		QString error;
+	};
+
+	// `found` is in the order hosts answered. A scan that found nothing
+	// still succeeds; `error` is set only if it didn't run to completion
+	// ("cancelled", "superseded" by another scan, or a bad address).
+	struct ScanResult {
+		quint64 requestId = 0;
+		QList<ProbeResult> found;
+		QString error;
+	};
+
+	struct VerifyResult {
+		quint64 requestId = 0;
+		QList<ProbeResult> reachable;
+		QList<ProbeResult> unreachable;
+		QString error;
+	};
+
+	// Handle for an asynchronous request; cancel it with cancelRequest(id)
+	// or by cancelling the future. Futures always settle with a result,
+	// on the GUI thread, unless they were cancelled from the caller's side.
+	template<typename Result> struct Request {
+		quint64 id;
+		QFuture<Result> future;
+	};
+
+	struct EndpointStats {
+		QString ip;
+		int port;
+		double medianRttMs;
+		double jitterMs;
+		int samples;
+		int failures;
+	};
+
 	QStringList getIpHistory() const;
 	QList<ConnectionInfo> getConnectionHistory() const;
 	void addIpToHistory(const QString &ip);
 	void addConnectionToHistory(const QString &ip, int port);
 	void scanNetwork(const QString &baseIp, int port);
 	void testConnection(const QString &ip, int port);
-	void createHolyricsSources(const QString &ip, int port);
+	Request<ProbeResult> probe(const ConnectionInfo &endpoint, int timeoutMs = 2000);
+	// Probes every endpoint at once; results are in the order they came in
+	Request<VerifyResult> verify(const QList<ConnectionInfo> &endpoints, int timeoutMs = 2000);
+	// scanNetwork, or scanAllInterfaces if `baseIp` is empty. One scan runs
+	// at a time: starting any other scan supersedes this one.
+	Request<ScanResult> scan(const QString &baseIp, int port);
+	bool cancelRequest(quint64 requestId);
+	ProvisionResult createHolyricsSources(const QString &ip, int port, const QString &groupName = QString());
 	void updateBrowserSourceUrl(const QString &name, const QString &url);
+	// Points every Holyrics browser source on one of `from` (all of them if
+	// empty) at `to` in a single pass; returns how many sources changed
+	int rebindSources(const QList<ConnectionInfo> &from, const ConnectionInfo &to);
+	// Checks that sources changed by the two calls above really loaded
+	LoadVerifier *loadVerifier();
 	void stopScanning();
+	bool isScanning() const { return !m_scanners.isEmpty(); }
+	void scanAllInterfaces(int port);
+	QString getWinningInterface() const;
+	QHostAddress getWinningInterfaceAddress() const;
 	void logConnectionHistory() const;
+
+	void rankEndpoints(const QList<ConnectionInfo> &candidates, int probesPerEndpoint = 5);
+	QList<EndpointStats> getEndpointRanking() const;
+	ConnectionInfo preferredEndpoint(const QString &ip, int port) const;
+	bool isAutoSelectFastest() const;
+	void setAutoSelectFastest(bool enabled);
 	
 	void prepareForShutdown();
 
+	// Optional loopback proxy between the sources and Holyrics (StageProxy)
+	bool isProxyEnabled() const;
+	bool setProxyEnabled(bool enabled, const ConnectionInfo &upstream);
+	void restoreProxy();
+	int proxyPort() const;
+	// What a source should point at to reach `upstream`: the proxy, retargeted,
+	// while it runs, otherwise `upstream` itself
+	ConnectionInfo sourceEndpointFor(const ConnectionInfo &upstream);
+	// The Holyrics endpoint behind an endpoint a source points at
+	ConnectionInfo resolveEndpoint(const ConnectionInfo &endpoint) const;
+	// Whether a source pointing at `sourceEndpoint` reaches Holyrics at
+	// `endpoint`: directly, through the proxy or through the bound hostname
+	bool pointsAt(const ConnectionInfo &sourceEndpoint, const ConnectionInfo &endpoint) const;
+
+	// Optional hostname sources use instead of Holyrics' address, so a
+	// DHCP change needs neither a scan nor a rewrite. Binding is confirmed
+	// asynchronously (hostnameBound): `hostname` must resolve to `current`.
+	// An empty hostname goes back to the literal address.
+	QString boundHostname() const;
+	bool bindHostname(const QString &hostname, const ConnectionInfo &current);
+	void restoreHostBinding();
+	HostResolver *resolver();
+
 	static QList<HolyricsSource> getSourceDefinitions();
 
+	// Endpoint helpers; IPv6 literals are bracketed ("[fe80::1%eth0]:80")
+	static QString formatHost(const QString &ip);
+	static QString formatEndpoint(const QString &ip, int port);
+	static QString buildUrl(const QString &ip, int port, const QString &path);
+	static bool parseEndpoint(const QString &text, ConnectionInfo &endpoint);
+	static bool parseEndpointUrl(const QString &url, ConnectionInfo &endpoint, QString &urlPath);
+	static bool isHolyricsResponse(const QByteArray &response);
+
 signals:
 	void connectionSuccess(const QString &ip);
 	void connectionFailed(const QString &ip);
 	void scanProgress(int current, int total);
 	void scanComplete();
+	void endpointsRanked();
+	void hostnameBound(const QString &hostname, bool ok, int rebound);
+	void interfaceScanProgress(const QString &interfaceName, int current, int total);
 
 private slots:
 	void onNetworkReply(QNetworkReply *reply);
 
 private:
+	struct PendingProbe {
+		ConnectionInfo endpoint{QString(), 0};
+		QNetworkReply *reply = nullptr;
+		bool cancelled = false;
+		std::function<void(const ProbeResult &)> done;
+	};
+
 	QNetworkAccessManager *m_networkManager;
-	QSettings *m_settings;
-	int m_scanningCount;
-	int m_scanningTotal;
+	mutable QSettings *m_settings;
 	int m_currentPort;
 	bool m_isShuttingDown;
-	QList<QNetworkReply*> m_pendingReplies;
+	quint64 m_nextRequestId;
+	QHash<quint64, PendingProbe> m_probes;
+	QHash<quint64, std::function<void()>> m_cancellers;
+	QList<quint64> m_connectionTests;
+	std::shared_ptr<QPromise<ScanResult>> m_scanPromise;
+	quint64 m_scanRequestId;
+	bool m_scanRequestBound;
 	bool m_scanFoundConnection;
+	QString m_scanFirstHit;
+	QList<ConnectionInfo> m_scanCandidates;
+	int m_scanGeneration;
+	QList<SubnetScanner*> m_scanners;
+	QHash<SubnetScanner*, QString> m_scannerNetworks;
+	// Sweeping a network wider than a /24; always paced
+	QSet<SubnetScanner*> m_wideScanners;
+	QHash<QString, QString> m_scanHitInterfaces;
+	QTimer *m_pacingTimer;
+	bool m_scanPaced;
+	StageProxy *m_proxy;
+	HostResolver *m_resolver;
+	LoadVerifier *m_loadVerifier;
+	QString m_pendingHostBind;
+	ConnectionInfo m_pendingHostFrom{QString(), 0};
+
+	QElapsedTimer m_clock;
+	QHash<QString, QList<double>> m_rttSamples;
+	QHash<QString, int> m_rttFailures;
+	QList<QNetworkReply*> m_rankReplies;
+	QList<ConnectionInfo> m_rankCandidates;
+	QList<EndpointStats> m_ranking;
+	int m_rankOutstanding;
+	int m_rankGeneration;
+
+	QSettings *settings() const;
+	QNetworkAccessManager *network();
 
-	void createBrowserSource(const QString &name, const QString &url);
-	bool isHolyricsResponse(const QString &response);
 	void abortPendingRequests();
+	quint64 startProbe(const ConnectionInfo &endpoint, int timeoutMs,
+			   std::function<void(const ProbeResult &)> done);
+	void finishProbe(quint64 requestId, QNetworkReply *reply, double rttMs);
+	void settleScanRequest(const QList<ConnectionInfo> &found, const QString &error);
+	template<typename Result>
+	Request<Result> watchRequest(quint64 id, const std::shared_ptr<QPromise<Result>> &promise);
+	static QString responseFingerprint(const QByteArray &response);
+	void resetScan(int port);
+	SubnetScanner *addScanner(const QString &name, const QHostAddress &localAddress, const QString &networkKey,
+				  const ScanTargets &targets, int maxInFlight);
+	void startScanners();
+	void stopScanners();
+	void applyScanPacing();
+	void retargetProxy(const ConnectionInfo &upstream);
+	bool hostnameResolvesTo(const QString &hostname, const QString &ip) const;
+	void onHostResolved(const QString &hostname, const QList<QHostAddress> &addresses);
+	void onHostFailed(const QString &hostname, const QString &error);
+	void saveRttBaselines();
+	static QString baselineSettingsKey(const QString &networkKey);
+	void onScannerFound(const QString &interfaceName, const QString &ip, int port, double rttMs);
+	void onScannerProgress();
+	void onScannerFinished();
+	void finishScan(int generation);
+	void sendRankProbe(const ConnectionInfo &endpoint);
+	void recordRtt(const QString &ip, int port, double rttMs);
+	void finishRanking();
+	void abortRanking();
+	static QString endpointKey(const QString &ip, int port);
 };
@@ -0,0 +1,219 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "host-resolver.h"
+#include "event-log.h"
+#include <QDnsLookup>
+#include <QHostInfo>
+#include <QStringList>
+#include <algorithm>
+
+// Record TTLs are clamped: a 0 s TTL would have us hammer the resolver,
+// a day-long one would hide a DHCP change for a whole service
+static const int kMinTtlSeconds = 5;
+static const int kMaxTtlSeconds = 300;
+// The system resolver doesn't say how long an answer is good for
+static const int kSystemTtlSeconds = 30;
+// A name that didn't resolve is retried this soon at most
+static const int kNegativeTtlSeconds = 10;
+
+static QString addressList(const QList<QHostAddress> &addresses)
+{
+	QStringList text;
+	for (const QHostAddress &address : addresses) {
+		text.append(address.toString());
+	}
+	return text.join(", ");
+}
+
+static QList<QHostAddress> sorted(QList<QHostAddress> addresses)
+{
+	std::sort(addresses.begin(), addresses.end(), [](const QHostAddress &a, const QHostAddress &b) {
+		return a.toString() < b.toString();
+	});
+	return addresses;
+}
+
+HostResolver::HostResolver(QObject *parent) : QObject(parent)
+{
+	m_clock.start();
+	m_refreshTimer.setSingleShot(true);
+	connect(&m_refreshTimer, &QTimer::timeout, this, &HostResolver::refreshExpired);
+}
+
+HostResolver::~HostResolver()
+{
+	for (QDnsLookup *lookup : m_lookups) {
+		lookup->disconnect(this);
+		lookup->abort();
+	}
+}
+
+bool HostResolver::isHostname(const QString &host)
+{
+	return !host.isEmpty() && QHostAddress(host).isNull();
+}
+
+void HostResolver::resolve(const QString &hostname)
+{
+	Entry &entry = m_cache[hostname];
+	if (entry.pending) {
+		return;
+	}
+
+	if (entry.expiresNs > m_clock.nsecsElapsed()) {
+		// Keep the "always asynchronous" promise even for cache hits
+		QTimer::singleShot(0, this, [this, hostname]() {
+			const Entry entry = m_cache.value(hostname);
+			if (entry.failed) {
+				emit failed(hostname, entry.error);
+			} else {
+				emit resolved(hostname, entry.addresses);
+			}
+		});
+		return;
+	}
+
+	entry.pending = true;
+	bool systemOnly = hostname.endsWith(".local", Qt::CaseInsensitive) || !hostname.contains('.');
+	if (systemOnly) {
+		lookupSystem(hostname);
+	} else {
+		lookupDns(hostname);
+	}
+}
+
+void HostResolver::lookupDns(const QString &hostname)
+{
+	QDnsLookup *lookup = new QDnsLookup(QDnsLookup::A, hostname, this);
+	m_lookups.append(lookup);
+
+	connect(lookup, &QDnsLookup::finished, this, [this, lookup, hostname]() {
+		m_lookups.removeOne(lookup);
+		lookup->deleteLater();
+
+		QList<QHostAddress> addresses;
+		quint32 ttl = kMaxTtlSeconds;
+		for (const QDnsHostAddressRecord &record : lookup->hostAddressRecords()) {
+			addresses.append(record.value());
+			ttl = qMin(ttl, record.timeToLive());
+		}
+
+		// Names only in the hosts file or a search domain aren't in DNS
+		// as asked; the system resolver knows about those
+		if (lookup->error() != QDnsLookup::NoError || addresses.isEmpty()) {
+			lookupSystem(hostname);
+			return;
+		}
+		store(hostname, addresses, int(ttl), QString());
+	});
+	lookup->lookup();
+}
+
+void HostResolver::lookupSystem(const QString &hostname)
+{
+	QHostInfo::lookupHost(hostname, this, [this, hostname](const QHostInfo &info) {
+		if (info.error() != QHostInfo::NoError || info.addresses().isEmpty()) {
+			store(hostname, {}, kNegativeTtlSeconds,
+			      info.errorString().isEmpty() ? QString("no address") : info.errorString());
+			return;
+		}
+		store(hostname, info.addresses(), kSystemTtlSeconds, QString());
+	});
+}
+
+void HostResolver::store(const QString &hostname, const QList<QHostAddress> &addresses, int ttlSeconds,
+			 const QString &error)
+{
+	Entry &entry = m_cache[hostname];
+	bool hadAnswer = !entry.addresses.isEmpty();
+	QList<QHostAddress> before = sorted(entry.addresses);
+
+	entry.pending = false;
+	entry.failed = !error.isEmpty();
+	entry.error = error;
+	// A failed lookup keeps the last good answer around for fallbacks
+	if (!entry.failed) {
+		entry.addresses = addresses;
+	}
+	int ttl = entry.failed ? ttlSeconds : qBound(kMinTtlSeconds, ttlSeconds, kMaxTtlSeconds);
+	entry.expiresNs = m_clock.nsecsElapsed() + qint64(ttl) * 1000000000;
+
+	scheduleRefresh();
+
+	if (entry.failed) {
+		EventLog::warning("resolver", QString("%1 did not resolve: %2").arg(hostname, error));
+		emit failed(hostname, error);
+		return;
+	}
+
+	QList<QHostAddress> current = entry.addresses;
+	EventLog::detail("resolver",
+			 QString("%1 -> %2 (ttl %3 s)").arg(hostname, addressList(current)).arg(ttl));
+	emit resolved(hostname, current);
+
+	if (hadAnswer && sorted(current) != before) {
+		EventLog::info("resolver", QString("%1 now resolves to %2").arg(hostname, addressList(current)));
+		emit addressChanged(hostname, current);
+	}
+}
+
+QList<QHostAddress> HostResolver::addresses(const QString &hostname) const
+{
+	return m_cache.value(hostname).addresses;
+}
+
+bool HostResolver::hasFailed(const QString &hostname) const
+{
+	return m_cache.value(hostname).failed;
+}
+
+void HostResolver::watch(const QString &hostname)
+{
+	m_watched.insert(hostname);
+	resolve(hostname);
+}
+
+void HostResolver::unwatch(const QString &hostname)
+{
+	m_watched.remove(hostname);
+	scheduleRefresh();
+}
+
+void HostResolver::scheduleRefresh()
+{
+	qint64 now = m_clock.nsecsElapsed();
+	qint64 next = -1;
+	for (const QString &hostname : m_watched) {
+		const Entry entry = m_cache.value(hostname);
+		if (!entry.pending && (next < 0 || entry.expiresNs < next)) {
+			next = entry.expiresNs;
+		}
+	}
+
+	if (next < 0) {
+		m_refreshTimer.stop();
+		return;
+	}
+	m_refreshTimer.start(int(qMax<qint64>(0, (next - now) / 1000000)));
+}
+
+void HostResolver::refreshExpired()
+{
+	qint64 now = m_clock.nsecsElapsed();
+	const QSet<QString> watched = m_watched;
+	for (const QString &hostname : watched) {
+		const Entry entry = m_cache.value(hostname);
+		if (!entry.pending && entry.expiresNs <= now) {
+			resolve(hostname);
+		}
+	}
+	scheduleRefresh();
+}
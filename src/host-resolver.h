@@ -0,0 +1,77 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+class QDnsLookup;
+
+// Asynchronous hostname lookups with a cache that honours the record TTL.
+// Names in DNS go through QDnsLookup, which reports the TTL. mDNS
+// (".local") and single-label names go through the system resolver,
+// which doesn't report one, so those answers are kept for a fixed time.
+// Watched names are looked up again whenever their answer expires, and
+// addressChanged fires when the set of addresses is different.
+class HostResolver : public QObject {
+	Q_OBJECT
+
+public:
+	explicit HostResolver(QObject *parent = nullptr);
+	~HostResolver();
+
+	// Always ends in resolved() or failed(), straight from the cache while
+	// the last answer is still fresh
+	void resolve(const QString &hostname);
+
+	// Last answer, even if expired or followed by a failed lookup
+	QList<QHostAddress> addresses(const QString &hostname) const;
+	bool hasFailed(const QString &hostname) const;
+
+	void watch(const QString &hostname);
+	void unwatch(const QString &hostname);
+
+	// A name rather than an IP literal
+	static bool isHostname(const QString &host);
+
+signals:
+	void resolved(const QString &hostname, const QList<QHostAddress> &addresses);
+	void failed(const QString &hostname, const QString &error);
+	void addressChanged(const QString &hostname, const QList<QHostAddress> &addresses);
+
+private:
+	struct Entry {
+		QList<QHostAddress> addresses;
+		qint64 expiresNs = 0;
+		bool pending = false;
+		bool failed = false;
+		QString error;
+	};
+
+	QHash<QString, Entry> m_cache;
+	QSet<QString> m_watched;
+	QList<QDnsLookup *> m_lookups;
+	QElapsedTimer m_clock;
+	QTimer m_refreshTimer;
+
+	void lookupDns(const QString &hostname);
+	void lookupSystem(const QString &hostname);
+	void store(const QString &hostname, const QList<QHostAddress> &addresses, int ttlSeconds,
+		   const QString &error);
+	void scheduleRefresh();
+	void refreshExpired();
+};
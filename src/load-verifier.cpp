@@ -0,0 +1,263 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "load-verifier.h"
+#include "event-log.h"
+#include "holyrics-finder.h"
+#include "trace.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTimer>
+#include <QUrl>
+
+// Four attempts 0.3, 0.6 and 1.2 s apart; with the timeout that puts the
+// worst case for a whole batch at about 8 s
+static const int kMaxAttempts = 4;
+static const int kFirstRetryMs = 300;
+static const int kAttemptTimeoutMs = 1500;
+
+LoadVerifier::LoadVerifier(QObject *parent) : QObject(parent), m_network(nullptr), m_nextGeneration(0) {}
+
+LoadVerifier::~LoadVerifier()
+{
+	cancel();
+}
+
+QNetworkAccessManager *LoadVerifier::network()
+{
+	if (!m_network) {
+		m_network = new QNetworkAccessManager(this);
+	}
+	return m_network;
+}
+
+void LoadVerifier::track(const QString &sourceName, const QString &url)
+{
+	Check &check = m_checks[sourceName];
+	if (check.reply) {
+		check.reply->disconnect(this);
+		check.reply->abort();
+		check.reply->deleteLater();
+	}
+	check = Check();
+	check.url = url;
+	check.generation = ++m_nextGeneration;
+
+	// The new URL's result replaces any the source already has in this batch
+	for (int i = m_results.size() - 1; i >= 0; --i) {
+		if (m_results[i].source == sourceName) {
+			m_results.removeAt(i);
+		}
+	}
+
+	// Not inline: a bulk update should finish writing settings first
+	scheduleAttempt(sourceName, 0);
+}
+
+void LoadVerifier::cancel()
+{
+	for (Check &check : m_checks) {
+		if (check.reply) {
+			check.reply->disconnect(this);
+			check.reply->abort();
+			check.reply->deleteLater();
+		}
+	}
+	m_checks.clear();
+	m_results.clear();
+}
+
+void LoadVerifier::scheduleAttempt(const QString &sourceName, int delayMs)
+{
+	quint64 generation = m_checks.value(sourceName).generation;
+	QTimer::singleShot(delayMs, this, [this, sourceName, generation]() {
+		auto it = m_checks.constFind(sourceName);
+		if (it != m_checks.constEnd() && it->generation == generation) {
+			attempt(sourceName);
+		}
+	});
+}
+
+void LoadVerifier::attempt(const QString &sourceName)
+{
+	TRACE_SCOPE("LoadVerifier::attempt");
+
+	Check &check = m_checks[sourceName];
+	switch (sourceState(sourceName, check.url)) {
+	case SourceMissing:
+		settle(sourceName, false, false, "source removed");
+		return;
+	case SourceMoved:
+		// Someone pointed it elsewhere by hand; that's theirs to check
+		EventLog::detail("sources", QString("%1 no longer uses %2; not checking it").arg(sourceName, check.url));
+		m_checks.remove(sourceName);
+		if (m_checks.isEmpty() && !m_results.isEmpty()) {
+			settle(QString(), false, false, QString());
+		}
+		return;
+	case SourceCurrent:
+		break;
+	}
+
+	check.attempts++;
+
+	QNetworkRequest request{QUrl(check.url)};
+	// Ask for the page the browser would get now, not one kept from before
+	request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+	request.setRawHeader("Cache-Control", "no-cache");
+	request.setRawHeader("Pragma", "no-cache");
+	request.setTransferTimeout(kAttemptTimeoutMs);
+
+	QNetworkReply *reply = network()->get(request);
+	check.reply = reply;
+	quint64 generation = check.generation;
+	connect(reply, &QNetworkReply::finished, this,
+		[this, sourceName, generation, reply]() { onReplyFinished(sourceName, generation, reply); });
+}
+
+void LoadVerifier::onReplyFinished(const QString &sourceName, quint64 generation, QNetworkReply *reply)
+{
+	reply->deleteLater();
+
+	auto it = m_checks.find(sourceName);
+	if (it == m_checks.end() || it->generation != generation) {
+		return;
+	}
+	it->reply = nullptr;
+
+	QString error;
+	if (reply->error() != QNetworkReply::NoError) {
+		int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+		error = status > 0 ? QString("HTTP %1").arg(status) : reply->errorString();
+	} else if (!HolyricsFinder::isHolyricsResponse(reply->readAll())) {
+		error = "not a Holyrics page";
+	}
+
+	if (error.isEmpty()) {
+		// After a failed attempt the browser most likely got the error page
+		// too. Otherwise its load only raced this fetch: hidden sources are
+		// reloaded to be sure, but one on air is left alone, since a reload
+		// blanks it for as long as the page takes to load
+		if (it->attempts == 1 && sourceShowing(sourceName)) {
+			settle(sourceName, true, false, QString());
+			return;
+		}
+		if (!reloadSource(sourceName)) {
+			settle(sourceName, false, false, "page is served, but the source has no refresh button");
+			return;
+		}
+		settle(sourceName, true, true, QString());
+		return;
+	}
+
+	if (it->attempts < kMaxAttempts) {
+		int delayMs = kFirstRetryMs << (it->attempts - 1);
+		EventLog::detail("sources", QString("%1: %2, retrying in %3 ms").arg(sourceName, error).arg(delayMs));
+		scheduleAttempt(sourceName, delayMs);
+		return;
+	}
+
+	settle(sourceName, false, false, error);
+}
+
+void LoadVerifier::settle(const QString &sourceName, bool loaded, bool reloaded, const QString &error)
+{
+	// An empty name only flushes a batch whose last check was dropped
+	if (!sourceName.isEmpty()) {
+		Result result;
+		result.source = sourceName;
+		result.url = m_checks.value(sourceName).url;
+		result.loaded = loaded;
+		result.reloaded = reloaded;
+		result.attempts = m_checks.value(sourceName).attempts;
+		result.error = error;
+		m_checks.remove(sourceName);
+
+		if (loaded) {
+			EventLog::detail("sources", QString("%1 loaded %2 (served on attempt %3%4)")
+							    .arg(sourceName, result.url)
+							    .arg(result.attempts)
+							    .arg(reloaded ? ", reloaded" : ", showing, not reloaded"));
+		} else {
+			EventLog::warning("sources", QString("%1 did not load %2 after %3 attempt(s): %4")
+							     .arg(sourceName, result.url)
+							     .arg(result.attempts)
+							     .arg(error));
+		}
+
+		m_results.append(result);
+		emit sourceVerified(result);
+	}
+
+	if (!m_checks.isEmpty()) {
+		return;
+	}
+
+	QList<Result> results = m_results;
+	m_results.clear();
+
+	int loadedCount = 0;
+	for (const Result &result : results) {
+		loadedCount += result.loaded ? 1 : 0;
+	}
+	EventLog::info("sources", QString("Load check: %1 of %2 source(s) loaded").arg(loadedCount).arg(results.size()));
+	emit batchFinished(results);
+}
+
+LoadVerifier::SourceState LoadVerifier::sourceState(const QString &sourceName, const QString &url)
+{
+	obs_source_t *source = obs_get_source_by_name(sourceName.toUtf8().constData());
+	if (!source) {
+		return SourceMissing;
+	}
+
+	obs_data_t *settings = obs_source_get_settings(source);
+	bool current = QString::fromUtf8(obs_data_get_string(settings, "url")) == url;
+	obs_data_release(settings);
+	obs_source_release(source);
+	return current ? SourceCurrent : SourceMoved;
+}
+
+bool LoadVerifier::sourceShowing(const QString &sourceName)
+{
+	obs_source_t *source = obs_get_source_by_name(sourceName.toUtf8().constData());
+	if (!source) {
+		return false;
+	}
+
+	bool showing = obs_source_showing(source);
+	obs_source_release(source);
+	return showing;
+}
+
+bool LoadVerifier::reloadSource(const QString &sourceName)
+{
+	obs_source_t *source = obs_get_source_by_name(sourceName.toUtf8().constData());
+	if (!source) {
+		return false;
+	}
+
+	// Same as pressing "Refresh cache of current page" in the properties;
+	// re-applying unchanged settings doesn't reload the page
+	bool reloaded = false;
+	obs_properties_t *properties = obs_source_properties(source);
+	obs_property_t *refresh = properties ? obs_properties_get(properties, "refreshnocache") : nullptr;
+	if (refresh && obs_property_get_type(refresh) == OBS_PROPERTY_BUTTON) {
+		obs_property_button_clicked(refresh, source);
+		reloaded = true;
+	}
+	obs_properties_destroy(properties);
+	obs_source_release(source);
+
+	return reloaded;
+}
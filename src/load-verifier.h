@@ -0,0 +1,80 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Brings browser sources pointed at a new URL to a known state. Each
+// source's URL is fetched the way the browser would, bypassing caches,
+// and retried with backoff while Holyrics is busy or answers with an
+// error. obs-browser doesn't say whether its own load worked, so once the
+// page is known to be served the source is reloaded through its "refresh
+// without cache" button; only then does it count as loaded. A source that
+// is showing and was served on the first attempt isn't reloaded, so live
+// output doesn't blank. Sources tracked while a batch is running join it;
+// batchFinished reports every one of them.
+class LoadVerifier : public QObject {
+	Q_OBJECT
+
+public:
+	struct Result {
+		QString source;
+		QString url;
+		bool loaded = false;
+		bool reloaded = false;
+		int attempts = 0;
+		QString error;
+	};
+
+	explicit LoadVerifier(QObject *parent = nullptr);
+	~LoadVerifier();
+
+	// Call right after the source's settings were updated to `url`;
+	// tracking a source again restarts its check
+	void track(const QString &sourceName, const QString &url);
+	// Drops every check without reporting
+	void cancel();
+	bool isBusy() const { return !m_checks.isEmpty(); }
+
+signals:
+	void sourceVerified(const LoadVerifier::Result &result);
+	void batchFinished(const QList<LoadVerifier::Result> &results);
+
+private:
+	struct Check {
+		QString url;
+		int attempts = 0;
+		quint64 generation = 0;
+		QNetworkReply *reply = nullptr;
+	};
+
+	enum SourceState { SourceMissing, SourceMoved, SourceCurrent };
+
+	QNetworkAccessManager *m_network;
+	QHash<QString, Check> m_checks;
+	QList<Result> m_results;
+	quint64 m_nextGeneration;
+
+	QNetworkAccessManager *network();
+	void scheduleAttempt(const QString &sourceName, int delayMs);
+	void attempt(const QString &sourceName);
+	void onReplyFinished(const QString &sourceName, quint64 generation, QNetworkReply *reply);
+	void settle(const QString &sourceName, bool loaded, bool reloaded, const QString &error);
+	static SourceState sourceState(const QString &sourceName, const QString &url);
+	static bool sourceShowing(const QString &sourceName);
+	static bool reloadSource(const QString &sourceName);
+};
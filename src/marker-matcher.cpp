@@ -0,0 +1,229 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "marker-matcher.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MARKER_MATCHER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MARKER_MATCHER_AVX2_TARGET
+#else
+#define MARKER_MATCHER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+typedef bool (*SearchFunction)(const QList<QByteArray> &markers, qsizetype maxLength, const unsigned char *data,
+			       qsizetype size);
+
+static inline unsigned char asciiLower(unsigned char c)
+{
+	return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+static inline bool verifyAt(const unsigned char *data, const QByteArray &marker)
+{
+	for (qsizetype k = 0; k < marker.size(); ++k) {
+		if (asciiLower(data[k]) != static_cast<unsigned char>(marker[k])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool searchScalarFrom(const QList<QByteArray> &markers, const unsigned char *data, qsizetype size,
+			     qsizetype start)
+{
+	for (qsizetype i = start; i < size; ++i) {
+		unsigned char c = asciiLower(data[i]);
+		for (const QByteArray &marker : markers) {
+			if (c == static_cast<unsigned char>(marker[0]) && marker.size() <= size - i && verifyAt(data + i, marker)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static bool searchScalar(const QList<QByteArray> &markers, qsizetype, const unsigned char *data, qsizetype size)
+{
+	return searchScalarFrom(markers, data, size, 0);
+}
+
+#ifdef MARKER_MATCHER_X86
+
+static inline int lowestBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// OR-ing 0x20 folds A-Z onto a-z. It can also map a few punctuation bytes
+// together, which only adds candidates; verifyAt() does the exact check.
+static bool searchSse2(const QList<QByteArray> &markers, qsizetype maxLength, const unsigned char *data,
+		       qsizetype size)
+{
+	const __m128i fold = _mm_set1_epi8(0x20);
+	qsizetype i = 0;
+
+	for (; i + 16 + maxLength - 1 <= size; i += 16) {
+		__m128i block = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), fold);
+
+		for (const QByteArray &marker : markers) {
+			qsizetype last = marker.size() - 1;
+			__m128i first = _mm_set1_epi8(static_cast<char>(marker[0] | 0x20));
+			__m128i final = _mm_set1_epi8(static_cast<char>(marker[last] | 0x20));
+			__m128i tail = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + last)), fold);
+
+			unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(
+				_mm_and_si128(_mm_cmpeq_epi8(block, first), _mm_cmpeq_epi8(tail, final))));
+			while (mask) {
+				if (verifyAt(data + i + lowestBit(mask), marker)) {
+					return true;
+				}
+				mask &= mask - 1;
+			}
+		}
+	}
+
+	return searchScalarFrom(markers, data, size, i);
+}
+
+MARKER_MATCHER_AVX2_TARGET
+static bool searchAvx2(const QList<QByteArray> &markers, qsizetype maxLength, const unsigned char *data,
+		       qsizetype size)
+{
+	const __m256i fold = _mm256_set1_epi8(0x20);
+	qsizetype i = 0;
+
+	for (; i + 32 + maxLength - 1 <= size; i += 32) {
+		__m256i block = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), fold);
+
+		for (const QByteArray &marker : markers) {
+			qsizetype last = marker.size() - 1;
+			__m256i first = _mm256_set1_epi8(static_cast<char>(marker[0] | 0x20));
+			__m256i final = _mm256_set1_epi8(static_cast<char>(marker[last] | 0x20));
+			__m256i tail =
+				_mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + last)), fold);
+
+			unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(
+				_mm256_and_si256(_mm256_cmpeq_epi8(block, first), _mm256_cmpeq_epi8(tail, final))));
+			while (mask) {
+				if (verifyAt(data + i + lowestBit(mask), marker)) {
+					return true;
+				}
+				mask &= mask - 1;
+			}
+		}
+	}
+
+	return searchScalarFrom(markers, data, size, i);
+}
+
+static bool cpuHasAvx2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+	if (!osSavesYmm) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+struct SearchImplementation {
+	SearchFunction search;
+	const char *name;
+};
+
+static const SearchImplementation kScalar{searchScalar, "scalar"};
+#ifdef MARKER_MATCHER_X86
+static const SearchImplementation kSse2{searchSse2, "SSE2"};
+static const SearchImplementation kAvx2{searchAvx2, "AVX2"};
+#endif
+
+static const SearchImplementation *s_forced = nullptr;
+
+static const SearchImplementation &selectImplementation()
+{
+	if (s_forced) {
+		return *s_forced;
+	}
+#ifdef MARKER_MATCHER_X86
+	static const SearchImplementation &implementation = cpuHasAvx2() ? kAvx2 : kSse2;
+#else
+	static const SearchImplementation &implementation = kScalar;
+#endif
+	return implementation;
+}
+
+MarkerMatcher::MarkerMatcher(const QList<QByteArray> &markers) : m_maxLength(0)
+{
+	for (const QByteArray &marker : markers) {
+		QByteArray lowered = marker.toLower();
+		if (!lowered.isEmpty() && !m_markers.contains(lowered)) {
+			m_markers.append(lowered);
+			m_maxLength = qMax(m_maxLength, lowered.size());
+		}
+	}
+}
+
+bool MarkerMatcher::containsAny(const char *data, qsizetype size) const
+{
+	if (m_markers.isEmpty() || !data || size <= 0) {
+		return false;
+	}
+
+	return selectImplementation().search(m_markers, m_maxLength, reinterpret_cast<const unsigned char *>(data),
+					     size);
+}
+
+const char *MarkerMatcher::implementation()
+{
+	return selectImplementation().name;
+}
+
+bool MarkerMatcher::forceImplementation(const char *name)
+{
+	if (!name) {
+		s_forced = nullptr;
+		return true;
+	}
+
+	QByteArray wanted(name);
+	if (wanted == kScalar.name) {
+		s_forced = &kScalar;
+		return true;
+	}
+#ifdef MARKER_MATCHER_X86
+	if (wanted == kSse2.name) {
+		s_forced = &kSse2;
+		return true;
+	}
+	if (wanted == kAvx2.name && cpuHasAvx2()) {
+		s_forced = &kAvx2;
+		return true;
+	}
+#endif
+	return false;
+}
@@ -0,0 +1,39 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+
+// ASCII case-insensitive search for any of a set of markers in raw bytes.
+// One pass over the data: each block is compared against the first and
+// last byte of every marker at once (SSE2, or AVX2 where the CPU has it)
+// and only candidate positions are verified byte by byte.
+class MarkerMatcher {
+public:
+	explicit MarkerMatcher(const QList<QByteArray> &markers);
+
+	bool containsAny(const QByteArray &data) const { return containsAny(data.constData(), data.size()); }
+	bool containsAny(const char *data, qsizetype size) const;
+
+	const QList<QByteArray> &markers() const { return m_markers; }
+
+	// Name of the code path picked for this CPU, for the log
+	static const char *implementation();
+	// Forces "scalar", "SSE2" or "AVX2" for every matcher, or restores the
+	// automatic choice with nullptr; false if this build or CPU lacks it.
+	// Only for the benchmark, before any matching starts.
+	static bool forceImplementation(const char *name);
+
+private:
+	QList<QByteArray> m_markers;
+	qsizetype m_maxLength;
+};
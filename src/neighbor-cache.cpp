@@ -0,0 +1,187 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "neighbor-cache.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <QNetworkInterface>
+#include <QHash>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2ipdef.h>
+#include <iphlpapi.h>
+#elif defined(__linux__)
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
+#include <unistd.h>
+#endif
+
+static void appendEntry(QList<NeighborCache::Entry> &entries, const quint8 *address, int interfaceIndex,
+			const QByteArray &linkAddress)
+{
+	QHostAddress host(address);
+	if (host.isMulticast() || host.isLoopback() || host.isNull()) {
+		return;
+	}
+
+	if (host.isLinkLocal()) {
+		host.setScopeId(QNetworkInterface::interfaceNameFromIndex(interfaceIndex));
+	}
+
+	entries.append({host, linkAddress});
+}
+
+#if defined(_WIN32)
+
+static void readPlatformTable(QList<NeighborCache::Entry> &entries)
+{
+	PMIB_IPNET_TABLE2 table = nullptr;
+	if (GetIpNetTable2(AF_INET6, &table) != NO_ERROR) {
+		obs_log(LOG_WARNING, "[NeighborCache] GetIpNetTable2 failed");
+		return;
+	}
+
+	for (ULONG i = 0; i < table->NumEntries; ++i) {
+		const MIB_IPNET_ROW2 &row = table->Table[i];
+		if (row.State == NlnsUnreachable || row.State == NlnsIncomplete) {
+			continue;
+		}
+
+		appendEntry(entries, reinterpret_cast<const quint8 *>(row.Address.Ipv6.sin6_addr.u.Byte),
+			    int(row.InterfaceIndex),
+			    QByteArray(reinterpret_cast<const char *>(row.PhysicalAddress),
+				       int(row.PhysicalAddressLength)));
+	}
+
+	FreeMibTable(table);
+}
+
+#elif defined(__linux__)
+
+static void readPlatformTable(QList<NeighborCache::Entry> &entries)
+{
+	int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (fd < 0) {
+		obs_log(LOG_WARNING, "[NeighborCache] Could not open rtnetlink socket");
+		return;
+	}
+
+	struct {
+		struct nlmsghdr header;
+		struct ndmsg message;
+	} request = {};
+	request.header.nlmsg_len = NLMSG_LENGTH(sizeof(struct ndmsg));
+	request.header.nlmsg_type = RTM_GETNEIGH;
+	request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	request.header.nlmsg_seq = 1;
+	request.message.ndm_family = AF_INET6;
+
+	if (send(fd, &request, request.header.nlmsg_len, 0) < 0) {
+		obs_log(LOG_WARNING, "[NeighborCache] RTM_GETNEIGH request failed");
+		close(fd);
+		return;
+	}
+
+	alignas(struct nlmsghdr) char buffer[16384];
+	bool done = false;
+
+	while (!done) {
+		ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+		if (received <= 0) {
+			break;
+		}
+
+		int remaining = int(received);
+		for (struct nlmsghdr *header = reinterpret_cast<struct nlmsghdr *>(buffer); NLMSG_OK(header, remaining);
+		     header = NLMSG_NEXT(header, remaining)) {
+			if (header->nlmsg_type == NLMSG_DONE || header->nlmsg_type == NLMSG_ERROR) {
+				done = true;
+				break;
+			}
+			if (header->nlmsg_type != RTM_NEWNEIGH) {
+				continue;
+			}
+
+			struct ndmsg *message = reinterpret_cast<struct ndmsg *>(NLMSG_DATA(header));
+			if (message->ndm_family != AF_INET6 ||
+			    (message->ndm_state & (NUD_FAILED | NUD_INCOMPLETE | NUD_NOARP))) {
+				continue;
+			}
+
+			const quint8 *address = nullptr;
+			QByteArray linkAddress;
+
+			int attributesLength = int(header->nlmsg_len) - int(NLMSG_LENGTH(sizeof(struct ndmsg)));
+			struct rtattr *attribute = reinterpret_cast<struct rtattr *>(
+				reinterpret_cast<char *>(message) + NLMSG_ALIGN(sizeof(struct ndmsg)));
+
+			for (; RTA_OK(attribute, attributesLength); attribute = RTA_NEXT(attribute, attributesLength)) {
+				if (attribute->rta_type == NDA_DST && RTA_PAYLOAD(attribute) == 16) {
+					address = reinterpret_cast<const quint8 *>(RTA_DATA(attribute));
+				} else if (attribute->rta_type == NDA_LLADDR) {
+					linkAddress = QByteArray(reinterpret_cast<const char *>(RTA_DATA(attribute)),
+								 int(RTA_PAYLOAD(attribute)));
+				}
+			}
+
+			if (address) {
+				appendEntry(entries, address, message->ndm_ifindex, linkAddress);
+			}
+		}
+	}
+
+	close(fd);
+}
+
+#else
+
+static void readPlatformTable(QList<NeighborCache::Entry> &)
+{
+	obs_log(LOG_INFO, "[NeighborCache] IPv6 neighbor table not supported on this platform");
+}
+
+#endif
+
+QList<NeighborCache::Entry> NeighborCache::readIpv6()
+{
+	QList<Entry> entries;
+	readPlatformTable(entries);
+	return entries;
+}
+
+QList<QHostAddress> NeighborCache::ipv6Candidates()
+{
+	QList<Entry> entries = readIpv6();
+
+	QHash<QByteArray, bool> hasRoutable;
+	for (const Entry &entry : entries) {
+		if (!entry.address.isLinkLocal() && !entry.linkAddress.isEmpty()) {
+			hasRoutable[entry.linkAddress] = true;
+		}
+	}
+
+	QList<QHostAddress> candidates;
+	for (const Entry &entry : entries) {
+		if (entry.address.isLinkLocal() && hasRoutable.value(entry.linkAddress)) {
+			continue;
+		}
+		if (!candidates.contains(entry.address)) {
+			candidates.append(entry.address);
+		}
+	}
+
+	obs_log(LOG_INFO, "[NeighborCache] %lld IPv6 neighbor(s), %lld candidate(s)",
+		static_cast<long long>(entries.size()), static_cast<long long>(candidates.size()));
+
+	return candidates;
+}
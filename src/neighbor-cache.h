@@ -0,0 +1,32 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QList>
+
+// Reads the kernel's IPv6 neighbor table. IPv6 subnets are far too large
+// to sweep, so the hosts the machine has already talked to are the
+// candidate list for IPv6 discovery.
+class NeighborCache {
+public:
+	struct Entry {
+		QHostAddress address;
+		QByteArray linkAddress;
+	};
+
+	static QList<Entry> readIpv6();
+
+	// One address per neighbor, preferring global/ULA addresses over
+	// link-local ones, since browser sources can't load zone-scoped URLs.
+	static QList<QHostAddress> ipv6Candidates();
+};
@@ -0,0 +1,352 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "network-monitor.h"
+#include "event-log.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <QFile>
+#include <QNetworkInformation>
+#include <QNetworkInterface>
+#include <QSocketNotifier>
+#include <QtEndian>
+
+#ifdef __linux__
+#include <net/if.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+// DHCP, link and route events for one move arrive within a few hundred ms
+static const int kSettleMs = 250;
+
+NetworkMonitor::NetworkMonitor(QObject *parent)
+	: QObject(parent),
+	  m_running(false),
+	  m_netlinkFd(-1),
+	  m_notifier(nullptr),
+	  m_linkChanged(false)
+{
+	m_debounce.setSingleShot(true);
+	m_debounce.setInterval(kSettleMs);
+	connect(&m_debounce, &QTimer::timeout, this, &NetworkMonitor::checkForChange);
+}
+
+NetworkMonitor::~NetworkMonitor()
+{
+	stop();
+}
+
+void NetworkMonitor::start()
+{
+	if (m_running) {
+		return;
+	}
+
+	m_running = true;
+	m_networks.clear();
+	for (const LocalNetwork &network : localNetworks()) {
+		m_networks.insert(networkKey(network));
+	}
+	m_gateways = defaultGateways();
+	m_linkChanged = false;
+	m_linkRunning.clear();
+	for (const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
+		QNetworkInterface::InterfaceFlags flags = iface.flags();
+		m_linkRunning.insert(iface.index(),
+				     (flags & QNetworkInterface::IsUp) && (flags & QNetworkInterface::IsRunning));
+	}
+
+	if (openNetlink()) {
+		obs_log(LOG_INFO, "[NetworkMonitor] Watching rtnetlink for network changes");
+	} else if (followNetworkInformation()) {
+		obs_log(LOG_INFO, "[NetworkMonitor] Watching %s for network changes",
+			QNetworkInformation::instance()->backendName().toUtf8().constData());
+	} else {
+		obs_log(LOG_WARNING, "[NetworkMonitor] No network change source available");
+	}
+}
+
+void NetworkMonitor::stop()
+{
+	m_running = false;
+	m_debounce.stop();
+	closeNetlink();
+	disconnect(m_reachabilityConnection);
+	disconnect(m_mediumConnection);
+}
+
+bool NetworkMonitor::openNetlink()
+{
+#ifdef __linux__
+	int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (fd < 0) {
+		return false;
+	}
+
+	sockaddr_nl local = {};
+	local.nl_family = AF_NETLINK;
+	local.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE |
+			  RTMGRP_IPV6_ROUTE;
+	if (bind(fd, reinterpret_cast<sockaddr *>(&local), sizeof(local)) < 0) {
+		obs_log(LOG_WARNING, "[NetworkMonitor] Could not bind rtnetlink socket (errno %d)", errno);
+		close(fd);
+		return false;
+	}
+
+	m_netlinkFd = fd;
+	m_notifier = new QSocketNotifier(static_cast<qintptr>(fd), QSocketNotifier::Read, this);
+	connect(m_notifier, &QSocketNotifier::activated, this, &NetworkMonitor::readNetlink);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void NetworkMonitor::closeNetlink()
+{
+	if (m_notifier) {
+		m_notifier->setEnabled(false);
+		delete m_notifier;
+		m_notifier = nullptr;
+	}
+
+#ifdef __linux__
+	if (m_netlinkFd >= 0) {
+		close(m_netlinkFd);
+	}
+#endif
+	m_netlinkFd = -1;
+}
+
+void NetworkMonitor::readNetlink()
+{
+#ifdef __linux__
+	alignas(nlmsghdr) char buffer[8192];
+	bool relevant = false;
+
+	// Drain everything queued; the notifier fires once per wakeup
+	for (;;) {
+		ssize_t received = recv(m_netlinkFd, buffer, sizeof(buffer), 0);
+		if (received < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			// The kernel dropped events for us; assume something changed,
+			// links included
+			if (errno == ENOBUFS) {
+				relevant = true;
+				m_linkChanged = true;
+				continue;
+			}
+			break;
+		}
+		if (received == 0) {
+			break;
+		}
+
+		int remaining = static_cast<int>(received);
+		for (nlmsghdr *header = reinterpret_cast<nlmsghdr *>(buffer); NLMSG_OK(header, remaining);
+		     header = NLMSG_NEXT(header, remaining)) {
+			switch (header->nlmsg_type) {
+			case RTM_NEWLINK:
+			case RTM_DELLINK: {
+				// Wireless drivers repeat NEWLINK for scans and signal
+				// levels; only the carrier going or coming counts
+				const ifinfomsg *info = static_cast<const ifinfomsg *>(NLMSG_DATA(header));
+				bool running = header->nlmsg_type == RTM_NEWLINK && (info->ifi_flags & IFF_UP) &&
+					       (info->ifi_flags & IFF_RUNNING);
+				if (!(info->ifi_flags & IFF_LOOPBACK) && noteLinkState(info->ifi_index, running)) {
+					relevant = true;
+				}
+				break;
+			}
+			case RTM_NEWADDR:
+			case RTM_DELADDR:
+			case RTM_NEWROUTE:
+			case RTM_DELROUTE:
+				relevant = true;
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	if (relevant && m_running) {
+		m_debounce.start();
+	}
+#endif
+}
+
+bool NetworkMonitor::followNetworkInformation()
+{
+	if (!QNetworkInformation::instance() && !QNetworkInformation::loadDefaultBackend()) {
+		return false;
+	}
+
+	QNetworkInformation *information = QNetworkInformation::instance();
+	// These say nothing about which network we're on, so every report is
+	// checked as if the link had bounced
+	auto recheck = [this]() {
+		m_linkChanged = true;
+		m_debounce.start();
+	};
+	m_reachabilityConnection = connect(information, &QNetworkInformation::reachabilityChanged, this, recheck);
+	m_mediumConnection = connect(information, &QNetworkInformation::transportMediumChanged, this, recheck);
+	return true;
+}
+
+// True if the link changed state since it was last seen. A drop and a
+// reconnect inside one debounce window still counts.
+bool NetworkMonitor::noteLinkState(int interfaceIndex, bool running)
+{
+	auto it = m_linkRunning.find(interfaceIndex);
+	if (it == m_linkRunning.end()) {
+		m_linkRunning.insert(interfaceIndex, running);
+		m_linkChanged = m_linkChanged || running;
+		return running;
+	}
+	if (it.value() == running) {
+		return false;
+	}
+	it.value() = running;
+	m_linkChanged = true;
+	return true;
+}
+
+void NetworkMonitor::checkForChange()
+{
+	if (!m_running) {
+		return;
+	}
+
+	QSet<QString> networks;
+	QList<QHostAddress> added;
+	for (const LocalNetwork &network : localNetworks()) {
+		QString key = networkKey(network);
+		networks.insert(key);
+		if (!m_networks.contains(key)) {
+			added.append(network.address);
+		}
+	}
+
+	QSet<QString> gateways = defaultGateways();
+	bool gatewayChanged = gateways != m_gateways;
+	bool linkChanged = m_linkChanged;
+	m_linkChanged = false;
+	if (networks == m_networks && !gatewayChanged && !linkChanged) {
+		return;
+	}
+
+	int removed = 0;
+	for (const QString &key : m_networks) {
+		removed += networks.contains(key) ? 0 : 1;
+	}
+	m_networks = networks;
+	m_gateways = gateways;
+
+	EventLog::info("network", QString("Local networks changed: %1 joined, %2 left%3%4")
+					  .arg(added.size())
+					  .arg(removed)
+					  .arg(gatewayChanged ? ", new default gateway" : "")
+					  .arg(linkChanged ? ", a link went down or up" : ""));
+	emit networkChanged(added);
+}
+
+QList<NetworkMonitor::LocalNetwork> NetworkMonitor::localNetworks()
+{
+	QList<LocalNetwork> networks;
+	for (const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
+		QNetworkInterface::InterfaceFlags flags = iface.flags();
+		if (!(flags & QNetworkInterface::IsUp) || !(flags & QNetworkInterface::IsRunning) ||
+		    (flags & QNetworkInterface::IsLoopBack)) {
+			continue;
+		}
+
+		for (const QNetworkAddressEntry &entry : iface.addressEntries()) {
+			// Link-local addresses are on every link, so they say nothing
+			// about which network this is
+			QHostAddress address = entry.ip();
+			if (!address.isNull() && !address.isLinkLocal()) {
+				networks.append(LocalNetwork{address, entry.prefixLength()});
+			}
+		}
+	}
+	return networks;
+}
+
+QString NetworkMonitor::networkKey(const LocalNetwork &network)
+{
+	if (network.address.protocol() != QAbstractSocket::IPv6Protocol) {
+		return QString("%1/%2").arg(network.address.toString()).arg(network.prefixLength);
+	}
+
+	// IPv6 privacy addresses rotate within the prefix every few hours;
+	// only the prefix identifies the network
+	Q_IPV6ADDR bytes = network.address.toIPv6Address();
+	int prefixLength = qBound(0, network.prefixLength, 128);
+	for (int bit = prefixLength; bit < 128; ++bit) {
+		bytes[bit / 8] &= static_cast<quint8>(~(0x80 >> (bit % 8)));
+	}
+	return QString("%1/%2").arg(QHostAddress(bytes).toString()).arg(prefixLength);
+}
+
+// "interface gateway" for each default route, IPv4 and IPv6
+QSet<QString> NetworkMonitor::defaultGateways()
+{
+	QSet<QString> gateways;
+#ifdef __linux__
+	// Iface Destination Gateway Flags RefCnt Use Metric Mask ..., in hex,
+	// addresses in network byte order
+	QFile ipv4("/proc/net/route");
+	if (ipv4.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		ipv4.readLine();
+		while (!ipv4.atEnd()) {
+			QList<QByteArray> fields = ipv4.readLine().simplified().split(' ');
+			if (fields.size() < 8 || fields[1] != "00000000" || fields[7] != "00000000") {
+				continue;
+			}
+			bool ok = false;
+			quint32 gateway = fields[2].toUInt(&ok, 16);
+			if (ok && gateway != 0) {
+				gateways.insert(QString("%1 %2").arg(QString::fromUtf8(fields[0]),
+								     QHostAddress(qFromBigEndian(gateway)).toString()));
+			}
+		}
+	}
+
+	// Destination PrefixLength Source SourcePrefix NextHop Metric RefCnt Use Flags Iface
+	static const QByteArray kAnyIpv6(32, '0');
+	QFile ipv6("/proc/net/ipv6_route");
+	if (ipv6.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		while (!ipv6.atEnd()) {
+			QList<QByteArray> fields = ipv6.readLine().simplified().split(' ');
+			if (fields.size() < 10 || fields[0] != kAnyIpv6 || fields[1] != "00" || fields[4] == kAnyIpv6 ||
+			    fields[9] == "lo") {
+				continue;
+			}
+			QByteArray hex = QByteArray::fromHex(fields[4]);
+			if (hex.size() != 16) {
+				continue;
+			}
+			Q_IPV6ADDR nextHop;
+			memcpy(nextHop.c, hex.constData(), 16);
+			gateways.insert(
+				QString("%1 %2").arg(QString::fromUtf8(fields[9]), QHostAddress(nextHop).toString()));
+		}
+	}
+#endif
+	return gateways;
+}
@@ -0,0 +1,73 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QSet>
+#include <QTimer>
+
+class QSocketNotifier;
+
+// Notices when this machine's networks change: an IPv4 or IPv6 network
+// joined or left, a different default gateway, or a link that dropped and
+// came back (a different Wi-Fi can hand out the very same subnet). On
+// Linux it listens on rtnetlink for address, link and route events;
+// elsewhere, or if netlink is unavailable, it follows QNetworkInformation
+// and re-checks after every event it reports. Bursts of events are
+// coalesced into one check.
+class NetworkMonitor : public QObject {
+	Q_OBJECT
+
+public:
+	explicit NetworkMonitor(QObject *parent = nullptr);
+	~NetworkMonitor();
+
+	void start();
+	void stop();
+
+signals:
+	// `newLocalAddresses` are our addresses on networks we weren't on before;
+	// empty when only the gateway or a link changed
+	void networkChanged(const QList<QHostAddress> &newLocalAddresses);
+
+private slots:
+	void readNetlink();
+	void checkForChange();
+
+private:
+	struct LocalNetwork {
+		QHostAddress address;
+		int prefixLength;
+	};
+
+	QTimer m_debounce;
+	bool m_running;
+	int m_netlinkFd;
+	QSocketNotifier *m_notifier;
+	QMetaObject::Connection m_reachabilityConnection;
+	QMetaObject::Connection m_mediumConnection;
+	QSet<QString> m_networks;
+	QSet<QString> m_gateways;
+	// Interface index -> up and running, as last seen on rtnetlink
+	QHash<int, bool> m_linkRunning;
+	bool m_linkChanged;
+
+	bool openNetlink();
+	void closeNetlink();
+	bool followNetworkInformation();
+	bool noteLinkState(int interfaceIndex, bool running);
+	static QList<LocalNetwork> localNetworks();
+	static QString networkKey(const LocalNetwork &network);
+	static QSet<QString> defaultGateways();
+};
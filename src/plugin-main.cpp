@@ -19,10 +19,24 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <obs-module.h>
 #include <obs-frontend-api.h>
 #include <plugin-support.h>
+#include <util/platform.h>
 #include <QCoreApplication>
 #include <QLocale>
+#include <QTimer>
+#include <QAction>
+#include <QDateTime>
+#include <QMessageBox>
 #include "holyrics-finder.h"
 #include "holyrics-dialog.h"
+#include "discovery-service.h"
+#include "docks-config.h"
+#include "endpoint-verifier.h"
+#include "event-log.h"
+#include "failover-monitor.h"
+#include "network-monitor.h"
+#include "source-governor.h"
+#include "text-mirror.h"
+#include "trace.h"
 #include "translations.h"
 
 OBS_DECLARE_MODULE()
@@ -45,38 +59,225 @@ const char *obs_module_author(void)
 
 HolyricsFinder *g_finder = nullptr;
 HolyricsDialog *g_dialog = nullptr;
+SourceGovernor *g_governor = nullptr;
+TextMirror *g_textMirror = nullptr;
+FailoverMonitor *g_failover = nullptr;
+EndpointVerifier *g_verifier = nullptr;
+NetworkMonitor *g_networkMonitor = nullptr;
+DiscoveryService *g_discovery = nullptr;
+
+// Idle delay before the finder warms up (settings read, history log)
+static const int kWarmUpDelayMs = 10000;
+
+static double elapsedMs(uint64_t startNs)
+{
+	return (os_gettime_ns() - startNs) / 1000000.0;
+}
+
+static HolyricsDialog *ensureDialog()
+{
+	if (!g_dialog) {
+		uint64_t start = os_gettime_ns();
+		g_dialog = new HolyricsDialog((QWidget *)obs_frontend_get_main_window(), g_finder, g_governor, g_textMirror, g_failover);
+		obs_log(LOG_INFO, "[obs-holyrics-finder] dialog constructed in %.2f ms", elapsedMs(start));
+	}
+	return g_dialog;
+}
+
+// A fresh file in the plugin's config directory, e.g. holyrics-trace-20240101-120000.json
+static QString timestampedConfigPath(const QString &prefix, const QString &extension)
+{
+	QString fileName = QString("%1-%2.%3")
+				   .arg(prefix, QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"), extension);
+	char *configPath = obs_module_config_path(fileName.toUtf8().constData());
+	QString path = QString::fromUtf8(configPath);
+	bfree(configPath);
+
+	char *configDir = obs_module_config_path("");
+	os_mkdirs(configDir);
+	bfree(configDir);
+
+	return path;
+}
+
+static void saveTrace()
+{
+	QString path = timestampedConfigPath("holyrics-trace", "json");
+
+	QWidget *mainWindow = (QWidget *)obs_frontend_get_main_window();
+	int written = Trace::dump(path);
+	if (written < 0) {
+		QMessageBox::warning(mainWindow, Translations::get("window.title"), Translations::get("trace.save_failed"));
+	} else {
+		QMessageBox::information(mainWindow, Translations::get("window.title"),
+					 Translations::get("trace.saved").arg(written).arg(path));
+	}
+}
+
+static void saveDetailedLog()
+{
+	QString path = timestampedConfigPath("holyrics-log", "txt");
+
+	QWidget *mainWindow = (QWidget *)obs_frontend_get_main_window();
+	int written = EventLog::dump(path);
+	if (written < 0) {
+		QMessageBox::warning(mainWindow, Translations::get("window.title"), Translations::get("log.save_failed"));
+	} else {
+		QMessageBox::information(mainWindow, Translations::get("window.title"),
+					 Translations::get("log.saved").arg(written).arg(path));
+	}
+}
+
+static void onFinishedLoading()
+{
+	uint64_t start = os_gettime_ns();
+
+	// Detect OBS language
+	QString obsLang = QLocale().name();
+	if (obsLang.startsWith("pt")) {
+		Translations::setLanguage("pt-BR");
+	} else {
+		Translations::setLanguage("en");
+	}
+
+	// Read here rather than in obs_module_load, like everything below
+	Trace::restore();
+
+	// Get translated menu name
+	QString menuName = Translations::get("menu.name");
+
+	// The dialog is only built the first time someone opens it
+	obs_frontend_add_tools_menu_item(
+		menuName.toUtf8().constData(),
+		[](void *) {
+			if (g_finder) {
+				ensureDialog()->show();
+			}
+		},
+		nullptr);
+
+	QAction *traceAction = static_cast<QAction *>(
+		obs_frontend_add_tools_menu_qaction(Translations::get("menu.trace_record").toUtf8().constData()));
+	traceAction->setCheckable(true);
+	traceAction->setChecked(Trace::isEnabled());
+	QObject::connect(traceAction, &QAction::toggled, [](bool checked) { Trace::setEnabled(checked); });
+
+	obs_frontend_add_tools_menu_item(
+		Translations::get("menu.trace_save").toUtf8().constData(), [](void *) { saveTrace(); }, nullptr);
+
+	obs_frontend_add_tools_menu_item(
+		Translations::get("menu.log_save").toUtf8().constData(), [](void *) { saveDetailedLog(); }, nullptr);
+
+	// Sources exist by now, so the governor can pick them up straight away.
+	// Sources on the proxy loaded before it listened; restoring it reloads them.
+	g_finder->restoreProxy();
+	g_finder->restoreHostBinding();
+	g_governor->start();
+	g_textMirror->restore();
+	g_failover->start();
+	g_verifier->start();
+	g_networkMonitor->start();
+	g_discovery->start();
+
+	QTimer::singleShot(kWarmUpDelayMs, g_finder, []() {
+		if (!g_finder) {
+			return;
+		}
+		uint64_t warmUpStart = os_gettime_ns();
+		g_finder->logConnectionHistory();
+		obs_log(LOG_INFO, "[obs-holyrics-finder] idle warm-up took %.2f ms", elapsedMs(warmUpStart));
+	});
+
+	obs_log(LOG_INFO, "[obs-holyrics-finder] finished-loading hook took %.2f ms", elapsedMs(start));
+}
+
+// Runs on EXIT, on the UI thread, while the main window and the Qt event
+// loop are still alive, so every object can be deleted normally: sockets
+// and replies are aborted and freed with their owners instead of leaking.
+static void shutdownPlugin()
+{
+	uint64_t start = os_gettime_ns();
+
+	// The dialog holds pointers to everything below, so it goes first
+	delete g_dialog;
+	g_dialog = nullptr;
+
+	delete g_networkMonitor;
+	g_networkMonitor = nullptr;
+
+	// Lookups from other plugins answer "not found" from here on
+	delete g_discovery;
+	g_discovery = nullptr;
+
+	delete g_verifier;
+	g_verifier = nullptr;
+
+	delete g_failover;
+	g_failover = nullptr;
+
+	// Stops polling but keeps textMirror/enabled for the next session
+	delete g_textMirror;
+	g_textMirror = nullptr;
+
+	// The governor already handed the sources back on scripting shutdown
+	delete g_governor;
+	g_governor = nullptr;
+
+	// Cancels scans and probes and flushes history before freeing the network stack
+	if (g_finder) {
+		g_finder->prepareForShutdown();
+	}
+	delete g_finder;
+	g_finder = nullptr;
+
+	obs_log(LOG_INFO, "[obs-holyrics-finder] shutdown took %.2f ms", elapsedMs(start));
+}
 
 bool obs_module_load(void)
 {
+	uint64_t start = os_gettime_ns();
+
 	obs_log(LOG_INFO, "plugin loaded successfully (version %s)", PLUGIN_VERSION);
 
 	g_finder = new HolyricsFinder();
+	g_governor = new SourceGovernor();
+	g_textMirror = new TextMirror();
+	g_failover = new FailoverMonitor(g_finder);
+
+	// Started on FINISHED_LOADING; follows collection switches itself
+	g_verifier = new EndpointVerifier(g_finder);
+
+	// Moving to another room's network re-checks the sources right away
+	g_networkMonitor = new NetworkMonitor();
+	QObject::connect(g_networkMonitor, &NetworkMonitor::networkChanged, g_verifier,
+			 &EndpointVerifier::verifyAfterNetworkChange);
+
+	// Other plugins and scripts ask here instead of scanning themselves
+	g_discovery = new DiscoveryService(g_finder);
+
+	// The mirror reads Holyrics directly, so it follows the sources over
+	QObject::connect(g_failover, &FailoverMonitor::failedOver, g_textMirror,
+			 [](const QString &, const QString &ip, int port, int) {
+				 if (g_textMirror->isRunning()) {
+					 g_textMirror->start(ip, port);
+				 }
+			 });
 
 	obs_frontend_add_event_callback(
 		[](enum obs_frontend_event event, void *) {
 			if (event == OBS_FRONTEND_EVENT_FINISHED_LOADING) {
-				// Detect OBS language
-				QString obsLang = QLocale().name();
-				if (obsLang.startsWith("pt")) {
-					Translations::setLanguage("pt-BR");
-				} else {
-					Translations::setLanguage("en");
-				}
-
-				g_dialog = new HolyricsDialog(
-					(QWidget *)obs_frontend_get_main_window(),
-					g_finder);
-
-				// Get translated menu name
-				QString menuName = Translations::get("menu.name");
-				
-				obs_frontend_add_tools_menu_item(
-					menuName.toUtf8().constData(),
-					[](void *) { g_dialog->show(); }, nullptr);
+				onFinishedLoading();
+			} else if (event == OBS_FRONTEND_EVENT_EXIT && g_finder) {
+				// Teardown removes other frontend callbacks mid-dispatch,
+				// which can hand this one the same event twice
+				DocksConfig::reapplyRewrites();
+				shutdownPlugin();
 			}
 		},
 		nullptr);
 
+	obs_log(LOG_INFO, "[obs-holyrics-finder] module load took %.2f ms", elapsedMs(start));
+
 	return true;
 }
 
@@ -84,22 +285,21 @@ void obs_module_unload(void)
 {
 	obs_log(LOG_INFO, "[obs-holyrics-finder] plugin unloading...");
 
-	// Set shutdown flag first
+	// Normally shutdownPlugin() already ran on EXIT. If it didn't, Qt may be
+	// gone by now and any Qt call can crash, so leave the rest to the OS.
 	if (g_finder) {
-		g_finder->prepareForShutdown();
+		obs_log(LOG_WARNING, "[obs-holyrics-finder] unloaded without an EXIT event; skipping teardown");
 	}
+	EventLog::flush();
 
-	// Don't delete dialog - Qt is shutting down and any Qt calls can crash
-	// Just set to nullptr and let the OS clean up the memory
-	if (g_dialog) {
-		g_dialog = nullptr;
-	}
-
-	// Don't delete finder - it has Qt objects (QNetworkAccessManager, QSettings)
-	// Just set to nullptr and let the OS clean up the memory
-	if (g_finder) {
-		g_finder = nullptr;
-	}
+	g_dialog = nullptr;
+	g_governor = nullptr;
+	g_failover = nullptr;
+	g_verifier = nullptr;
+	g_networkMonitor = nullptr;
+	g_discovery = nullptr;
+	g_textMirror = nullptr;
+	g_finder = nullptr;
 
 	obs_log(LOG_INFO, "[obs-holyrics-finder] plugin unloaded");
 }
@@ -0,0 +1,75 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "rtt-estimator.h"
+#include <QtGlobal>
+#include <cmath>
+
+// RFC 6298 gains and variance multiplier
+static const double kAlpha = 1.0 / 8.0;
+static const double kBeta = 1.0 / 4.0;
+static const double kVarianceFactor = 4.0;
+// Timer granularity term, so a perfectly stable LAN doesn't get RTO == SRTT
+static const double kGranularityMs = 5.0;
+
+static const int kConnectFloorMs = 50;
+static const int kReadFloorMs = 250;
+
+RttEstimator::RttEstimator() : m_srtt(0.0), m_rttvar(0.0), m_samples(0), m_seeded(false) {}
+
+void RttEstimator::seed(double smoothedRttMs, double rttVarianceMs)
+{
+	if (smoothedRttMs <= 0.0) {
+		return;
+	}
+
+	m_srtt = smoothedRttMs;
+	m_rttvar = qMax(0.0, rttVarianceMs);
+	m_seeded = true;
+}
+
+void RttEstimator::addSample(double rttMs)
+{
+	if (rttMs < 0.0) {
+		return;
+	}
+
+	if (m_samples == 0 && !m_seeded) {
+		m_srtt = rttMs;
+		m_rttvar = rttMs / 2.0;
+	} else {
+		m_rttvar = (1.0 - kBeta) * m_rttvar + kBeta * std::fabs(m_srtt - rttMs);
+		m_srtt = (1.0 - kAlpha) * m_srtt + kAlpha * rttMs;
+	}
+
+	m_samples++;
+}
+
+double RttEstimator::rtoMs() const
+{
+	return m_srtt + qMax(kGranularityMs, kVarianceFactor * m_rttvar);
+}
+
+int RttEstimator::connectTimeoutMs() const
+{
+	if (m_samples == 0 && !m_seeded) {
+		return kCeilingMs;
+	}
+	return qBound(kConnectFloorMs, int(std::ceil(rtoMs())), kCeilingMs);
+}
+
+int RttEstimator::readTimeoutMs() const
+{
+	if (m_samples == 0 && !m_seeded) {
+		return kCeilingMs;
+	}
+	// Leave the HTTP server a few round trips worth of processing time
+	return qBound(kReadFloorMs, int(std::ceil(4.0 * rtoMs())), kCeilingMs);
+}
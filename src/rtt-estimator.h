@@ -0,0 +1,41 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+// Smoothed RTT / RTT variance estimator in the style of TCP's RTO
+// calculation (RFC 6298). Scans feed it connect and refusal times and
+// derive their connect and read deadlines from it.
+class RttEstimator {
+public:
+	RttEstimator();
+
+	void seed(double smoothedRttMs, double rttVarianceMs);
+	void addSample(double rttMs);
+
+	int sampleCount() const { return m_samples; }
+	double smoothedRttMs() const { return m_srtt; }
+	double rttVarianceMs() const { return m_rttvar; }
+
+	// Deadline for a TCP handshake to complete
+	int connectTimeoutMs() const;
+	// Deadline for the HTTP response once connected
+	int readTimeoutMs() const;
+
+	static const int kCeilingMs = 2000;
+
+private:
+	double m_srtt;
+	double m_rttvar;
+	int m_samples;
+	bool m_seeded;
+
+	double rtoMs() const;
+};
@@ -0,0 +1,100 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "scan-pacing.h"
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+#include <QSettings>
+#include <QStringList>
+
+namespace ScanPacing {
+
+// About 30 probes a second, a small slice of even a weak venue uplink
+static const double kDefaultPacketsPerSecond = 200.0;
+static const double kDefaultBytesPerSecond = 64.0 * 1024.0;
+// The Holyrics markers are in the first few hundred bytes of the page
+static const int kPacedResponseBytes = 4096;
+
+// About 200 probes a second: a /16 takes five or six minutes, the local
+// /24 (swept first) about a second
+static const double kDefaultWidePacketsPerSecond = 1200.0;
+static const double kDefaultWideBytesPerSecond = 1024.0 * 1024.0;
+
+static const double kCongestionThreshold = 0.1;
+static const double kDropRatioThreshold = 0.005;
+
+static bool streamStruggling()
+{
+	obs_output_t *output = obs_frontend_get_streaming_output();
+	if (!output) {
+		return false;
+	}
+
+	int dropped = obs_output_get_frames_dropped(output);
+	int total = obs_output_get_total_frames(output);
+	float congestion = obs_output_get_congestion(output);
+	obs_output_release(output);
+
+	return congestion > kCongestionThreshold || (total > 0 && double(dropped) / total > kDropRatioThreshold);
+}
+
+Budget current()
+{
+	Budget budget{false, 0.0, 0.0, 0, QString()};
+
+	QSettings settings("OBS", "HolyricsFinder");
+	if (!settings.value("pacing/enabled", true).toBool()) {
+		return budget;
+	}
+
+	bool streaming = obs_frontend_streaming_active();
+	bool recording = obs_frontend_recording_active();
+	if (!streaming && !recording) {
+		return budget;
+	}
+
+	QStringList reasons;
+	if (streaming) {
+		reasons.append("streaming");
+	}
+	if (recording) {
+		reasons.append("recording");
+	}
+
+	budget.paced = true;
+	budget.packetsPerSecond = settings.value("pacing/packetsPerSecond", kDefaultPacketsPerSecond).toDouble();
+	budget.bytesPerSecond = settings.value("pacing/bytesPerSecond", kDefaultBytesPerSecond).toDouble();
+	budget.maxResponseBytes = kPacedResponseBytes;
+
+	if (streaming && streamStruggling()) {
+		reasons.append("dropping frames");
+		budget.packetsPerSecond /= 2.0;
+		budget.bytesPerSecond /= 2.0;
+	}
+
+	budget.reason = reasons.join(", ");
+	return budget;
+}
+
+Budget wideSweep()
+{
+	Budget budget{false, 0.0, 0.0, 0, QString()};
+
+	QSettings settings("OBS", "HolyricsFinder");
+	budget.paced = true;
+	budget.packetsPerSecond =
+		settings.value("pacing/widePacketsPerSecond", kDefaultWidePacketsPerSecond).toDouble();
+	budget.bytesPerSecond = settings.value("pacing/wideBytesPerSecond", kDefaultWideBytesPerSecond).toDouble();
+	budget.maxResponseBytes = kPacedResponseBytes;
+	budget.reason = "wide subnet";
+	return budget;
+}
+
+} // namespace ScanPacing
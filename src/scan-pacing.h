@@ -0,0 +1,38 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QString>
+
+// Decides how hard a scan may hit the network. While OBS is streaming or
+// recording, probes are held to a packet-rate and bandwidth budget so a
+// sweep can't compete with the upload; if the stream is already dropping
+// frames or congested the budget is halved.
+namespace ScanPacing {
+
+struct Budget {
+	bool paced;
+	double packetsPerSecond;
+	double bytesPerSecond;
+	int maxResponseBytes;
+	// e.g. "streaming, recording, congested"
+	QString reason;
+};
+
+// Reads the output state and the pacing/* settings
+Budget current();
+
+// Sweeps of networks wider than a /24 (up to 65534 hosts, only with
+// scan/wideSubnets on) are always paced, at this budget, even when nothing
+// is live and pacing/enabled is off
+Budget wideSweep();
+
+} // namespace ScanPacing
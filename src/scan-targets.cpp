@@ -0,0 +1,76 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "scan-targets.h"
+
+void ScanTargets::setRange(quint32 first, quint32 last)
+{
+	if (last < first) {
+		m_rangeAvailable = 0;
+		m_taken.clear();
+		return;
+	}
+
+	m_rangeFirst = first;
+	m_rangeAvailable = int(last - first + 1);
+	m_taken = QBitArray(m_rangeAvailable);
+	m_rangeCursor = 0;
+}
+
+bool ScanTargets::takeFromRange(const Endpoint &endpoint)
+{
+	if (!endpoint.isIPv4() || endpoint.toIPv4() < m_rangeFirst) {
+		return false;
+	}
+
+	quint32 offset = endpoint.toIPv4() - m_rangeFirst;
+	if (offset >= quint32(m_taken.size()) || m_taken.testBit(int(offset))) {
+		return false;
+	}
+
+	m_taken.setBit(int(offset));
+	m_rangeAvailable--;
+	return true;
+}
+
+void ScanTargets::addHost(const QHostAddress &address)
+{
+	Endpoint endpoint(address, m_port);
+	if (endpoint.isNull() || m_listed.contains(endpoint)) {
+		return;
+	}
+
+	takeFromRange(endpoint);
+	m_listed.insert(endpoint);
+	m_hosts.append(endpoint);
+}
+
+void ScanTargets::exclude(const QHostAddress &address)
+{
+	takeFromRange(Endpoint(address, m_port));
+}
+
+bool ScanTargets::next(Endpoint &target)
+{
+	if (m_nextHost < m_hosts.size()) {
+		target = m_hosts[m_nextHost++];
+		return true;
+	}
+
+	while (m_rangeCursor < m_taken.size()) {
+		int offset = m_rangeCursor++;
+		if (!m_taken.testBit(offset)) {
+			m_taken.setBit(offset);
+			target = Endpoint::fromIPv4(m_rangeFirst + quint32(offset), m_port);
+			return true;
+		}
+	}
+	return false;
+}
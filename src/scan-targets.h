@@ -0,0 +1,52 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "endpoint.h"
+#include <QBitArray>
+#include <QList>
+#include <QSet>
+
+// The hosts one scanner probes: a few listed hosts (history, IPv6
+// neighbours) in the order they were added, then an IPv4 range. The range
+// is never expanded into a list. One bit per host records whether it is
+// already taken, either by a listed host or by an earlier next(), so a
+// /16 costs 8 KB instead of 65k address objects.
+class ScanTargets {
+public:
+	explicit ScanTargets(quint16 port = 0) : m_port(port) {}
+
+	// Call before addHost/exclude so hosts inside the range are skipped there
+	void setRange(quint32 first, quint32 last);
+	// Duplicates are dropped
+	void addHost(const QHostAddress &address);
+	// Never probed, e.g. the scanner's own address
+	void exclude(const QHostAddress &address);
+
+	int size() const { return int(m_hosts.size()) + m_rangeAvailable; }
+	int listedCount() const { return int(m_hosts.size()); }
+	bool isEmpty() const { return size() == 0; }
+
+	// Walks listed hosts, then the range; false once everything is taken
+	bool next(Endpoint &target);
+
+private:
+	quint16 m_port;
+	QList<Endpoint> m_hosts;
+	QSet<Endpoint> m_listed;
+	quint32 m_rangeFirst = 0;
+	int m_rangeAvailable = 0;
+	QBitArray m_taken;
+	int m_nextHost = 0;
+	int m_rangeCursor = 0;
+
+	bool takeFromRange(const Endpoint &endpoint);
+};
@@ -0,0 +1,127 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "source-catalog.h"
+#include "trace.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <QHash>
+#include <QRegularExpression>
+#include <cstring>
+
+struct SceneMembership {
+	QString sceneName;
+	QHash<QString, QStringList> *scenesBySource;
+};
+
+static bool collectSceneItem(obs_scene_t *, obs_sceneitem_t *item, void *param)
+{
+	auto *membership = static_cast<SceneMembership *>(param);
+	obs_source_t *source = obs_sceneitem_get_source(item);
+
+	QStringList &scenes = (*membership->scenesBySource)[QString::fromUtf8(obs_source_get_name(source))];
+	if (!scenes.contains(membership->sceneName)) {
+		scenes.append(membership->sceneName);
+	}
+
+	// Items inside a group count as part of the scene that holds the group
+	if (obs_sceneitem_is_group(item)) {
+		obs_sceneitem_group_enum_items(item, collectSceneItem, param);
+	}
+	return true;
+}
+
+QList<SourceCatalog::Entry> SourceCatalog::snapshot()
+{
+	TRACE_SCOPE("SourceCatalog::snapshot");
+
+	// Copy name/url out under the enumeration and parse afterwards, so
+	// the sources lock isn't held while regexes run
+	QList<RawSource> sources;
+	obs_enum_sources(
+		[](void *param, obs_source_t *source) {
+			if (strcmp(obs_source_get_id(source), "browser_source") != 0) {
+				return true;
+			}
+
+			auto *sources = static_cast<QList<RawSource> *>(param);
+			obs_data_t *settings = obs_source_get_settings(source);
+			sources->append(RawSource{QString::fromUtf8(obs_source_get_name(source)),
+						  QString::fromUtf8(obs_data_get_string(settings, "url")), QStringList()});
+			obs_data_release(settings);
+			return true;
+		},
+		&sources);
+
+	QHash<QString, QStringList> scenesBySource;
+	obs_enum_scenes(
+		[](void *param, obs_source_t *sceneSource) {
+			obs_scene_t *scene = obs_scene_from_source(sceneSource);
+			if (!scene) {
+				return true;
+			}
+
+			SceneMembership membership{QString::fromUtf8(obs_source_get_name(sceneSource)),
+						   static_cast<QHash<QString, QStringList> *>(param)};
+			obs_scene_enum_items(scene, collectSceneItem, &membership);
+			return true;
+		},
+		&scenesBySource);
+
+	for (RawSource &source : sources) {
+		source.scenes = scenesBySource.value(source.name);
+	}
+
+	return build(sources);
+}
+
+QList<SourceCatalog::Entry> SourceCatalog::build(const QList<RawSource> &sources)
+{
+	TRACE_SCOPE("SourceCatalog::build");
+
+	QList<Entry> entries;
+	entries.reserve(sources.size());
+
+	for (const RawSource &source : sources) {
+		Entry entry;
+		if (HolyricsFinder::parseEndpointUrl(source.url, entry.endpoint, entry.urlPath)) {
+			entry.name = source.name;
+			entry.url = source.url;
+			entry.scenes = source.scenes;
+			entries.append(entry);
+		}
+	}
+
+	return entries;
+}
+
+QString SourceCatalog::searchKey(const Entry &entry)
+{
+	return QStringList{entry.name, HolyricsFinder::formatEndpoint(entry.endpoint.ip, entry.endpoint.port),
+			   entry.scenes.join(' '), entry.urlPath}
+		.join('\n')
+		.toLower();
+}
+
+QStringList SourceCatalog::queryTerms(const QString &query)
+{
+	static const QRegularExpression whitespace("\\s+");
+	return query.toLower().split(whitespace, Qt::SkipEmptyParts);
+}
+
+bool SourceCatalog::matches(const QString &key, const QStringList &terms)
+{
+	for (const QString &term : terms) {
+		if (!key.contains(term)) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,45 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "holyrics-finder.h"
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+// Snapshot of the browser sources that point at a Holyrics-style
+// ip:port URL. snapshot() is the only part that talks to libobs; build()
+// works on plain name/url pairs so it can be driven without OBS.
+class SourceCatalog {
+public:
+	struct Entry {
+		QString name;
+		QString url;
+		QString urlPath;
+		HolyricsFinder::ConnectionInfo endpoint;
+		QStringList scenes;
+	};
+
+	struct RawSource {
+		QString name;
+		QString url;
+		QStringList scenes;
+	};
+
+	static QList<Entry> snapshot();
+	static QList<Entry> build(const QList<RawSource> &sources);
+
+	// Lower-cased "name endpoint scenes path" text for substring search
+	static QString searchKey(const Entry &entry);
+	// Every whitespace-separated term of `query` must appear in `key`
+	static bool matches(const QString &key, const QStringList &terms);
+	static QStringList queryTerms(const QString &query);
+};
@@ -0,0 +1,561 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "source-governor.h"
+#include "event-log.h"
+#include "holyrics-finder.h"
+#include "trace.h"
+#include <obs-module.h>
+#include <QSettings>
+#include <cstring>
+
+static const int kTickMs = 1000;
+static const int kDiscoverEveryTicks = 5;
+static const int kDefaultIdleFps = 5;
+static const int kDefaultGraceSeconds = 120;
+static const int kDefaultBrowserFps = 30;
+// Rough footprint of one loaded CEF page; only used for the savings estimate
+static const int kEstimatedBrowserMemoryMb = 80;
+static const char *kOriginalSettingsKey = "holyrics_governor";
+
+static bool isHolyricsBrowserSource(obs_source_t *source)
+{
+	const char *id = obs_source_get_id(source);
+	if (!id || strcmp(id, "browser_source") != 0) {
+		return false;
+	}
+
+	obs_data_t *settings = obs_source_get_settings(source);
+	QString url = QString::fromUtf8(obs_data_get_string(settings, "url"));
+	obs_data_release(settings);
+
+	HolyricsFinder::ConnectionInfo endpoint;
+	QString urlPath;
+	if (!HolyricsFinder::parseEndpointUrl(url, endpoint, urlPath)) {
+		return false;
+	}
+
+	for (const HolyricsFinder::HolyricsSource &definition : HolyricsFinder::getSourceDefinitions()) {
+		if (urlPath == definition.urlPath) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool sceneContains(obs_source_t *sceneSource, const QString &name)
+{
+	obs_scene_t *scene = sceneSource ? obs_scene_from_source(sceneSource) : nullptr;
+	return scene && obs_scene_find_source_recursive(scene, name.toUtf8().constData());
+}
+
+SourceGovernor::SourceGovernor(QObject *parent)
+	: QObject(parent),
+	  m_enabled(false),
+	  m_running(false),
+	  m_idleFps(kDefaultIdleFps),
+	  m_graceSeconds(kDefaultGraceSeconds),
+	  m_tick(0),
+	  m_idleFpsCapped(false),
+	  m_transition(nullptr),
+	  m_lastEvaluateMs(0),
+	  m_stats{0, 0, 0, 0, 0.0, 0.0, 0}
+{
+	m_clock.start();
+
+	m_timer.setInterval(kTickMs);
+	connect(&m_timer, &QTimer::timeout, this, &SourceGovernor::onTick);
+}
+
+SourceGovernor::~SourceGovernor()
+{
+	stop();
+}
+
+void SourceGovernor::start()
+{
+	if (m_running) {
+		return;
+	}
+
+	QSettings settings("OBS", "HolyricsFinder");
+	// Rewrites the user's browser settings, so only ever on when asked for
+	m_enabled = settings.value("governor/enabled", false).toBool();
+	m_idleFps = qBound(1, settings.value("governor/idleFps", kDefaultIdleFps).toInt(), 60);
+	m_graceSeconds = qMax(0, settings.value("governor/graceSeconds", kDefaultGraceSeconds).toInt());
+
+	m_running = true;
+	obs_frontend_add_event_callback(onFrontendEvent, this);
+	connectTransition();
+
+	EventLog::info("governor", QString("%1: idle sources capped at %2 fps in studio mode, unloaded after %3 s")
+					  .arg(m_enabled ? "enabled" : "disabled")
+					  .arg(m_idleFps)
+					  .arg(m_graceSeconds));
+
+	if (m_enabled) {
+		discover();
+		evaluate();
+		m_timer.start();
+	}
+}
+
+void SourceGovernor::stop()
+{
+	if (!m_running) {
+		return;
+	}
+
+	m_running = false;
+	m_timer.stop();
+	obs_frontend_remove_event_callback(onFrontendEvent, this);
+	disconnectTransition();
+	releaseAll(true);
+}
+
+void SourceGovernor::setEnabled(bool enabled)
+{
+	if (m_enabled == enabled) {
+		return;
+	}
+
+	m_enabled = enabled;
+	QSettings("OBS", "HolyricsFinder").setValue("governor/enabled", enabled);
+	EventLog::info("governor", enabled ? "enabled" : "disabled");
+
+	if (!m_running) {
+		return;
+	}
+
+	if (enabled) {
+		// Sources still waiting to be hidden are governed again as they are
+		forgetPending();
+		discover();
+		evaluate();
+		m_timer.start();
+	} else {
+		m_timer.stop();
+		releaseAll(true, true);
+		if (!m_pendingShutdown.isEmpty()) {
+			m_timer.start();
+		}
+	}
+}
+
+void SourceGovernor::preloadScene(const QString &sceneName)
+{
+	if (!m_enabled || !m_running) {
+		return;
+	}
+
+	m_preloadScene = sceneName;
+	evaluate();
+}
+
+void SourceGovernor::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+	SourceGovernor *governor = static_cast<SourceGovernor *>(data);
+
+	switch (event) {
+	case OBS_FRONTEND_EVENT_TRANSITION_CHANGED:
+		governor->disconnectTransition();
+		governor->connectTransition();
+		break;
+	case OBS_FRONTEND_EVENT_TRANSITION_STOPPED:
+		governor->m_preloadScene.clear();
+		if (governor->m_enabled) {
+			governor->evaluate();
+		}
+		break;
+	case OBS_FRONTEND_EVENT_SCENE_CHANGED:
+	case OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED:
+	case OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED:
+	case OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED:
+		if (governor->m_enabled) {
+			governor->evaluate();
+		}
+		break;
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED:
+		if (governor->m_enabled) {
+			governor->discover();
+			governor->evaluate();
+			governor->m_timer.start();
+		}
+		break;
+	// Both fire before the collection is saved, so the file keeps the
+	// user's own settings rather than the throttled ones
+	case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING:
+	case OBS_FRONTEND_EVENT_SCRIPTING_SHUTDOWN:
+		governor->m_timer.stop();
+		governor->releaseAll(true);
+		break;
+	default:
+		break;
+	}
+}
+
+void SourceGovernor::onTransitionStart(void *data, calldata_t *params)
+{
+	SourceGovernor *governor = static_cast<SourceGovernor *>(data);
+	obs_source_t *transition = static_cast<obs_source_t *>(calldata_ptr(params, "source"));
+	if (!transition) {
+		return;
+	}
+
+	obs_source_t *destination = obs_transition_get_source(transition, OBS_TRANSITION_SOURCE_B);
+	if (!destination) {
+		return;
+	}
+
+	QString sceneName = QString::fromUtf8(obs_source_get_name(destination));
+	obs_source_release(destination);
+
+	QMetaObject::invokeMethod(
+		governor, [governor, sceneName]() { governor->preloadScene(sceneName); }, Qt::QueuedConnection);
+}
+
+void SourceGovernor::connectTransition()
+{
+	m_transition = obs_frontend_get_current_transition();
+	if (m_transition) {
+		signal_handler_connect(obs_source_get_signal_handler(m_transition), "transition_start",
+				       onTransitionStart, this);
+	}
+}
+
+void SourceGovernor::disconnectTransition()
+{
+	if (m_transition) {
+		signal_handler_disconnect(obs_source_get_signal_handler(m_transition), "transition_start",
+					  onTransitionStart, this);
+		obs_source_release(m_transition);
+		m_transition = nullptr;
+	}
+}
+
+void SourceGovernor::discover()
+{
+	TRACE_SCOPE("SourceGovernor::discover");
+
+	QHash<QString, obs_source_t *> found;
+	obs_enum_sources(
+		[](void *param, obs_source_t *source) {
+			if (isHolyricsBrowserSource(source)) {
+				auto *found = static_cast<QHash<QString, obs_source_t *> *>(param);
+				found->insert(QString::fromUtf8(obs_source_get_uuid(source)), obs_source_get_ref(source));
+			}
+			return true;
+		},
+		&found);
+
+	// Forget sources that were removed or no longer point at Holyrics
+	for (auto it = m_sources.begin(); it != m_sources.end();) {
+		if (!found.contains(it.key())) {
+			obs_weak_source_release(it->weak);
+			it = m_sources.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	for (auto it = found.constBegin(); it != found.constEnd(); ++it) {
+		obs_source_t *source = it.value();
+		QString name = QString::fromUtf8(obs_source_get_name(source));
+
+		if (m_sources.contains(it.key())) {
+			m_sources[it.key()].name = name;
+			obs_source_release(source);
+			continue;
+		}
+
+		// Keep the user's own settings somewhere that survives a restart
+		obs_data_t *privateSettings = obs_source_get_private_settings(source);
+		obs_data_t *original = obs_data_get_obj(privateSettings, kOriginalSettingsKey);
+		if (!original) {
+			obs_data_t *settings = obs_source_get_settings(source);
+			original = obs_data_create();
+			obs_data_set_bool(original, "fps_custom", obs_data_get_bool(settings, "fps_custom"));
+			obs_data_set_int(original, "fps", obs_data_get_int(settings, "fps"));
+			obs_data_set_bool(original, "shutdown", obs_data_get_bool(settings, "shutdown"));
+			obs_data_set_obj(privateSettings, kOriginalSettingsKey, original);
+			obs_data_release(settings);
+		}
+
+		Tracked tracked;
+		tracked.weak = obs_source_get_weak_source(source);
+		tracked.name = name;
+		tracked.state = StateInUse;
+		tracked.applied = false;
+		tracked.idleSinceMs = m_clock.elapsed();
+		tracked.originalFpsCustom = obs_data_get_bool(original, "fps_custom");
+		tracked.originalFps = static_cast<int>(obs_data_get_int(original, "fps"));
+		tracked.originalShutdown = obs_data_get_bool(original, "shutdown");
+		if (tracked.originalFps <= 0) {
+			tracked.originalFps = kDefaultBrowserFps;
+		}
+
+		obs_data_release(original);
+		obs_data_release(privateSettings);
+		obs_source_release(source);
+
+		m_sources.insert(it.key(), tracked);
+		EventLog::detail("governor", QString("Tracking '%1' (%2 fps, shutdown when hidden: %3)")
+						    .arg(name)
+						    .arg(tracked.originalFps)
+						    .arg(tracked.originalShutdown ? "yes" : "no"));
+	}
+}
+
+void SourceGovernor::evaluate()
+{
+	TRACE_SCOPE("SourceGovernor::evaluate");
+
+	qint64 nowMs = m_clock.elapsed();
+	double elapsedSeconds = m_lastEvaluateMs > 0 ? (nowMs - m_lastEvaluateMs) / 1000.0 : 0.0;
+	m_lastEvaluateMs = nowMs;
+
+	obs_source_t *program = obs_frontend_get_current_scene();
+	obs_source_t *preview = obs_frontend_preview_program_mode_active() ? obs_frontend_get_current_preview_scene()
+									    : nullptr;
+	obs_source_t *upcoming = m_preloadScene.isEmpty()
+					 ? nullptr
+					 : obs_get_source_by_name(m_preloadScene.toUtf8().constData());
+
+	Stats stats{static_cast<int>(m_sources.size()), 0, 0, 0, 0.0, m_stats.totalFramesAvoided, 0};
+
+	// Entering or leaving studio mode changes what idle means
+	bool capIdleFps = obs_frontend_preview_program_mode_active();
+	if (capIdleFps != m_idleFpsCapped) {
+		m_idleFpsCapped = capIdleFps;
+		for (Tracked &tracked : m_sources) {
+			tracked.applied = false;
+		}
+	}
+
+	for (auto it = m_sources.begin(); it != m_sources.end(); ++it) {
+		Tracked &tracked = it.value();
+		obs_source_t *source = obs_weak_source_get_source(tracked.weak);
+		if (!source) {
+			continue;
+		}
+
+		bool inUse = sceneContains(program, tracked.name) || sceneContains(preview, tracked.name) ||
+			     sceneContains(upcoming, tracked.name);
+
+		State state = StateInUse;
+		if (inUse) {
+			tracked.idleSinceMs = nowMs;
+		} else if (nowMs - tracked.idleSinceMs >= m_graceSeconds * 1000LL) {
+			state = StateUnloaded;
+		} else {
+			state = StateIdle;
+		}
+
+		if (!tracked.applied || state != tracked.state) {
+			applyState(source, tracked, state);
+		}
+
+		// Frames the browser would have rendered under the user's own
+		// settings; one that already unloads when hidden saves nothing here
+		double framesAvoided = 0.0;
+		if (state == StateInUse) {
+			stats.inUse++;
+		} else if (tracked.originalShutdown) {
+			// Left alone: the source already unloads whenever it's hidden
+		} else if (state == StateUnloaded && !obs_source_showing(source)) {
+			framesAvoided = tracked.originalFps;
+			stats.estimatedMemorySavedMb += kEstimatedBrowserMemoryMb;
+			stats.unloaded++;
+		} else if (m_idleFpsCapped) {
+			framesAvoided = qMax(0, tracked.originalFps - m_idleFps);
+			stats.idle++;
+		}
+
+		stats.framesAvoidedPerSecond += framesAvoided;
+		stats.totalFramesAvoided += framesAvoided * elapsedSeconds;
+
+		obs_source_release(source);
+	}
+
+	obs_source_release(program);
+	obs_source_release(preview);
+	obs_source_release(upcoming);
+
+	m_stats = stats;
+	emit statsChanged();
+}
+
+void SourceGovernor::applyState(obs_source_t *source, Tracked &tracked, State state)
+{
+	obs_data_t *current = obs_source_get_settings(source);
+
+	bool fpsCustom = tracked.originalFpsCustom;
+	int fps = tracked.originalFps;
+	bool shutdown = tracked.originalShutdown;
+
+	if (state == StateUnloaded) {
+		// The page is gone while hidden, so the frame rate doesn't matter
+		shutdown = true;
+	} else if (state == StateIdle && m_idleFpsCapped && !tracked.originalShutdown) {
+		fpsCustom = true;
+		fps = qMin(m_idleFps, tracked.originalFps);
+	} else if (state == StateInUse && obs_source_showing(source) && obs_data_get_bool(current, "shutdown")) {
+		// Back from unloaded and already loaded again on show; clearing
+		// "shutdown" now would reload it on air. It goes when next idle.
+		shutdown = true;
+	}
+
+	tracked.state = state;
+	tracked.applied = true;
+
+	// Any change to these makes obs-browser rebuild the page, so skip no-ops
+	bool unchanged = obs_data_get_bool(current, "fps_custom") == fpsCustom &&
+			 obs_data_get_int(current, "fps") == fps && obs_data_get_bool(current, "shutdown") == shutdown;
+	obs_data_release(current);
+
+	if (unchanged) {
+		return;
+	}
+
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_bool(settings, "fps_custom", fpsCustom);
+	obs_data_set_int(settings, "fps", fps);
+	obs_data_set_bool(settings, "shutdown", shutdown);
+	obs_source_update(source, settings);
+	obs_data_release(settings);
+
+	static const char *stateNames[] = {"in use", "idle", "unloaded"};
+	EventLog::detail("governor", QString("'%1' -> %2 (%3 fps%4)")
+					     .arg(tracked.name, stateNames[state])
+					     .arg(fps)
+					     .arg(shutdown ? ", unload when hidden" : ""));
+}
+
+void SourceGovernor::releaseAll(bool restore, bool keepShutdownWhileShowing)
+{
+	if (!keepShutdownWhileShowing) {
+		restorePending(true);
+	}
+
+	int pending = 0;
+	for (auto it = m_sources.begin(); it != m_sources.end(); ++it) {
+		Tracked &tracked = it.value();
+		obs_source_t *source = restore ? obs_weak_source_get_source(tracked.weak) : nullptr;
+
+		if (source) {
+			obs_data_t *current = obs_source_get_settings(source);
+			bool fpsMatches = obs_data_get_bool(current, "fps_custom") == tracked.originalFpsCustom &&
+					  obs_data_get_int(current, "fps") == tracked.originalFps;
+			bool shutdownMatches = obs_data_get_bool(current, "shutdown") == tracked.originalShutdown;
+			obs_data_release(current);
+
+			// Clearing "shutdown" on a source that is showing reloads it
+			// on air, so that part waits until it is hidden; the original
+			// stays in the private settings until then
+			bool deferShutdown = keepShutdownWhileShowing && !shutdownMatches && obs_source_showing(source);
+
+			// Any change makes obs-browser rebuild the page, so skip no-ops
+			if (!fpsMatches || (!shutdownMatches && !deferShutdown)) {
+				obs_data_t *settings = obs_data_create();
+				obs_data_set_bool(settings, "fps_custom", tracked.originalFpsCustom);
+				obs_data_set_int(settings, "fps", tracked.originalFps);
+				if (!deferShutdown) {
+					obs_data_set_bool(settings, "shutdown", tracked.originalShutdown);
+				}
+				obs_source_update(source, settings);
+				obs_data_release(settings);
+			}
+
+			if (deferShutdown) {
+				m_pendingShutdown.insert(it.key(), obs_source_get_weak_source(source));
+				pending++;
+			} else {
+				obs_data_t *privateSettings = obs_source_get_private_settings(source);
+				obs_data_erase(privateSettings, kOriginalSettingsKey);
+				obs_data_release(privateSettings);
+			}
+
+			obs_source_release(source);
+		}
+
+		obs_weak_source_release(tracked.weak);
+	}
+
+	if (!m_sources.isEmpty()) {
+		EventLog::info("governor", QString("Released %1 source(s)%2%3")
+						   .arg(m_sources.size())
+						   .arg(restore ? ", original settings restored" : "")
+						   .arg(pending > 0 ? QString(", %1 once hidden").arg(pending) : QString()));
+	}
+
+	m_sources.clear();
+	m_preloadScene.clear();
+	m_lastEvaluateMs = 0;
+	m_stats = Stats{0, 0, 0, 0, 0.0, m_stats.totalFramesAvoided, 0};
+	emit statsChanged();
+}
+
+void SourceGovernor::restorePending(bool now)
+{
+	for (auto it = m_pendingShutdown.begin(); it != m_pendingShutdown.end();) {
+		obs_source_t *source = obs_weak_source_get_source(it.value());
+		if (source && !now && obs_source_showing(source)) {
+			obs_source_release(source);
+			++it;
+			continue;
+		}
+
+		if (source) {
+			obs_data_t *privateSettings = obs_source_get_private_settings(source);
+			obs_data_t *original = obs_data_get_obj(privateSettings, kOriginalSettingsKey);
+			if (original) {
+				obs_data_t *settings = obs_data_create();
+				obs_data_set_bool(settings, "shutdown", obs_data_get_bool(original, "shutdown"));
+				obs_source_update(source, settings);
+				obs_data_release(settings);
+				obs_data_release(original);
+			}
+			obs_data_erase(privateSettings, kOriginalSettingsKey);
+			obs_data_release(privateSettings);
+
+			EventLog::detail("governor", QString("'%1' hidden; original unload setting restored")
+							    .arg(QString::fromUtf8(obs_source_get_name(source))));
+			obs_source_release(source);
+		}
+
+		obs_weak_source_release(it.value());
+		it = m_pendingShutdown.erase(it);
+	}
+}
+
+void SourceGovernor::forgetPending()
+{
+	for (obs_weak_source_t *weak : m_pendingShutdown) {
+		obs_weak_source_release(weak);
+	}
+	m_pendingShutdown.clear();
+}
+
+void SourceGovernor::onTick()
+{
+	// Disabled, the timer only runs to finish releasing sources on air
+	if (!m_enabled) {
+		restorePending(false);
+		if (m_pendingShutdown.isEmpty()) {
+			m_timer.stop();
+		}
+		return;
+	}
+
+	if (++m_tick % kDiscoverEveryTicks == 0) {
+		discover();
+	}
+	evaluate();
+}
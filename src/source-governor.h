@@ -0,0 +1,106 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <obs.h>
+#include <obs-frontend-api.h>
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QTimer>
+
+// Keeps the Holyrics browser sources on a budget. Sources in program or
+// preview (or in the scene a transition is heading to) run as the user set
+// them up; a source idle past the grace period is allowed to unload its
+// browser while hidden. Any fps/shutdown change makes obs-browser rebuild
+// the page, so nothing that could be on air is touched: idle sources are
+// only capped to a low frame rate in studio mode, where they are promoted
+// back while still in preview, and a source that comes back from unloaded
+// keeps "shutdown" until it is hidden again, as does one that is showing
+// when the governor is turned off. "shutdown" is only ever set, never
+// cleared below what the user chose. Off unless enabled from the dialog.
+// The original settings are kept in the source's private settings so they
+// survive restarts and are put back when released.
+class SourceGovernor : public QObject {
+	Q_OBJECT
+
+public:
+	struct Stats {
+		int tracked;
+		int inUse;
+		int idle;
+		int unloaded;
+		double framesAvoidedPerSecond;
+		double totalFramesAvoided;
+		int estimatedMemorySavedMb;
+	};
+
+	explicit SourceGovernor(QObject *parent = nullptr);
+	~SourceGovernor();
+
+	void start();
+	void stop();
+
+	bool isEnabled() const { return m_enabled; }
+	void setEnabled(bool enabled);
+	Stats stats() const { return m_stats; }
+
+	// Promote the sources of a scene before it becomes visible
+	void preloadScene(const QString &sceneName);
+
+signals:
+	void statsChanged();
+
+private:
+	enum State { StateInUse, StateIdle, StateUnloaded };
+
+	struct Tracked {
+		obs_weak_source_t *weak;
+		QString name;
+		State state;
+		bool applied;
+		qint64 idleSinceMs;
+		bool originalFpsCustom;
+		int originalFps;
+		bool originalShutdown;
+	};
+
+	bool m_enabled;
+	bool m_running;
+	int m_idleFps;
+	int m_graceSeconds;
+	int m_tick;
+	bool m_idleFpsCapped;
+	QString m_preloadScene;
+	obs_source_t *m_transition;
+	QHash<QString, Tracked> m_sources;
+	// Released while showing, by uuid; "shutdown" goes back once hidden
+	QHash<QString, obs_weak_source_t *> m_pendingShutdown;
+	QTimer m_timer;
+	QElapsedTimer m_clock;
+	qint64 m_lastEvaluateMs;
+	Stats m_stats;
+
+	static void onFrontendEvent(enum obs_frontend_event event, void *data);
+	static void onTransitionStart(void *data, calldata_t *params);
+
+	void connectTransition();
+	void disconnectTransition();
+	void discover();
+	void evaluate();
+	void applyState(obs_source_t *source, Tracked &tracked, State state);
+	void releaseAll(bool restore, bool keepShutdownWhileShowing = false);
+	// `now` restores the pending ones even if they are showing
+	void restorePending(bool now);
+	void forgetPending();
+	void onTick();
+};
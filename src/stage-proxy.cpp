@@ -0,0 +1,501 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "stage-proxy.h"
+#include "event-log.h"
+#include "holyrics-finder.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUrl>
+
+static const int kMaxHeaderBytes = 64 * 1024;
+static const int kMaxBodyBytes = 1024 * 1024;
+// Long enough for a long-poll to come back on its own
+static const int kUpstreamTimeoutMs = 60000;
+static const qint64 kMaxCacheBytes = 32 * 1024 * 1024;
+static const qint64 kMaxCachedEntryBytes = 4 * 1024 * 1024;
+
+static const char *kPendingKeyProperty = "stageProxyKey";
+
+bool StageProxy::parseRequest(const QByteArray &head, Request &request)
+{
+	QList<QByteArray> lines = head.split('\n');
+	if (lines.isEmpty()) {
+		return false;
+	}
+
+	QList<QByteArray> requestLine = lines[0].trimmed().split(' ');
+	if (requestLine.size() != 3 || !requestLine[1].startsWith('/')) {
+		return false;
+	}
+
+	request.method = requestLine[0];
+	request.target = requestLine[1];
+	request.contentLength = 0;
+	request.upgrade = false;
+
+	for (int i = 1; i < lines.size(); ++i) {
+		QByteArray line = lines[i].trimmed();
+		int colon = line.indexOf(':');
+		if (colon <= 0) {
+			continue;
+		}
+
+		QByteArray name = line.left(colon).trimmed().toLower();
+		QByteArray value = line.mid(colon + 1).trimmed();
+		if (name == "content-length") {
+			request.contentLength = value.toInt();
+		} else if (name == "upgrade") {
+			request.upgrade = true;
+		}
+		request.headers.append(qMakePair(name, value));
+	}
+	return true;
+}
+
+static bool isHopByHop(const QByteArray &name)
+{
+	return name == "connection" || name == "keep-alive" || name == "proxy-authenticate" ||
+	       name == "proxy-authorization" || name == "te" || name == "trailer" || name == "transfer-encoding" ||
+	       name == "upgrade";
+}
+
+// Request headers that can change the answer. A GET only joins one already
+// in flight that sent the same ones, and only answers to GETs without any
+// are cached; credentials also keep a GET away from the cache.
+static bool variesResponse(const QByteArray &name)
+{
+	return name == "if-none-match" || name == "if-modified-since" || name == "if-match" ||
+	       name == "if-unmodified-since" || name == "if-range" || name == "range" || name == "cookie" ||
+	       name == "authorization";
+}
+
+StageProxy::StageProxy(QObject *parent)
+	: QObject(parent),
+	  m_server(nullptr),
+	  m_network(nullptr),
+	  m_port(0),
+	  m_upstreamPort(0),
+	  m_cacheBytes(0),
+	  m_upstreamRequests(0),
+	  m_servedFromCache(0),
+	  m_coalesced(0)
+{
+}
+
+StageProxy::~StageProxy()
+{
+	stop();
+}
+
+bool StageProxy::start(quint16 port)
+{
+	if (isRunning()) {
+		if (port == m_port) {
+			return true;
+		}
+		stop();
+	}
+
+	if (!m_server) {
+		m_server = new QTcpServer(this);
+		connect(m_server, &QTcpServer::newConnection, this, &StageProxy::onNewConnection);
+	}
+	if (!m_network) {
+		m_network = new QNetworkAccessManager(this);
+	}
+
+	// Loopback only: this must never become an open relay on the venue network
+	if (!m_server->listen(QHostAddress::LocalHost, port)) {
+		obs_log(LOG_WARNING, "[StageProxy] Could not listen on 127.0.0.1:%d: %s", port,
+			m_server->errorString().toUtf8().constData());
+		return false;
+	}
+
+	m_port = port;
+	obs_log(LOG_INFO, "[StageProxy] Listening on 127.0.0.1:%d", port);
+	return true;
+}
+
+void StageProxy::stop()
+{
+	if (!isRunning()) {
+		return;
+	}
+
+	m_server->close();
+	abortUpstream();
+
+	const QList<QTcpSocket *> clients = m_clients.keys();
+	for (QTcpSocket *client : clients) {
+		closeClient(client);
+		client->abort();
+	}
+
+	m_cache.clear();
+	m_cacheOrder.clear();
+	m_cacheBytes = 0;
+
+	obs_log(LOG_INFO, "[StageProxy] Stopped: %lld upstream request(s), %lld served from cache, %lld coalesced",
+		static_cast<long long>(m_upstreamRequests), static_cast<long long>(m_servedFromCache),
+		static_cast<long long>(m_coalesced));
+}
+
+bool StageProxy::isRunning() const
+{
+	return m_server && m_server->isListening();
+}
+
+void StageProxy::setUpstream(const QString &ip, int port)
+{
+	if (ip == m_upstreamIp && port == m_upstreamPort) {
+		return;
+	}
+
+	// Nothing fetched from the old host is valid for the new one
+	abortUpstream();
+	m_cache.clear();
+	m_cacheOrder.clear();
+	m_cacheBytes = 0;
+
+	m_upstreamIp = ip;
+	m_upstreamPort = port;
+	EventLog::info("proxy", QString("Forwarding to %1").arg(HolyricsFinder::formatEndpoint(ip, port)));
+}
+
+void StageProxy::onNewConnection()
+{
+	while (m_server->hasPendingConnections()) {
+		QTcpSocket *client = m_server->nextPendingConnection();
+		m_clients.insert(client, Client{QByteArray(), false, nullptr});
+		connect(client, &QTcpSocket::readyRead, this, [this, client]() { onClientData(client); });
+		connect(client, &QTcpSocket::disconnected, this, [this, client]() { closeClient(client); });
+	}
+}
+
+void StageProxy::onClientData(QTcpSocket *client)
+{
+	auto it = m_clients.find(client);
+	if (it == m_clients.end()) {
+		return;
+	}
+
+	if (it->tunnel) {
+		it->tunnel->write(client->readAll());
+		return;
+	}
+	if (it->handled) {
+		// One request per connection; we always answer with Connection: close
+		client->readAll();
+		return;
+	}
+
+	it->buffer += client->readAll();
+	int headerEnd = it->buffer.indexOf("\r\n\r\n");
+	if (headerEnd < 0) {
+		if (it->buffer.size() > kMaxHeaderBytes) {
+			it->handled = true;
+			sendError(client, 431, "Request Header Fields Too Large");
+		}
+		return;
+	}
+
+	QByteArray head = it->buffer.left(headerEnd + 4);
+	Request request;
+	if (!parseRequest(head, request)) {
+		it->handled = true;
+		sendError(client, 400, "Bad Request");
+		return;
+	}
+	if (request.contentLength > kMaxBodyBytes) {
+		it->handled = true;
+		sendError(client, 413, "Payload Too Large");
+		return;
+	}
+	if (!request.upgrade && it->buffer.size() < head.size() + request.contentLength) {
+		return;
+	}
+
+	it->handled = true;
+	QByteArray raw = it->buffer;
+	it->buffer.clear();
+
+	if (request.upgrade) {
+		openTunnel(client, raw);
+	} else {
+		handleRequest(client, request, raw.mid(head.size(), request.contentLength));
+	}
+}
+
+void StageProxy::handleRequest(QTcpSocket *client, const Request &parsed, const QByteArray &body)
+{
+	if (m_upstreamIp.isEmpty()) {
+		sendError(client, 503, "Service Unavailable");
+		return;
+	}
+
+	bool isGet = parsed.method == "GET";
+	QString key = QString::fromUtf8(parsed.method + ' ' + parsed.target);
+
+	QByteArray varying;
+	bool credentials = false;
+	for (const auto &header : parsed.headers) {
+		if (variesResponse(header.first)) {
+			varying += '\n' + header.first + ": " + header.second;
+			credentials = credentials || header.first == "cookie" || header.first == "authorization";
+		}
+	}
+
+	if (isGet) {
+		// A cached full 200 is a valid answer to a conditional or range GET
+		auto cached = credentials ? m_cache.constEnd() : m_cache.constFind(key);
+		if (cached != m_cache.constEnd()) {
+			m_servedFromCache++;
+			sendResponse(client, cached->head, cached->body);
+			return;
+		}
+
+		key += QString::fromUtf8(varying);
+		auto pending = m_pending.find(key);
+		if (pending != m_pending.end()) {
+			m_coalesced++;
+			pending->waiters.append(client);
+			return;
+		}
+	}
+
+	QString path = QString::fromUtf8(parsed.target);
+	QNetworkRequest request{QUrl(HolyricsFinder::buildUrl(m_upstreamIp, m_upstreamPort, path))};
+	request.setTransferTimeout(kUpstreamTimeoutMs);
+	// The browser has to see redirects itself, or relative links resolve wrong
+	request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::ManualRedirectPolicy);
+	for (const auto &header : parsed.headers) {
+		if (!isHopByHop(header.first) && header.first != "host" && header.first != "content-length" &&
+		    header.first != "accept-encoding") {
+			request.setRawHeader(header.first, header.second);
+		}
+	}
+
+	QNetworkReply *reply;
+	if (isGet) {
+		reply = m_network->get(request);
+	} else if (parsed.method == "HEAD") {
+		reply = m_network->head(request);
+	} else {
+		reply = m_network->sendCustomRequest(request, parsed.method, body);
+	}
+	m_upstreamRequests++;
+
+	// Only GETs are shared; anything else is one client's own request
+	if (!isGet) {
+		key += QString("#%1").arg(reinterpret_cast<quintptr>(reply));
+	}
+	reply->setProperty(kPendingKeyProperty, key);
+	connect(reply, &QNetworkReply::finished, this, &StageProxy::onUpstreamFinished);
+
+	bool cacheable = isGet && varying.isEmpty() && isStaticAsset(path);
+	m_pending.insert(key, Pending{reply, {QPointer<QTcpSocket>(client)}, cacheable});
+}
+
+void StageProxy::onUpstreamFinished()
+{
+	QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+	if (!reply) {
+		return;
+	}
+	reply->deleteLater();
+
+	auto it = m_pending.find(reply->property(kPendingKeyProperty).toString());
+	if (it == m_pending.end() || it->reply != reply) {
+		return;
+	}
+	QString key = it.key();
+	Pending pending = it.value();
+	m_pending.erase(it);
+
+	int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+	if (status == 0) {
+		EventLog::detail("proxy", QString("Upstream failed for %1: %2").arg(key, reply->errorString()));
+		for (const QPointer<QTcpSocket> &waiter : pending.waiters) {
+			if (waiter) {
+				sendError(waiter, 502, "Bad Gateway");
+			}
+		}
+		return;
+	}
+
+	QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' +
+			  reply->attribute(QNetworkRequest::HttpReasonPhraseAttribute).toByteArray() + "\r\n";
+	for (const auto &header : reply->rawHeaderPairs()) {
+		QByteArray name = header.first.toLower();
+		// The body was decoded for us and gets a fresh Content-Length
+		if (isHopByHop(name) || name == "content-length" || name == "content-encoding") {
+			continue;
+		}
+		// Qt joins repeated headers (Set-Cookie) with newlines
+		for (const QByteArray &value : header.second.split('\n')) {
+			head += header.first + ": " + (name == "location" ? rewriteLocation(value) : value) + "\r\n";
+		}
+	}
+	QByteArray body = reply->readAll();
+
+	if (pending.cacheable && status == 200) {
+		storeInCache(key, head, body);
+	}
+
+	for (const QPointer<QTcpSocket> &waiter : pending.waiters) {
+		if (waiter) {
+			sendResponse(waiter, head, body);
+		}
+	}
+}
+
+void StageProxy::openTunnel(QTcpSocket *client, const QByteArray &rawRequest)
+{
+	if (m_upstreamIp.isEmpty()) {
+		sendError(client, 503, "Service Unavailable");
+		return;
+	}
+
+	QTcpSocket *upstream = new QTcpSocket(this);
+	m_clients[client].tunnel = upstream;
+
+	QPointer<QTcpSocket> guard(client);
+	connect(upstream, &QTcpSocket::readyRead, this, [upstream, guard]() {
+		if (guard) {
+			guard->write(upstream->readAll());
+		}
+	});
+	// Either side going away ends the tunnel; closeClient() tidies up
+	connect(upstream, &QTcpSocket::disconnected, this, [guard]() {
+		if (guard) {
+			guard->disconnectFromHost();
+		}
+	});
+	connect(upstream, &QTcpSocket::errorOccurred, this, [guard]() {
+		if (guard) {
+			guard->disconnectFromHost();
+		}
+	});
+
+	// Writes made while connecting are sent once the connection is up
+	upstream->connectToHost(m_upstreamIp, quint16(m_upstreamPort));
+	upstream->write(rawRequest);
+}
+
+void StageProxy::closeClient(QTcpSocket *client)
+{
+	auto it = m_clients.find(client);
+	if (it == m_clients.end()) {
+		return;
+	}
+
+	QTcpSocket *tunnel = it->tunnel;
+	m_clients.erase(it);
+
+	if (tunnel) {
+		tunnel->disconnect(this);
+		tunnel->abort();
+		tunnel->deleteLater();
+	}
+	client->disconnect(this);
+	client->deleteLater();
+}
+
+void StageProxy::abortUpstream()
+{
+	const QList<Pending> pending = m_pending.values();
+	m_pending.clear();
+
+	for (const Pending &entry : pending) {
+		entry.reply->disconnect(this);
+		entry.reply->abort();
+		entry.reply->deleteLater();
+		for (const QPointer<QTcpSocket> &waiter : entry.waiters) {
+			if (waiter) {
+				sendError(waiter, 502, "Bad Gateway");
+			}
+		}
+	}
+
+	// Pages reconnect their sockets, and will reach the new upstream
+	QList<QTcpSocket *> tunnelled;
+	for (auto it = m_clients.constBegin(); it != m_clients.constEnd(); ++it) {
+		if (it->tunnel) {
+			tunnelled.append(it.key());
+		}
+	}
+	for (QTcpSocket *client : tunnelled) {
+		client->disconnectFromHost();
+	}
+}
+
+void StageProxy::storeInCache(const QString &key, const QByteArray &head, const QByteArray &body)
+{
+	if (body.size() > kMaxCachedEntryBytes) {
+		return;
+	}
+
+	if (m_cache.contains(key)) {
+		m_cacheBytes -= m_cache.value(key).body.size();
+	}
+	m_cache.insert(key, CachedResponse{head, body});
+	m_cacheOrder.removeOne(key);
+	m_cacheOrder.append(key);
+	m_cacheBytes += body.size();
+
+	// Oldest first; a service only ever touches a few dozen assets
+	while (m_cacheBytes > kMaxCacheBytes && !m_cacheOrder.isEmpty()) {
+		QString oldest = m_cacheOrder.takeFirst();
+		m_cacheBytes -= m_cache.take(oldest).body.size();
+	}
+}
+
+QByteArray StageProxy::rewriteLocation(const QByteArray &location) const
+{
+	QByteArray upstreamBase = HolyricsFinder::buildUrl(m_upstreamIp, m_upstreamPort, QString()).toUtf8();
+	if (!location.startsWith(upstreamBase)) {
+		return location;
+	}
+	return HolyricsFinder::buildUrl(loopbackHost(), m_port, QString()).toUtf8() + location.mid(upstreamBase.size());
+}
+
+bool StageProxy::isStaticAsset(const QString &path)
+{
+	static const char *const kExtensions[] = {".js",  ".css", ".png",   ".jpg", ".jpeg", ".gif", ".svg",
+						  ".ico", ".woff", ".woff2", ".ttf", ".otf",  ".map", ".webp"};
+
+	QString file = path.section('?', 0, 0).toLower();
+	for (const char *extension : kExtensions) {
+		if (file.endsWith(QLatin1String(extension))) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void StageProxy::sendResponse(QTcpSocket *client, const QByteArray &head, const QByteArray &body)
+{
+	client->write(head + "Content-Length: " + QByteArray::number(body.size()) + "\r\nConnection: close\r\n\r\n" +
+		      body);
+	client->disconnectFromHost();
+}
+
+void StageProxy::sendError(QTcpSocket *client, int status, const char *reason)
+{
+	QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reason +
+			  "\r\nContent-Type: text/plain; charset=utf-8\r\nCache-Control: no-store\r\n";
+	sendResponse(client, head, QByteArray(reason));
+}
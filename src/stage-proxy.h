@@ -0,0 +1,107 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+
+class QTcpServer;
+class QTcpSocket;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Loopback HTTP reverse proxy in front of one Holyrics endpoint. Browser
+// sources and docks load http://127.0.0.1:<port>/stage-view/... and the
+// proxy forwards to Holyrics over a shared, kept-alive connection pool.
+// Identical GETs in flight at the same time (same target, same
+// conditional, range and credential headers) are sent upstream once and
+// the answer is fanned out to every waiting client; static assets are
+// kept in memory. WebSocket upgrades are tunnelled through as-is. Moving
+// to another Holyrics PC is a setUpstream() call, not a URL rewrite.
+class StageProxy : public QObject {
+	Q_OBJECT
+
+public:
+	explicit StageProxy(QObject *parent = nullptr);
+	~StageProxy();
+
+	bool start(quint16 port);
+	void stop();
+	bool isRunning() const;
+	quint16 port() const { return m_port; }
+
+	void setUpstream(const QString &ip, int port);
+	QString upstreamIp() const { return m_upstreamIp; }
+	int upstreamPort() const { return m_upstreamPort; }
+
+	static const char *loopbackHost() { return "127.0.0.1"; }
+
+private slots:
+	void onNewConnection();
+	void onUpstreamFinished();
+
+private:
+	struct Request {
+		QByteArray method;
+		QByteArray target;
+		QList<QPair<QByteArray, QByteArray>> headers;
+		int contentLength;
+		bool upgrade;
+	};
+
+	struct Client {
+		QByteArray buffer;
+		bool handled;
+		QTcpSocket *tunnel;
+	};
+
+	struct Pending {
+		QNetworkReply *reply;
+		QList<QPointer<QTcpSocket>> waiters;
+		bool cacheable;
+	};
+
+	struct CachedResponse {
+		QByteArray head;
+		QByteArray body;
+	};
+
+	QTcpServer *m_server;
+	QNetworkAccessManager *m_network;
+	quint16 m_port;
+	QString m_upstreamIp;
+	int m_upstreamPort;
+	QHash<QTcpSocket *, Client> m_clients;
+	QHash<QString, Pending> m_pending;
+	QHash<QString, CachedResponse> m_cache;
+	QList<QString> m_cacheOrder;
+	qint64 m_cacheBytes;
+	qint64 m_upstreamRequests;
+	qint64 m_servedFromCache;
+	qint64 m_coalesced;
+
+	void onClientData(QTcpSocket *client);
+	void handleRequest(QTcpSocket *client, const Request &request, const QByteArray &body);
+	void openTunnel(QTcpSocket *client, const QByteArray &rawRequest);
+	void closeClient(QTcpSocket *client);
+	void abortUpstream();
+	void storeInCache(const QString &key, const QByteArray &head, const QByteArray &body);
+	QByteArray rewriteLocation(const QByteArray &location) const;
+
+	static bool parseRequest(const QByteArray &head, Request &request);
+	static bool isStaticAsset(const QString &path);
+	static void sendResponse(QTcpSocket *client, const QByteArray &head, const QByteArray &body);
+	static void sendError(QTcpSocket *client, int status, const char *reason);
+};
@@ -0,0 +1,264 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "subnet-scanner.h"
+#include "event-log.h"
+#include "holyrics-finder.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <QTcpSocket>
+
+static const int kMaxResponseBytes = 16384;
+static const int kDeadlineTickMs = 10;
+// Budget charged per probe: SYN, ACK, request, FIN and the peer's side,
+// plus headers and the request itself. Reply bytes are charged up front
+// at the cap and the unread part refunded.
+static const int kProbePackets = 6;
+static const int kProbeOverheadBytes = 600;
+// Buckets hold a quarter second of budget so launches stay spread out
+static const double kBurstSeconds = 0.25;
+
+SubnetScanner::SubnetScanner(const QString &interfaceName, const QHostAddress &localAddress,
+			     const ScanTargets &targets, int port, int maxInFlight, QObject *parent)
+	: QObject(parent),
+	  m_interfaceName(interfaceName),
+	  m_localAddress(localAddress),
+	  m_targets(targets),
+	  m_total(targets.size()),
+	  m_port(port),
+	  m_maxInFlight(qMax(1, maxInFlight)),
+	  m_patientTargets(0),
+	  m_launched(0),
+	  m_completed(0),
+	  m_stopped(false),
+	  m_finished(false),
+	  m_paced(false),
+	  m_maxResponseBytes(kMaxResponseBytes)
+{
+	m_clock.start();
+
+	m_deadlineTimer.setInterval(kDeadlineTickMs);
+	connect(&m_deadlineTimer, &QTimer::timeout, this, &SubnetScanner::expireProbes);
+
+	m_paceTimer.setSingleShot(true);
+	connect(&m_paceTimer, &QTimer::timeout, this, &SubnetScanner::launchNext);
+}
+
+void SubnetScanner::setPacing(double packetsPerSecond, double bytesPerSecond, int maxResponseBytes)
+{
+	m_paced = packetsPerSecond > 0.0 && bytesPerSecond > 0.0;
+	if (!m_paced) {
+		m_maxResponseBytes = kMaxResponseBytes;
+		m_paceTimer.stop();
+		if (!m_stopped && m_deadlineTimer.isActive()) {
+			launchNext();
+		}
+		return;
+	}
+
+	m_maxResponseBytes = qBound(512, maxResponseBytes, kMaxResponseBytes);
+	double probeBytes = kProbeOverheadBytes + m_maxResponseBytes;
+
+	// Never smaller than one probe, or the bucket could never pay for it
+	qint64 now = m_clock.nsecsElapsed();
+	m_packets.configure(packetsPerSecond, qMax(double(kProbePackets), packetsPerSecond * kBurstSeconds), now);
+	m_bytes.configure(bytesPerSecond, qMax(probeBytes, bytesPerSecond * kBurstSeconds), now);
+}
+
+bool SubnetScanner::takeLaunchBudget(int &reservedBytes)
+{
+	reservedBytes = 0;
+	if (!m_paced) {
+		return true;
+	}
+
+	qint64 now = m_clock.nsecsElapsed();
+	int probeBytes = kProbeOverheadBytes + m_maxResponseBytes;
+	qint64 waitNs = qMax(m_packets.nsUntil(kProbePackets, now), m_bytes.nsUntil(probeBytes, now));
+	if (waitNs > 0) {
+		if (!m_paceTimer.isActive()) {
+			m_paceTimer.start(int(qMax<qint64>(1, (waitNs + 999999) / 1000000)));
+		}
+		return false;
+	}
+
+	m_packets.tryTake(kProbePackets, now);
+	m_bytes.tryTake(probeBytes, now);
+	reservedBytes = probeBytes;
+	return true;
+}
+
+SubnetScanner::~SubnetScanner()
+{
+	stop();
+}
+
+void SubnetScanner::start()
+{
+	QString from = m_localAddress.isNull() ? QString("default route") : m_localAddress.toString();
+	EventLog::info("scan", QString("%1: scanning %2 host(s) from %3, %4 in flight, connect timeout %5 ms")
+				       .arg(m_interfaceName)
+				       .arg(m_total)
+				       .arg(from)
+				       .arg(m_maxInFlight)
+				       .arg(m_rtt.connectTimeoutMs()));
+
+	m_deadlineTimer.start();
+	launchNext();
+}
+
+void SubnetScanner::stop()
+{
+	m_stopped = true;
+	m_deadlineTimer.stop();
+	m_paceTimer.stop();
+
+	const QList<QTcpSocket *> sockets = m_probes.keys();
+	m_probes.clear();
+
+	for (QTcpSocket *socket : sockets) {
+		socket->disconnect(this);
+		socket->abort();
+		socket->deleteLater();
+	}
+}
+
+void SubnetScanner::launchNext()
+{
+	while (!m_stopped && m_probes.size() < m_maxInFlight && m_launched < m_total) {
+		int reservedBytes = 0;
+		Endpoint target;
+		if (!takeLaunchBudget(reservedBytes) || !m_targets.next(target)) {
+			break;
+		}
+		bool patient = m_launched < m_patientTargets;
+		m_launched++;
+		launchProbe(target, patient, reservedBytes);
+	}
+
+	if (!m_stopped && !m_finished && m_probes.isEmpty() && m_launched >= m_total) {
+		m_finished = true;
+		m_deadlineTimer.stop();
+
+		EventLog::info("scan", QString("%1: done, SRTT %2 ms, RTTVAR %3 ms over %4 sample(s)")
+					       .arg(m_interfaceName)
+					       .arg(m_rtt.smoothedRttMs(), 0, 'f', 1)
+					       .arg(m_rtt.rttVarianceMs(), 0, 'f', 1)
+					       .arg(m_rtt.sampleCount()));
+
+		emit finished(m_interfaceName);
+	}
+}
+
+void SubnetScanner::launchProbe(const Endpoint &target, bool patient, int reservedBytes)
+{
+	QTcpSocket *socket = new QTcpSocket(this);
+	m_probes.insert(socket, {target, m_clock.nsecsElapsed(), 0, patient, QByteArray(), reservedBytes});
+
+	connect(socket, &QTcpSocket::connected, this, [this, socket]() {
+		auto it = m_probes.find(socket);
+		if (it == m_probes.end()) {
+			return;
+		}
+		it->connectedNs = m_clock.nsecsElapsed();
+		// The TCP handshake is one clean round trip
+		m_rtt.addSample((it->connectedNs - it->startNs) / 1e6);
+
+		QByteArray host = HolyricsFinder::formatHost(it->target.ip()).toUtf8();
+		socket->write("GET / HTTP/1.0\r\nHost: " + host + "\r\nConnection: close\r\n\r\n");
+	});
+	connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+		auto it = m_probes.find(socket);
+		if (it == m_probes.end()) {
+			return;
+		}
+		it->response += socket->read(m_maxResponseBytes - it->response.size());
+		if (HolyricsFinder::isHolyricsResponse(it->response) ||
+		    it->response.size() >= m_maxResponseBytes) {
+			completeProbe(socket);
+		}
+	});
+	connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { completeProbe(socket); });
+	connect(socket, &QTcpSocket::errorOccurred, this, [this, socket](QAbstractSocket::SocketError error) {
+		auto it = m_probes.find(socket);
+		if (it != m_probes.end() && error == QAbstractSocket::ConnectionRefusedError) {
+			// A RST from a live host without a web server is still an RTT sample
+			m_rtt.addSample((m_clock.nsecsElapsed() - it->startNs) / 1e6);
+		}
+		completeProbe(socket);
+	});
+
+	// Binding the source address pins the probe to this interface on
+	// strong-host stacks (Windows) and selects the connected route on Linux.
+	if (!m_localAddress.isNull() && !socket->bind(m_localAddress, 0)) {
+		obs_log(LOG_DEBUG, "[SubnetScanner] %s: bind to %s failed",
+			m_interfaceName.toUtf8().constData(), m_localAddress.toString().toUtf8().constData());
+	}
+	socket->connectToHost(target.address(), quint16(m_port));
+}
+
+void SubnetScanner::expireProbes()
+{
+	qint64 now = m_clock.nsecsElapsed();
+	qint64 connectDeadlineNs = qint64(m_rtt.connectTimeoutMs()) * 1000000;
+	qint64 readDeadlineNs = qint64(m_rtt.readTimeoutMs()) * 1000000;
+	qint64 ceilingNs = qint64(RttEstimator::kCeilingMs) * 1000000;
+
+	QList<QTcpSocket *> expired;
+	for (auto it = m_probes.constBegin(); it != m_probes.constEnd(); ++it) {
+		const Probe &probe = it.value();
+		bool overdue;
+		if (probe.patient) {
+			overdue = now - probe.startNs > ceilingNs;
+		} else if (probe.connectedNs) {
+			overdue = now - probe.connectedNs > readDeadlineNs;
+		} else {
+			overdue = now - probe.startNs > connectDeadlineNs;
+		}
+		if (overdue) {
+			expired.append(it.key());
+		}
+	}
+
+	for (QTcpSocket *socket : expired) {
+		completeProbe(socket);
+	}
+}
+
+void SubnetScanner::completeProbe(QTcpSocket *socket)
+{
+	auto it = m_probes.find(socket);
+	if (it == m_probes.end()) {
+		return;
+	}
+
+	Probe probe = it.value();
+	m_probes.erase(it);
+
+	socket->disconnect(this);
+	socket->abort();
+	socket->deleteLater();
+
+	if (probe.reservedBytes) {
+		m_bytes.refund(probe.reservedBytes - kProbeOverheadBytes - probe.response.size());
+	}
+
+	m_completed++;
+	emit progress(m_interfaceName, m_completed, m_total);
+
+	if (HolyricsFinder::isHolyricsResponse(probe.response)) {
+		qint64 endNs = probe.connectedNs ? probe.connectedNs : m_clock.nsecsElapsed();
+		emit found(m_interfaceName, probe.target.ip(), m_port, (endNs - probe.startNs) / 1e6);
+	}
+
+	if (!m_stopped) {
+		launchNext();
+	}
+}
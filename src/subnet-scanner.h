@@ -0,0 +1,100 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "endpoint.h"
+#include "rtt-estimator.h"
+#include "scan-targets.h"
+#include "token-bucket.h"
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QTimer>
+
+class QTcpSocket;
+
+// Sweeps a set of targets over raw sockets, optionally bound to one
+// local address so the probes leave through that interface instead of
+// whatever the routing table picks. Each scanner has its own in-flight
+// budget and RTT estimate; connect and read deadlines are re-derived
+// from the estimate as responses come in.
+class SubnetScanner : public QObject {
+	Q_OBJECT
+
+public:
+	SubnetScanner(const QString &interfaceName, const QHostAddress &localAddress,
+		      const ScanTargets &targets, int port, int maxInFlight, QObject *parent = nullptr);
+	~SubnetScanner();
+
+	void start();
+	void stop();
+
+	// The first `count` targets (history hosts) always get the full ceiling
+	void setPatientTargets(int count) { m_patientTargets = count; }
+	void seedRtt(double smoothedRttMs, double rttVarianceMs) { m_rtt.seed(smoothedRttMs, rttVarianceMs); }
+	const RttEstimator &rtt() const { return m_rtt; }
+
+	// Holds launches to a packet and byte budget and trims how much of
+	// each reply is read; a rate of zero turns pacing off
+	void setPacing(double packetsPerSecond, double bytesPerSecond, int maxResponseBytes);
+	bool isPaced() const { return m_paced; }
+
+	QString interfaceName() const { return m_interfaceName; }
+	QHostAddress localAddress() const { return m_localAddress; }
+	int total() const { return m_total; }
+	int completed() const { return m_completed; }
+	bool isFinished() const { return m_finished; }
+
+signals:
+	void progress(const QString &interfaceName, int current, int total);
+	void found(const QString &interfaceName, const QString &ip, int port, double rttMs);
+	void finished(const QString &interfaceName);
+
+private:
+	struct Probe {
+		Endpoint target;
+		qint64 startNs;
+		qint64 connectedNs;
+		bool patient;
+		QByteArray response;
+		int reservedBytes;
+	};
+
+	QString m_interfaceName;
+	QHostAddress m_localAddress;
+	ScanTargets m_targets;
+	int m_total;
+	int m_port;
+	int m_maxInFlight;
+	int m_patientTargets;
+	int m_launched;
+	int m_completed;
+	bool m_stopped;
+	bool m_finished;
+	QElapsedTimer m_clock;
+	QTimer m_deadlineTimer;
+	QTimer m_paceTimer;
+	bool m_paced;
+	int m_maxResponseBytes;
+	TokenBucket m_packets;
+	TokenBucket m_bytes;
+	RttEstimator m_rtt;
+	QHash<QTcpSocket *, Probe> m_probes;
+
+	void launchNext();
+	bool takeLaunchBudget(int &reservedBytes);
+	void launchProbe(const Endpoint &target, bool patient, int reservedBytes);
+	void completeProbe(QTcpSocket *socket);
+	void expireProbes();
+};
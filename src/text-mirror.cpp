@@ -0,0 +1,391 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "text-mirror.h"
+#include "event-log.h"
+#include "holyrics-finder.h"
+#include "trace.h"
+#include <obs-module.h>
+#include <obs-frontend-api.h>
+#include <plugin-support.h>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSettings>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QTextDocument>
+#include <QRegularExpression>
+#include <QColor>
+#include <QHash>
+#include <QUrl>
+
+// Lyrics change every few seconds at most; "textMirror/pollIntervalMs"
+// trades Holyrics load for latency within these bounds
+static const int kPollIntervalMs = 1000;
+static const int kMinPollIntervalMs = 250;
+static const int kMaxPollIntervalMs = 5000;
+static const int kRequestTimeoutMs = 2000;
+
+#ifdef _WIN32
+static const char *kTextSourceType = "text_gdiplus";
+#else
+static const char *kTextSourceType = "text_ft2_source";
+#endif
+
+// OBS packs text colors as 0xAABBGGRR
+static long long toObsColor(const QString &name)
+{
+	QColor color(name);
+	if (!color.isValid()) {
+		color = Qt::white;
+	}
+	return 0xFF000000LL | (color.blue() << 16) | (color.green() << 8) | color.red();
+}
+
+static QString findTextValue(const QJsonValue &value)
+{
+	if (value.isObject()) {
+		QJsonObject object = value.toObject();
+		if (object.value("text").isString()) {
+			return object.value("text").toString();
+		}
+		for (auto it = object.constBegin(); it != object.constEnd(); ++it) {
+			QString text = findTextValue(it.value());
+			if (!text.isNull()) {
+				return text;
+			}
+		}
+	} else if (value.isArray()) {
+		for (const QJsonValue &item : value.toArray()) {
+			QString text = findTextValue(item);
+			if (!text.isNull()) {
+				return text;
+			}
+		}
+	}
+	return QString();
+}
+
+TextMirror::TextMirror(QObject *parent)
+	: QObject(parent),
+	  m_network(nullptr),
+	  m_reply(nullptr),
+	  m_running(false),
+	  m_pollIntervalMs(kPollIntervalMs),
+	  m_lastBodyHash(0),
+	  m_failures(0),
+	  m_target(nullptr)
+{
+	m_pollTimer.setSingleShot(true);
+	connect(&m_pollTimer, &QTimer::timeout, this, &TextMirror::poll);
+}
+
+TextMirror::~TextMirror()
+{
+	halt();
+	obs_weak_source_release(m_target);
+}
+
+QString TextMirror::nativeSourceName()
+{
+	return QStringLiteral("Holyrics - Text (Native)");
+}
+
+TextMirror::Style TextMirror::style() const
+{
+	QSettings settings("OBS", "HolyricsFinder");
+	Style style;
+	style.fontFace = settings.value("textMirror/fontFace", "Arial").toString();
+	style.fontSize = settings.value("textMirror/fontSize", 72).toInt();
+	style.color = settings.value("textMirror/color", "#ffffff").toString();
+	style.outline = settings.value("textMirror/outline", true).toBool();
+	style.dropShadow = settings.value("textMirror/dropShadow", false).toBool();
+	return style;
+}
+
+void TextMirror::setStyle(const Style &style)
+{
+	QSettings settings("OBS", "HolyricsFinder");
+	settings.setValue("textMirror/fontFace", style.fontFace);
+	settings.setValue("textMirror/fontSize", style.fontSize);
+	settings.setValue("textMirror/color", style.color);
+	settings.setValue("textMirror/outline", style.outline);
+	settings.setValue("textMirror/dropShadow", style.dropShadow);
+
+	obs_source_t *source = obs_weak_source_get_source(m_target);
+	if (source) {
+		obs_data_t *data = obs_data_create();
+		applyStyle(data);
+		obs_source_update(source, data);
+		obs_data_release(data);
+		obs_source_release(source);
+	}
+}
+
+void TextMirror::applyStyle(obs_data_t *settings) const
+{
+	Style current = style();
+
+	obs_data_t *font = obs_data_create();
+	obs_data_set_string(font, "face", current.fontFace.toUtf8().constData());
+	obs_data_set_int(font, "size", current.fontSize);
+	obs_data_set_string(font, "style", "Regular");
+	obs_data_set_int(font, "flags", 0);
+	obs_data_set_obj(settings, "font", font);
+	obs_data_release(font);
+
+	// FreeType uses a two-stop gradient, GDI+ a single color; each ignores the other's keys
+	long long color = toObsColor(current.color);
+	obs_data_set_int(settings, "color1", color);
+	obs_data_set_int(settings, "color2", color);
+	obs_data_set_int(settings, "color", color);
+	obs_data_set_bool(settings, "outline", current.outline);
+	obs_data_set_bool(settings, "drop_shadow", current.dropShadow);
+	obs_data_set_string(settings, "align", "center");
+}
+
+obs_source_t *TextMirror::ensureTextSource()
+{
+	obs_source_t *source = obs_weak_source_get_source(m_target);
+	if (source) {
+		return source;
+	}
+
+	QByteArray name = nativeSourceName().toUtf8();
+	source = obs_get_source_by_name(name.constData());
+
+	if (!source) {
+		const char *typeId = obs_get_latest_input_type_id(kTextSourceType);
+		if (!typeId) {
+			obs_log(LOG_WARNING, "[TextMirror] Text source type '%s' is not available", kTextSourceType);
+			return nullptr;
+		}
+
+		obs_data_t *settings = obs_data_create();
+		applyStyle(settings);
+		obs_data_set_string(settings, "text", "");
+		source = obs_source_create(typeId, name.constData(), settings, nullptr);
+		obs_data_release(settings);
+
+		if (!source) {
+			obs_log(LOG_ERROR, "[TextMirror] Failed to create text source: %s", name.constData());
+			return nullptr;
+		}
+
+		obs_source_t *sceneSource = obs_frontend_get_current_scene();
+		obs_scene_t *scene = sceneSource ? obs_scene_from_source(sceneSource) : nullptr;
+		if (scene) {
+			obs_scene_add(scene, source);
+		}
+		obs_source_release(sceneSource);
+
+		EventLog::info("mirror", QString("Created %1 source: %2").arg(typeId, QString::fromUtf8(name)));
+	}
+
+	obs_weak_source_release(m_target);
+	m_target = obs_source_get_weak_source(source);
+	return source;
+}
+
+bool TextMirror::start(const QString &ip, int port)
+{
+	halt();
+
+	obs_source_t *source = ensureTextSource();
+	if (!source) {
+		return false;
+	}
+	obs_source_release(source);
+
+	QSettings settings("OBS", "HolyricsFinder");
+	// The JSON feed the stage view page itself polls, not the page
+	QString contentPath = settings.value("textMirror/contentPath", "/stage-view/text.json").toString();
+	m_pollIntervalMs = qBound(kMinPollIntervalMs, settings.value("textMirror/pollIntervalMs", kPollIntervalMs).toInt(),
+				  kMaxPollIntervalMs);
+
+	m_url = HolyricsFinder::buildUrl(ip, port, contentPath);
+	m_etag.clear();
+	m_lastModified.clear();
+	m_lastBodyHash = 0;
+	m_lastText.clear();
+	m_failures = 0;
+	m_running = true;
+
+	settings.setValue("textMirror/enabled", true);
+	settings.setValue("textMirror/endpoint", HolyricsFinder::formatEndpoint(ip, port));
+
+	EventLog::info("mirror", QString("Mirroring %1 into '%2'").arg(m_url, nativeSourceName()));
+
+	poll();
+	return true;
+}
+
+void TextMirror::stop()
+{
+	if (!m_running) {
+		return;
+	}
+
+	halt();
+	QSettings("OBS", "HolyricsFinder").setValue("textMirror/enabled", false);
+	EventLog::info("mirror", "Stopped");
+}
+
+void TextMirror::halt()
+{
+	m_running = false;
+	m_pollTimer.stop();
+
+	if (m_reply) {
+		QNetworkReply *reply = m_reply;
+		m_reply = nullptr;
+		reply->abort();
+		reply->deleteLater();
+	}
+}
+
+void TextMirror::restore()
+{
+	QSettings settings("OBS", "HolyricsFinder");
+	if (!settings.value("textMirror/enabled", false).toBool()) {
+		return;
+	}
+
+	HolyricsFinder::ConnectionInfo endpoint;
+	if (HolyricsFinder::parseEndpoint(settings.value("textMirror/endpoint").toString(), endpoint)) {
+		start(endpoint.ip, endpoint.port);
+	}
+}
+
+void TextMirror::poll()
+{
+	if (!m_running || m_reply) {
+		return;
+	}
+
+	if (!m_network) {
+		m_network = new QNetworkAccessManager(this);
+	}
+
+	QNetworkRequest request{QUrl(m_url)};
+	request.setTransferTimeout(kRequestTimeoutMs);
+	if (!m_etag.isEmpty()) {
+		request.setRawHeader("If-None-Match", m_etag);
+	}
+	if (!m_lastModified.isEmpty()) {
+		request.setRawHeader("If-Modified-Since", m_lastModified);
+	}
+
+	m_reply = m_network->get(request);
+	connect(m_reply, &QNetworkReply::finished, this, &TextMirror::onReply);
+}
+
+void TextMirror::onReply()
+{
+	TRACE_SCOPE("TextMirror::onReply");
+
+	QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+	if (!reply || reply != m_reply) {
+		if (reply) {
+			reply->deleteLater();
+		}
+		return;
+	}
+	m_reply = nullptr;
+	reply->deleteLater();
+
+	int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+	if (reply->error() != QNetworkReply::NoError && status != 304) {
+		if (m_failures++ == 0) {
+			obs_log(LOG_WARNING, "[TextMirror] %s: %s", m_url.toUtf8().constData(),
+				reply->errorString().toUtf8().constData());
+		}
+	} else {
+		if (m_failures > 0) {
+			EventLog::info("mirror", QString("%1 reachable again after %2 failed poll(s)")
+							 .arg(m_url)
+							 .arg(m_failures));
+			m_failures = 0;
+		}
+
+		if (status != 304) {
+			if (reply->hasRawHeader("ETag")) {
+				m_etag = reply->rawHeader("ETag");
+			}
+			if (reply->hasRawHeader("Last-Modified")) {
+				m_lastModified = reply->rawHeader("Last-Modified");
+			}
+
+			// Servers that ignore the validators still get a cheap no-change check
+			QByteArray body = reply->readAll();
+			size_t bodyHash = qHash(body);
+			if (bodyHash != m_lastBodyHash) {
+				m_lastBodyHash = bodyHash;
+				pushText(extractText(body));
+			}
+		}
+	}
+
+	if (m_running) {
+		// Back off while Holyrics is unreachable so a closed laptop doesn't cost anything
+		int interval = qMin(kMaxPollIntervalMs, m_pollIntervalMs << qMin(m_failures, 5));
+		m_pollTimer.start(interval);
+	}
+}
+
+void TextMirror::pushText(const QString &text)
+{
+	if (text == m_lastText) {
+		return;
+	}
+	m_lastText = text;
+
+	obs_source_t *source = obs_weak_source_get_source(m_target);
+	if (!source) {
+		return;
+	}
+
+	obs_data_t *settings = obs_data_create();
+	obs_data_set_string(settings, "text", text.toUtf8().constData());
+	obs_source_update(source, settings);
+	obs_data_release(settings);
+	obs_source_release(source);
+
+	emit textChanged(text);
+}
+
+QString TextMirror::extractText(const QByteArray &body)
+{
+	QJsonParseError error;
+	QJsonDocument json = QJsonDocument::fromJson(body, &error);
+	if (error.error == QJsonParseError::NoError) {
+		QString text = json.isObject() ? findTextValue(json.object()) : findTextValue(json.array());
+		if (!text.isNull()) {
+			return text.trimmed();
+		}
+	}
+
+	static const QRegularExpression hiddenBlocks("<(script|style)[^>]*>.*?</\\1>",
+						     QRegularExpression::CaseInsensitiveOption |
+							     QRegularExpression::DotMatchesEverythingOption);
+	static const QRegularExpression blankLines("\\n\\s*\\n+");
+
+	QString html = QString::fromUtf8(body);
+	html.remove(hiddenBlocks);
+
+	QTextDocument document;
+	document.setHtml(html);
+	QString text = document.toPlainText();
+	text.replace(blankLines, "\n");
+	return text.trimmed();
+}
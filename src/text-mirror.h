@@ -0,0 +1,77 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <obs.h>
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QTimer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// Polls the Holyrics text feed with conditional GETs and mirrors the
+// current lyric into a native OBS text source, so an overlay doesn't need
+// a whole browser. The source is only touched when the text changes.
+class TextMirror : public QObject {
+	Q_OBJECT
+
+public:
+	struct Style {
+		QString fontFace;
+		int fontSize;
+		QString color;
+		bool outline;
+		bool dropShadow;
+	};
+
+	explicit TextMirror(QObject *parent = nullptr);
+	~TextMirror();
+
+	bool start(const QString &ip, int port);
+	void stop();
+	// Resume the mirror saved by the last session, if any
+	void restore();
+	bool isRunning() const { return m_running; }
+
+	Style style() const;
+	void setStyle(const Style &style);
+
+	static QString nativeSourceName();
+	static QString extractText(const QByteArray &body);
+
+signals:
+	void textChanged(const QString &text);
+
+private slots:
+	void onReply();
+
+private:
+	QNetworkAccessManager *m_network;
+	QNetworkReply *m_reply;
+	QTimer m_pollTimer;
+	bool m_running;
+	int m_pollIntervalMs;
+	QString m_url;
+	QByteArray m_etag;
+	QByteArray m_lastModified;
+	size_t m_lastBodyHash;
+	QString m_lastText;
+	int m_failures;
+	obs_weak_source_t *m_target;
+
+	obs_source_t *ensureTextSource();
+	void applyStyle(obs_data_t *settings) const;
+	void pushText(const QString &text);
+	void halt();
+	void poll();
+};
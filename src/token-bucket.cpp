@@ -0,0 +1,59 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "token-bucket.h"
+#include <cmath>
+
+TokenBucket::TokenBucket() : m_rate(0.0), m_burst(0.0), m_tokens(0.0), m_lastNs(0) {}
+
+void TokenBucket::configure(double rate, double burst, qint64 nowNs)
+{
+	refill(nowNs);
+	m_rate = qMax(0.0, rate);
+	m_burst = qMax(0.0, burst);
+	// A fresh bucket starts full; a reconfigured one keeps what it had
+	m_tokens = m_lastNs ? qMin(m_tokens, m_burst) : m_burst;
+	m_lastNs = nowNs;
+}
+
+void TokenBucket::refill(qint64 nowNs)
+{
+	if (m_lastNs && nowNs > m_lastNs) {
+		m_tokens = qMin(m_burst, m_tokens + m_rate * double(nowNs - m_lastNs) / 1e9);
+	}
+	m_lastNs = nowNs;
+}
+
+bool TokenBucket::tryTake(double amount, qint64 nowNs)
+{
+	refill(nowNs);
+	if (m_tokens < amount) {
+		return false;
+	}
+	m_tokens -= amount;
+	return true;
+}
+
+void TokenBucket::refund(double amount)
+{
+	m_tokens = qMin(m_burst, m_tokens + qMax(0.0, amount));
+}
+
+qint64 TokenBucket::nsUntil(double amount, qint64 nowNs)
+{
+	refill(nowNs);
+	if (m_tokens >= amount) {
+		return 0;
+	}
+	if (m_rate <= 0.0) {
+		return qint64(1e9);
+	}
+	return qint64(std::ceil((amount - m_tokens) / m_rate * 1e9));
+}
@@ -0,0 +1,38 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QtGlobal>
+
+// Classic token bucket: refills at `rate` tokens per second up to `burst`.
+// Time is passed in so callers can share one monotonic clock.
+class TokenBucket {
+public:
+	TokenBucket();
+
+	void configure(double rate, double burst, qint64 nowNs);
+
+	bool tryTake(double amount, qint64 nowNs);
+	// Gives back part of an earlier take that turned out not to be used
+	void refund(double amount);
+	// How long until `amount` tokens are available (0 if they are now)
+	qint64 nsUntil(double amount, qint64 nowNs);
+
+	double rate() const { return m_rate; }
+
+private:
+	double m_rate;
+	double m_burst;
+	double m_tokens;
+	qint64 m_lastNs;
+
+	void refill(qint64 nowNs);
+};
@@ -0,0 +1,124 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "trace.h"
+#include <obs-module.h>
+#include <plugin-support.h>
+#include <util/platform.h>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSettings>
+#include <atomic>
+#include <mutex>
+
+namespace Trace {
+
+static const int kCapacity = 8192;
+
+struct Event {
+	const char *name;
+	uint64_t startNs;
+	uint64_t durationNs;
+	int threadId;
+};
+
+static std::atomic<bool> s_enabled{false};
+static std::mutex s_mutex;
+static Event s_ring[kCapacity];
+static int s_next = 0;
+static int s_count = 0;
+static std::atomic<int> s_nextThreadId{1};
+
+// Small stable ids read better in the trace viewer than native handles
+static int currentThreadId()
+{
+	thread_local int id = s_nextThreadId.fetch_add(1);
+	return id;
+}
+
+bool isEnabled()
+{
+	return s_enabled.load(std::memory_order_relaxed);
+}
+
+void setEnabled(bool enabled)
+{
+	s_enabled.store(enabled, std::memory_order_relaxed);
+	QSettings("OBS", "HolyricsFinder").setValue("trace/enabled", enabled);
+	obs_log(LOG_INFO, "[Trace] Recording %s", enabled ? "enabled" : "disabled");
+}
+
+void restore()
+{
+	if (QSettings("OBS", "HolyricsFinder").value("trace/enabled", false).toBool()) {
+		s_enabled.store(true, std::memory_order_relaxed);
+		obs_log(LOG_INFO, "[Trace] Recording enabled");
+	}
+}
+
+static void record(const char *name, uint64_t startNs, uint64_t durationNs)
+{
+	Event event{name, startNs, durationNs, currentThreadId()};
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_ring[s_next] = event;
+	s_next = (s_next + 1) % kCapacity;
+	s_count = qMin(s_count + 1, kCapacity);
+}
+
+int dump(const QString &path)
+{
+	QJsonArray events;
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		int first = (s_next - s_count + kCapacity) % kCapacity;
+		for (int i = 0; i < s_count; ++i) {
+			const Event &event = s_ring[(first + i) % kCapacity];
+			QJsonObject object;
+			object["name"] = QString::fromUtf8(event.name);
+			object["cat"] = "holyrics";
+			object["ph"] = "X";
+			object["ts"] = event.startNs / 1000.0;
+			object["dur"] = event.durationNs / 1000.0;
+			object["pid"] = 1;
+			object["tid"] = event.threadId;
+			events.append(object);
+		}
+	}
+
+	QJsonObject root;
+	root["traceEvents"] = events;
+	root["displayTimeUnit"] = "ms";
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0 ||
+	    !file.commit()) {
+		obs_log(LOG_WARNING, "[Trace] Could not write %s: %s", path.toUtf8().constData(),
+			file.errorString().toUtf8().constData());
+		return -1;
+	}
+
+	obs_log(LOG_INFO, "[Trace] Wrote %lld event(s) to %s", static_cast<long long>(events.size()),
+		path.toUtf8().constData());
+	return static_cast<int>(events.size());
+}
+
+Span::Span(const char *name) : m_name(name), m_startNs(isEnabled() ? os_gettime_ns() : 0) {}
+
+Span::~Span()
+{
+	if (m_startNs) {
+		record(m_name, m_startNs, os_gettime_ns() - m_startNs);
+	}
+}
+
+} // namespace Trace
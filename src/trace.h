@@ -0,0 +1,47 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <QString>
+#include <cstdint>
+
+// Opt-in span recorder. Spans go into a fixed in-memory ring and can be
+// written out as a Chrome trace-event file (chrome://tracing, Perfetto).
+// When recording is off a span costs one relaxed atomic load.
+namespace Trace {
+
+bool isEnabled();
+void setEnabled(bool enabled);
+// Picks up the recording switch saved by the last session
+void restore();
+
+// Writes the ring to `path`; returns the number of events written, or -1
+int dump(const QString &path);
+
+class Span {
+public:
+	// `name` must outlive the trace (use string literals)
+	explicit Span(const char *name);
+	~Span();
+
+	Span(const Span &) = delete;
+	Span &operator=(const Span &) = delete;
+
+private:
+	const char *m_name;
+	uint64_t m_startNs;
+};
+
+} // namespace Trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
@@ -119,6 +119,136 @@ static QString ptBR_atualizar_lista() {
 	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
 }
 
+static QString ptBR_auto_rapido() { 
+	static const unsigned char utf8[] = {0x55, 0x73, 0x61, 0x72, 0x20, 0x61, 0x75, 0x74, 0x6F, 0x6D, 0x61, 0x74, 0x69, 0x63, 0x61, 0x6D, 0x65, 0x6E, 0x74, 0x65, 0x20, 0x6F, 0x20, 0x48, 0x6F, 0x6C, 0x79, 0x72, 0x69, 0x63, 0x73, 0x20, 0x6D, 0x61, 0x69, 0x73, 0x20, 0x72, 0xC3, 0xA1, 0x70, 0x69, 0x64, 0x6F, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_mais_rapido_usando() { 
+	static const unsigned char utf8[] = {0xE2, 0x9C, 0x93, 0x20, 0x55, 0x73, 0x61, 0x6E, 0x64, 0x6F, 0x20, 0x6F, 0x20, 0x48, 0x6F, 0x6C, 0x79, 0x72, 0x69, 0x63, 0x73, 0x20, 0x6D, 0x61, 0x69, 0x73, 0x20, 0x72, 0xC3, 0xA1, 0x70, 0x69, 0x64, 0x6F, 0x20, 0x25, 0x31, 0x3A, 0x25, 0x32, 0x20, 0x28, 0x6D, 0x65, 0x64, 0x69, 0x61, 0x6E, 0x61, 0x20, 0x25, 0x33, 0x20, 0x6D, 0x73, 0x2C, 0x20, 0x6A, 0x69, 0x74, 0x74, 0x65, 0x72, 0x20, 0x25, 0x34, 0x20, 0x6D, 0x73, 0x29, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_mais_rapido_disponivel() { 
+	static const unsigned char utf8[] = {0x4F, 0x20, 0x48, 0x6F, 0x6C, 0x79, 0x72, 0x69, 0x63, 0x73, 0x20, 0x6D, 0x61, 0x69, 0x73, 0x20, 0x72, 0xC3, 0xA1, 0x70, 0x69, 0x64, 0x6F, 0x20, 0xC3, 0xA9, 0x20, 0x25, 0x31, 0x3A, 0x25, 0x32, 0x20, 0x28, 0x6D, 0x65, 0x64, 0x69, 0x61, 0x6E, 0x61, 0x20, 0x25, 0x33, 0x20, 0x6D, 0x73, 0x2C, 0x20, 0x6A, 0x69, 0x74, 0x74, 0x65, 0x72, 0x20, 0x25, 0x34, 0x20, 0x6D, 0x73, 0x29, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_endereco_ipv6() { 
+	static const unsigned char utf8[] = {0x45, 0x6E, 0x64, 0x65, 0x72, 0x65, 0xC3, 0xA7, 0x6F, 0x20, 0x49, 0x50, 0x76, 0x36, 0x20, 0x28, 0x6F, 0x70, 0x63, 0x69, 0x6F, 0x6E, 0x61, 0x6C, 0x29, 0x3A, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_fontes_provisionadas() { 
+	static const unsigned char utf8[] = {0xE2, 0x9C, 0x93, 0x20, 0x46, 0x6F, 0x6E, 0x74, 0x65, 0x73, 0x20, 0x64, 0x6F, 0x20, 0x48, 0x6F, 0x6C, 0x79, 0x72, 0x69, 0x63, 0x73, 0x3A, 0x20, 0x25, 0x31, 0x20, 0x63, 0x72, 0x69, 0x61, 0x64, 0x61, 0x73, 0x2C, 0x20, 0x25, 0x32, 0x20, 0x61, 0x64, 0x69, 0x63, 0x69, 0x6F, 0x6E, 0x61, 0x64, 0x61, 0x73, 0x20, 0xC3, 0xA0, 0x20, 0x63, 0x65, 0x6E, 0x61, 0x2C, 0x20, 0x25, 0x33, 0x20, 0x6A, 0xC3, 0xA1, 0x20, 0x70, 0x72, 0x65, 0x73, 0x65, 0x6E, 0x74, 0x65, 0x73, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_falha_provisionar() { 
+	static const unsigned char utf8[] = {0x4E, 0xC3, 0xA3, 0x6F, 0x20, 0x66, 0x6F, 0x69, 0x20, 0x70, 0x6F, 0x73, 0x73, 0xC3, 0xAD, 0x76, 0x65, 0x6C, 0x20, 0x70, 0x72, 0x6F, 0x76, 0x69, 0x73, 0x69, 0x6F, 0x6E, 0x61, 0x72, 0x3A, 0x20, 0x25, 0x31, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_governador_ativo() { 
+	static const unsigned char utf8[] = {0x52, 0x65, 0x64, 0x75, 0x7A, 0x69, 0x72, 0x20, 0x6F, 0x20, 0x63, 0x6F, 0x6E, 0x73, 0x75, 0x6D, 0x6F, 0x20, 0x64, 0x61, 0x73, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x65, 0x73, 0x20, 0x64, 0x6F, 0x20, 0x48, 0x6F, 0x6C, 0x79, 0x72, 0x69, 0x63, 0x73, 0x20, 0x66, 0x6F, 0x72, 0x61, 0x20, 0x64, 0x6F, 0x20, 0x70, 0x72, 0x6F, 0x67, 0x72, 0x61, 0x6D, 0x61, 0x20, 0x65, 0x20, 0x64, 0x61, 0x20, 0x70, 0x72, 0xC3, 0xA9, 0x76, 0x69, 0x61, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_espelhando_texto() { 
+	static const unsigned char utf8[] = {0xE2, 0x9C, 0x93, 0x20, 0x45, 0x73, 0x70, 0x65, 0x6C, 0x68, 0x61, 0x6E, 0x64, 0x6F, 0x20, 0x6F, 0x20, 0x74, 0x65, 0x78, 0x74, 0x6F, 0x20, 0x64, 0x6F, 0x20, 0x48, 0x6F, 0x6C, 0x79, 0x72, 0x69, 0x63, 0x73, 0x20, 0x64, 0x65, 0x20, 0x25, 0x31, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_falha_texto_nativo() { 
+	static const unsigned char utf8[] = {0x4E, 0xC3, 0xA3, 0x6F, 0x20, 0x66, 0x6F, 0x69, 0x20, 0x70, 0x6F, 0x73, 0x73, 0xC3, 0xAD, 0x76, 0x65, 0x6C, 0x20, 0x63, 0x72, 0x69, 0x61, 0x72, 0x20, 0x61, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x65, 0x20, 0x64, 0x65, 0x20, 0x74, 0x65, 0x78, 0x74, 0x6F, 0x20, 0x6E, 0x61, 0x74, 0x69, 0x76, 0x61, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_falha_rastreamento() { 
+	static const unsigned char utf8[] = {0x4E, 0xC3, 0xA3, 0x6F, 0x20, 0x66, 0x6F, 0x69, 0x20, 0x70, 0x6F, 0x73, 0x73, 0xC3, 0xAD, 0x76, 0x65, 0x6C, 0x20, 0x67, 0x72, 0x61, 0x76, 0x61, 0x72, 0x20, 0x6F, 0x20, 0x61, 0x72, 0x71, 0x75, 0x69, 0x76, 0x6F, 0x20, 0x64, 0x65, 0x20, 0x72, 0x61, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6D, 0x65, 0x6E, 0x74, 0x6F, 0x2E, 0x20, 0x56, 0x65, 0x6A, 0x61, 0x20, 0x6F, 0x20, 0x6C, 0x6F, 0x67, 0x20, 0x64, 0x6F, 0x20, 0x4F, 0x42, 0x53, 0x20, 0x70, 0x61, 0x72, 0x61, 0x20, 0x64, 0x65, 0x74, 0x61, 0x6C, 0x68, 0x65, 0x73, 0x2E, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_atualizar_paineis() { 
+	static const unsigned char utf8[] = {0x41, 0x74, 0x75, 0x61, 0x6C, 0x69, 0x7A, 0x61, 0x72, 0x20, 0x54, 0x6F, 0x64, 0x6F, 0x73, 0x20, 0x6F, 0x73, 0x20, 0x50, 0x61, 0x69, 0x6E, 0xC3, 0xA9, 0x69, 0x73, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_paineis_atualizados() { 
+	static const unsigned char utf8[] = {0xE2, 0x9C, 0x93, 0x20, 0x25, 0x31, 0x20, 0x70, 0x61, 0x69, 0x6E, 0x65, 0x6C, 0x28, 0x69, 0x73, 0x29, 0x20, 0x61, 0x74, 0x75, 0x61, 0x6C, 0x69, 0x7A, 0x61, 0x64, 0x6F, 0x28, 0x73, 0x29, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_paineis_reiniciar() { 
+	static const unsigned char utf8[] = {0x25, 0x31, 0x20, 0x70, 0x61, 0x69, 0x6E, 0x65, 0x6C, 0x28, 0x69, 0x73, 0x29, 0x20, 0x61, 0x74, 0x75, 0x61, 0x6C, 0x69, 0x7A, 0x61, 0x64, 0x6F, 0x28, 0x73, 0x29, 0x2E, 0x20, 0x52, 0x65, 0x69, 0x6E, 0x69, 0x63, 0x69, 0x65, 0x20, 0x6F, 0x20, 0x4F, 0x42, 0x53, 0x20, 0x70, 0x61, 0x72, 0x61, 0x20, 0x63, 0x61, 0x72, 0x72, 0x65, 0x67, 0x61, 0x72, 0x20, 0x6F, 0x20, 0x6E, 0x6F, 0x76, 0x6F, 0x20, 0x65, 0x6E, 0x64, 0x65, 0x72, 0x65, 0xC3, 0xA7, 0x6F, 0x20, 0x65, 0x6D, 0x3A, 0x20, 0x25, 0x32, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_paineis_em_dia() { 
+	static const unsigned char utf8[] = {0xE2, 0x9C, 0x93, 0x20, 0x54, 0x6F, 0x64, 0x6F, 0x73, 0x20, 0x6F, 0x73, 0x20, 0x70, 0x61, 0x69, 0x6E, 0xC3, 0xA9, 0x69, 0x73, 0x20, 0x6A, 0xC3, 0xA1, 0x20, 0x61, 0x70, 0x6F, 0x6E, 0x74, 0x61, 0x6D, 0x20, 0x70, 0x61, 0x72, 0x61, 0x20, 0x65, 0x73, 0x74, 0x65, 0x20, 0x65, 0x6E, 0x64, 0x65, 0x72, 0x65, 0xC3, 0xA7, 0x6F, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_falha_paineis() { 
+	static const unsigned char utf8[] = {0x4E, 0xC3, 0xA3, 0x6F, 0x20, 0x66, 0x6F, 0x69, 0x20, 0x70, 0x6F, 0x73, 0x73, 0xC3, 0xAD, 0x76, 0x65, 0x6C, 0x20, 0x67, 0x72, 0x61, 0x76, 0x61, 0x72, 0x20, 0x61, 0x20, 0x63, 0x6F, 0x6E, 0x66, 0x69, 0x67, 0x75, 0x72, 0x61, 0xC3, 0xA7, 0xC3, 0xA3, 0x6F, 0x20, 0x64, 0x65, 0x20, 0x70, 0x61, 0x69, 0x6E, 0xC3, 0xA9, 0x69, 0x73, 0x20, 0x64, 0x6F, 0x20, 0x4F, 0x42, 0x53, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_buscar_fontes() { 
+	static const unsigned char utf8[] = {0x42, 0x75, 0x73, 0x63, 0x61, 0x72, 0x20, 0x70, 0x6F, 0x72, 0x20, 0x6E, 0x6F, 0x6D, 0x65, 0x2C, 0x20, 0x65, 0x6E, 0x64, 0x65, 0x72, 0x65, 0xC3, 0xA7, 0x6F, 0x2C, 0x20, 0x63, 0x65, 0x6E, 0x61, 0x20, 0x6F, 0x75, 0x20, 0x63, 0x61, 0x6D, 0x69, 0x6E, 0x68, 0x6F, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_selecionar_desatualizadas() { 
+	static const unsigned char utf8[] = {0x54, 0x6F, 0x64, 0x61, 0x73, 0x20, 0x71, 0x75, 0x65, 0x20, 0x6E, 0xC3, 0xA3, 0x6F, 0x20, 0x61, 0x70, 0x6F, 0x6E, 0x74, 0x61, 0x6D, 0x20, 0x70, 0x61, 0x72, 0x61, 0x20, 0x6F, 0x20, 0x65, 0x6E, 0x64, 0x65, 0x72, 0x65, 0xC3, 0xA7, 0x6F, 0x20, 0x61, 0x63, 0x69, 0x6D, 0x61, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_selecionar_busca() { 
+	static const unsigned char utf8[] = {0x54, 0x6F, 0x64, 0x61, 0x73, 0x20, 0x71, 0x75, 0x65, 0x20, 0x63, 0x6F, 0x72, 0x72, 0x65, 0x73, 0x70, 0x6F, 0x6E, 0x64, 0x65, 0x6D, 0x20, 0xC3, 0xA0, 0x20, 0x62, 0x75, 0x73, 0x63, 0x61, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_falha_log() { 
+	static const unsigned char utf8[] = {0x4E, 0xC3, 0xA3, 0x6F, 0x20, 0x66, 0x6F, 0x69, 0x20, 0x70, 0x6F, 0x73, 0x73, 0xC3, 0xAD, 0x76, 0x65, 0x6C, 0x20, 0x67, 0x72, 0x61, 0x76, 0x61, 0x72, 0x20, 0x6F, 0x20, 0x61, 0x72, 0x71, 0x75, 0x69, 0x76, 0x6F, 0x20, 0x64, 0x65, 0x20, 0x6C, 0x6F, 0x67, 0x2E, 0x20, 0x56, 0x65, 0x6A, 0x61, 0x20, 0x6F, 0x20, 0x6C, 0x6F, 0x67, 0x20, 0x64, 0x6F, 0x20, 0x4F, 0x42, 0x53, 0x20, 0x70, 0x61, 0x72, 0x61, 0x20, 0x64, 0x65, 0x74, 0x61, 0x6C, 0x68, 0x65, 0x73, 0x2E, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_falha_proxy() { 
+	static const unsigned char utf8[] = {0x4E, 0xC3, 0xA3, 0x6F, 0x20, 0x66, 0x6F, 0x69, 0x20, 0x70, 0x6F, 0x73, 0x73, 0xC3, 0xAD, 0x76, 0x65, 0x6C, 0x20, 0x69, 0x6E, 0x69, 0x63, 0x69, 0x61, 0x72, 0x20, 0x6F, 0x20, 0x70, 0x72, 0x6F, 0x78, 0x79, 0x20, 0x6C, 0x6F, 0x63, 0x61, 0x6C, 0x20, 0x6E, 0x61, 0x20, 0x70, 0x6F, 0x72, 0x74, 0x61, 0x20, 0x25, 0x31, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_host_vinculado() { 
+	static const unsigned char utf8[] = {0xE2, 0x9C, 0x93, 0x20, 0x41, 0x73, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x65, 0x73, 0x20, 0x61, 0x67, 0x6F, 0x72, 0x61, 0x20, 0x75, 0x73, 0x61, 0x6D, 0x20, 0x25, 0x31, 0x20, 0x28, 0x25, 0x32, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x65, 0x28, 0x73, 0x29, 0x20, 0x61, 0x74, 0x75, 0x61, 0x6C, 0x69, 0x7A, 0x61, 0x64, 0x61, 0x28, 0x73, 0x29, 0x29, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_host_desvinculado() { 
+	static const unsigned char utf8[] = {0xE2, 0x9C, 0x93, 0x20, 0x41, 0x73, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x65, 0x73, 0x20, 0x76, 0x6F, 0x6C, 0x74, 0x61, 0x72, 0x61, 0x6D, 0x20, 0x61, 0x20, 0x75, 0x73, 0x61, 0x72, 0x20, 0x6F, 0x20, 0x49, 0x50, 0x20, 0x28, 0x25, 0x31, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x65, 0x28, 0x73, 0x29, 0x20, 0x61, 0x74, 0x75, 0x61, 0x6C, 0x69, 0x7A, 0x61, 0x64, 0x61, 0x28, 0x73, 0x29, 0x29, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_falha_host() { 
+	static const unsigned char utf8[] = {0x4E, 0xC3, 0xA3, 0x6F, 0x20, 0x66, 0x6F, 0x69, 0x20, 0x70, 0x6F, 0x73, 0x73, 0xC3, 0xAD, 0x76, 0x65, 0x6C, 0x20, 0x63, 0x6F, 0x6E, 0x66, 0x69, 0x72, 0x6D, 0x61, 0x72, 0x20, 0x71, 0x75, 0x65, 0x20, 0x25, 0x31, 0x20, 0x61, 0x70, 0x6F, 0x6E, 0x74, 0x61, 0x20, 0x70, 0x61, 0x72, 0x61, 0x20, 0x25, 0x32, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_host_invalido() { 
+	static const unsigned char utf8[] = {0x25, 0x31, 0x20, 0x6E, 0xC3, 0xA3, 0x6F, 0x20, 0xC3, 0xA9, 0x20, 0x75, 0x6D, 0x20, 0x6E, 0x6F, 0x6D, 0x65, 0x20, 0x64, 0x65, 0x20, 0x68, 0x6F, 0x73, 0x74, 0x20, 0x76, 0xC3, 0xA1, 0x6C, 0x69, 0x64, 0x6F, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_fontes_carregadas() { 
+	static const unsigned char utf8[] = {0xE2, 0x9C, 0x93, 0x20, 0x54, 0x6F, 0x64, 0x61, 0x73, 0x20, 0x61, 0x73, 0x20, 0x25, 0x31, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x65, 0x28, 0x73, 0x29, 0x20, 0x61, 0x74, 0x75, 0x61, 0x6C, 0x69, 0x7A, 0x61, 0x64, 0x61, 0x28, 0x73, 0x29, 0x20, 0x63, 0x61, 0x72, 0x72, 0x65, 0x67, 0x61, 0x72, 0x61, 0x6D, 0x20, 0x6F, 0x20, 0x48, 0x6F, 0x6C, 0x79, 0x72, 0x69, 0x63, 0x73, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
+static QString ptBR_fontes_nao_carregadas() { 
+	static const unsigned char utf8[] = {0x25, 0x31, 0x20, 0x64, 0x65, 0x20, 0x25, 0x32, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x65, 0x28, 0x73, 0x29, 0x20, 0x61, 0x74, 0x75, 0x61, 0x6C, 0x69, 0x7A, 0x61, 0x64, 0x61, 0x28, 0x73, 0x29, 0x20, 0x6E, 0xC3, 0xA3, 0x6F, 0x20, 0x63, 0x61, 0x72, 0x72, 0x65, 0x67, 0x61, 0x72, 0x61, 0x6D, 0x3A, 0x20, 0x25, 0x33, 0}; 
+	return QString::fromUtf8(reinterpret_cast<const char*>(utf8)); 
+}
+
 static QMap<QString, QMap<QString, QString>> getTranslations() {
 	QMap<QString, QMap<QString, QString>> translations;
 	
@@ -158,7 +288,54 @@ static QMap<QString, QMap<QString, QString>> getTranslations() {
 		{"docks.none_found", "No custom browser docks with IP:Port found"},
 		{"docks.not_found", "OBS config file not found"},
 		{"docks.url_copied", checkmark() + "URL copied for '%1'"},
-		{"button.close", "Close"}
+		{"button.close", "Close"},
+		{"connection.auto_fastest", "Automatically use the fastest Holyrics host"},
+		{"status.fastest_selected", checkmark() + "Using fastest Holyrics %1:%2 (median %3 ms, jitter %4 ms)"},
+		{"status.fastest_available", "Fastest Holyrics is %1:%2 (median %3 ms, jitter %4 ms)"},
+		{"connection.ipv6_label", "IPv6 address (optional):"},
+		{"connection.scan_all_button", "Scan All Interfaces"},
+		{"status.scanning_interfaces", "Scanning every network interface in parallel..."},
+		{"status.scanning_interfaces_progress", "Scanning interfaces: %1"},
+		{"sources.create_button", "Create Holyrics Sources"},
+		{"sources.create_grouped", "Place new sources in a \"Holyrics\" group"},
+		{"status.sources_provisioned", checkmark() + "Holyrics sources: %1 created, %2 added to scene, %3 already present"},
+		{"status.sources_provision_failed", "Could not provision: %1"},
+		{"governor.enabled", "Throttle Holyrics sources that are not in program or preview"},
+		{"governor.stats", "%1 Holyrics source(s): %2 throttled, %3 unloaded, ~%4 frames/s and ~%5 MB saved"},
+		{"text_mirror.enabled", "Mirror lyrics into a native text source (no browser)"},
+		{"status.text_mirror_started", checkmark() + "Mirroring Holyrics text from %1"},
+		{"status.text_mirror_failed", "Could not create the native text source"},
+		{"menu.trace_record", "Holyrics Finder: Record Trace"},
+		{"menu.trace_save", "Holyrics Finder: Save Trace..."},
+		{"trace.saved", "Saved %1 trace event(s) to:\n%2\n\nOpen it in chrome://tracing or ui.perfetto.dev."},
+		{"trace.save_failed", "Could not write the trace file. See the OBS log for details."},
+		{"failover.enabled", "Fail over to:"},
+		{"failover.placeholder", "Primary first, then standbys (e.g. 192.168.0.10:8091, 192.168.0.11:8091)"},
+		{"status.failed_over", "Holyrics at %1 stopped responding; moved %2 source(s) to %3"},
+		{"docks.update_all", "Update All Docks"},
+		{"status.docks_updated", checkmark() + "Updated %1 dock(s)"},
+		{"status.docks_updated_restart", "Updated %1 dock(s). Restart OBS to load the new address in: %2"},
+		{"status.docks_up_to_date", checkmark() + "All docks already point at this address"},
+		{"status.docks_update_failed", "Could not write the OBS dock configuration"},
+		{"sources.search_placeholder", "Search by name, address, scene or path"},
+		{"sources.select_by", "Select..."},
+		{"sources.select_stale", "All not pointing at the address above"},
+		{"sources.select_matching", "All matching the search"},
+		{"sources.select_scene", "All in scene \"%1\""},
+		{"menu.log_save", "Holyrics Finder: Save Detailed Log..."},
+		{"log.saved", "Saved %1 log event(s) to:\n%2"},
+		{"log.save_failed", "Could not write the log file. See the OBS log for details."},
+		{"proxy.enabled", "Serve sources through a local proxy (127.0.0.1:%1)"},
+		{"status.proxy_failed", "Could not start the local proxy on port %1"},
+		{"hostname.label", "Holyrics hostname:"},
+		{"hostname.placeholder", "holyrics.local"},
+		{"hostname.bind", "Bind sources"},
+		{"status.hostname_bound", checkmark() + "Sources now use %1 (%2 source(s) updated)"},
+		{"status.hostname_unbound", checkmark() + "Sources use the IP address again (%1 source(s) updated)"},
+		{"status.hostname_failed", "Could not confirm that %1 points at %2"},
+		{"status.hostname_invalid", "%1 is not a valid hostname"},
+		{"status.sources_loaded", checkmark() + "All %1 updated source(s) loaded Holyrics"},
+		{"status.sources_not_loaded", "%1 of %2 updated source(s) did not load: %3"}
 	};
 	
 	// Portuguese (Brazil)
@@ -197,7 +374,54 @@ static QMap<QString, QMap<QString, QString>> getTranslations() {
 		{"docks.none_found", ptBR_nenhum_painel()},
 		{"docks.not_found", ptBR_config_nao_encontrado()},
 		{"docks.url_copied", ptBR_url_copiada()},
-		{"button.close", "Fechar"}
+		{"button.close", "Fechar"},
+		{"connection.auto_fastest", ptBR_auto_rapido()},
+		{"status.fastest_selected", ptBR_mais_rapido_usando()},
+		{"status.fastest_available", ptBR_mais_rapido_disponivel()},
+		{"connection.ipv6_label", ptBR_endereco_ipv6()},
+		{"connection.scan_all_button", "Escanear Todas as Interfaces"},
+		{"status.scanning_interfaces", "Escaneando todas as interfaces de rede em paralelo..."},
+		{"status.scanning_interfaces_progress", "Escaneando interfaces: %1"},
+		{"sources.create_button", "Criar Fontes do Holyrics"},
+		{"sources.create_grouped", "Colocar novas fontes em um grupo \"Holyrics\""},
+		{"status.sources_provisioned", ptBR_fontes_provisionadas()},
+		{"status.sources_provision_failed", ptBR_falha_provisionar()},
+		{"governor.enabled", ptBR_governador_ativo()},
+		{"governor.stats", "%1 fonte(s) do Holyrics: %2 reduzidas, %3 descarregadas, ~%4 quadros/s e ~%5 MB economizados"},
+		{"text_mirror.enabled", "Espelhar a letra em uma fonte de texto nativa (sem navegador)"},
+		{"status.text_mirror_started", ptBR_espelhando_texto()},
+		{"status.text_mirror_failed", ptBR_falha_texto_nativo()},
+		{"menu.trace_record", "Holyrics Finder: Gravar Rastreamento"},
+		{"menu.trace_save", "Holyrics Finder: Salvar Rastreamento..."},
+		{"trace.saved", "%1 evento(s) de rastreamento salvos em:\n%2\n\nAbra em chrome://tracing ou ui.perfetto.dev."},
+		{"trace.save_failed", ptBR_falha_rastreamento()},
+		{"failover.enabled", "Alternar para:"},
+		{"failover.placeholder", "Principal primeiro, depois reservas (ex.: 192.168.0.10:8091, 192.168.0.11:8091)"},
+		{"status.failed_over", "Holyrics em %1 parou de responder; %2 fonte(s) movidas para %3"},
+		{"docks.update_all", ptBR_atualizar_paineis()},
+		{"status.docks_updated", ptBR_paineis_atualizados()},
+		{"status.docks_updated_restart", ptBR_paineis_reiniciar()},
+		{"status.docks_up_to_date", ptBR_paineis_em_dia()},
+		{"status.docks_update_failed", ptBR_falha_paineis()},
+		{"sources.search_placeholder", ptBR_buscar_fontes()},
+		{"sources.select_by", "Selecionar..."},
+		{"sources.select_stale", ptBR_selecionar_desatualizadas()},
+		{"sources.select_matching", ptBR_selecionar_busca()},
+		{"sources.select_scene", "Todas na cena \"%1\""},
+		{"menu.log_save", "Holyrics Finder: Salvar Log Detalhado..."},
+		{"log.saved", "%1 evento(s) de log salvos em:\n%2"},
+		{"log.save_failed", ptBR_falha_log()},
+		{"proxy.enabled", "Servir fontes por um proxy local (127.0.0.1:%1)"},
+		{"status.proxy_failed", ptBR_falha_proxy()},
+		{"hostname.label", "Nome do host do Holyrics:"},
+		{"hostname.placeholder", "holyrics.local"},
+		{"hostname.bind", "Vincular fontes"},
+		{"status.hostname_bound", ptBR_host_vinculado()},
+		{"status.hostname_unbound", ptBR_host_desvinculado()},
+		{"status.hostname_failed", ptBR_falha_host()},
+		{"status.hostname_invalid", ptBR_host_invalido()},
+		{"status.sources_loaded", ptBR_fontes_carregadas()},
+		{"status.sources_not_loaded", ptBR_fontes_nao_carregadas()}
 	};
 	
 	return translations;
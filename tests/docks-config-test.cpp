@@ -0,0 +1,107 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "docks-config.h"
+#include "obs-stub.h"
+#include <util/config-file.h>
+#include <QTest>
+
+// The dock list as OBS might have it: key orders that differ per dock,
+// spacing, escaped slashes and a non-ASCII title, fields we don't read,
+// a dock with no url and pages that have nothing to do with Holyrics
+static const char *kDocks =
+	"[{\"title\":\"Chat\",\"url\":\"https:\\/\\/chat.example.com\\/popout?x=1&y=2\",\"uuid\":\"c1\"},"
+	"{\"url\": \"http://192.168.0.20:8091/stage-view/text\", \"title\": \"Letra \\u00e9\", "
+	"\"uuid\": \"h1\", \"zoom\": 1.25, \"css\": {\"url\": \"http://192.168.0.20:8091/ignored\"}},"
+	"{\"title\":\"Notes\",\"uuid\":\"n1\"},"
+	"{\"title\":\"Router\",\"url\":\"http://192.168.0.1/status\",\"uuid\":\"r1\"},"
+	"{\"uuid\":\"h2\",\"url\":\"http://192.168.0.20:8091/stage-view/widescreen?theme=dark\",\"title\":\"Lower\"}]";
+
+static QByteArray configuredDocks()
+{
+	const char *value = config_get_string(obs_frontend_get_user_config(), "BasicWindow", "ExtraBrowserDocks");
+	return QByteArray(value ? value : "");
+}
+
+static void setConfiguredDocks(const char *json)
+{
+	config_set_string(obs_frontend_get_user_config(), "BasicWindow", "ExtraBrowserDocks", json);
+}
+
+// What a rewrite from 192.168.0.20:8091 to 192.168.0.30:8091 must leave:
+// the same text with two urls changed and nothing else
+static QByteArray expectedAfterRewrite()
+{
+	QByteArray expected(kDocks);
+	expected.replace("\"http://192.168.0.20:8091/stage-view/text\"",
+			 "\"http://192.168.0.30:8091/stage-view/text\"");
+	expected.replace("\"http://192.168.0.20:8091/stage-view/widescreen?theme=dark\"",
+			 "\"http://192.168.0.30:8091/stage-view/widescreen?theme=dark\"");
+	return expected;
+}
+
+class DocksConfigTest : public QObject {
+	Q_OBJECT
+
+private slots:
+	void init()
+	{
+		ObsStub::reset();
+		setConfiguredDocks(kDocks);
+	}
+
+	void parseSkipsDocksWithoutUrl()
+	{
+		QList<DocksConfig::Dock> docks;
+		QVERIFY(DocksConfig::read(docks));
+		QCOMPARE(docks.size(), 4);
+		QCOMPARE(docks[0].url, QString("https://chat.example.com/popout?x=1&y=2"));
+		QCOMPARE(docks[1].title, QString::fromUtf8("Letra \xc3\xa9"));
+		QCOMPARE(docks[1].uuid, QString("h1"));
+		QCOMPARE(docks[3].title, QString("Lower"));
+	}
+
+	void rewriteChangesOnlyMatchingUrls()
+	{
+		QStringList changedTitles;
+		QVERIFY(DocksConfig::rewriteEndpoints({{"192.168.0.20", 8091}}, {"192.168.0.30", 8091}, changedTitles));
+
+		QCOMPARE(changedTitles, QStringList({QString::fromUtf8("Letra \xc3\xa9"), QString("Lower")}));
+		QCOMPARE(configuredDocks(), expectedAfterRewrite());
+
+		// OBS writes its own, older, list back on exit; the rewrite is
+		// applied again on top of it the same way
+		setConfiguredDocks(kDocks);
+		DocksConfig::reapplyRewrites();
+		QCOMPARE(configuredDocks(), expectedAfterRewrite());
+	}
+
+	void rewriteFromUnusedEndpointLeavesConfigAlone()
+	{
+		QStringList changedTitles;
+		QVERIFY(DocksConfig::rewriteEndpoints({{"192.168.0.99", 8091}}, {"192.168.0.30", 8091}, changedTitles));
+		QVERIFY(changedTitles.isEmpty());
+		QCOMPARE(configuredDocks(), QByteArray(kDocks));
+	}
+
+	void malformedConfigIsNotTouched()
+	{
+		const char *broken = "[{\"title\":\"Holyrics\",\"url\":\"http://192.168.0.20:8091/stage-view/text\"";
+		setConfiguredDocks(broken);
+
+		QStringList changedTitles;
+		QVERIFY(DocksConfig::rewriteEndpoints({{"192.168.0.20", 8091}}, {"192.168.0.30", 8091}, changedTitles));
+		QVERIFY(changedTitles.isEmpty());
+		QCOMPARE(configuredDocks(), QByteArray(broken));
+	}
+};
+
+QTEST_GUILESS_MAIN(DocksConfigTest)
+#include "docks-config-test.moc"
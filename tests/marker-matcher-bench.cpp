@@ -0,0 +1,217 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+// Checks every MarkerMatcher code path against a plain reference search
+// on randomised bodies, then times them on realistic probe bodies next to
+// the QString search isHolyricsResponse used to do. --quick runs a smaller
+// check and skips the timings, as a test. --seed N repeats a failing run.
+
+#include "marker-matcher.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+static const QList<QByteArray> kDefaultMarkers{"holyrics", "stage-view"};
+
+static bool referenceContains(const QList<QByteArray> &markers, const QByteArray &body)
+{
+	QByteArray lowered = body.toLower();
+	for (const QByteArray &marker : markers) {
+		if (!marker.isEmpty() && lowered.contains(marker.toLower())) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// Bytes that stress the folding: marker letters in both cases, the
+// punctuation OR 0x20 maps onto them ('@' -> '`', '[' -> '{'), '-' and
+// bytes above 0x7f
+static QByteArray randomBody(std::mt19937 &rng, const QList<QByteArray> &markers)
+{
+	static const char kAlphabet[] = "hHoOlLyYrRiIcCsS-tTaAgGeEvVwW@[`{ \t<>/=\"\x80\xc8\xe9\xff";
+	std::uniform_int_distribution<int> length(0, 600);
+	std::uniform_int_distribution<int> pick(0, int(sizeof(kAlphabet)) - 2);
+
+	QByteArray body(length(rng), Qt::Uninitialized);
+	for (char &c : body) {
+		c = kAlphabet[pick(rng)];
+	}
+
+	// Half the bodies get a marker, in random case, at a random spot
+	// (block edges included) and sometimes cut short by the end
+	if (!markers.isEmpty() && rng() % 2 == 0) {
+		QByteArray marker = markers[rng() % markers.size()];
+		for (char &c : marker) {
+			if (rng() % 2 && c >= 'a' && c <= 'z') {
+				c = char(c - 32);
+			}
+		}
+		qsizetype at = body.isEmpty() ? 0 : qsizetype(rng() % (body.size() + 1));
+		if (rng() % 4 == 0) {
+			at = qMax<qsizetype>(0, (at / 16) * 16 - qsizetype(rng() % 3));
+		}
+		body.insert(at, marker);
+		if (rng() % 8 == 0) {
+			body.truncate(body.size() - qsizetype(rng() % (marker.size() + 1)));
+		}
+	}
+	return body;
+}
+
+static QList<QByteArray> randomMarkers(std::mt19937 &rng)
+{
+	QList<QByteArray> markers = kDefaultMarkers;
+	int extra = int(rng() % 4);
+	for (int i = 0; i < extra; ++i) {
+		static const char kLetters[] = "holyricsSTAGEview-@[";
+		QByteArray marker(1 + int(rng() % 12), Qt::Uninitialized);
+		for (char &c : marker) {
+			c = kLetters[rng() % (sizeof(kLetters) - 1)];
+		}
+		markers.append(marker);
+	}
+	return markers;
+}
+
+static QList<const char *> availableImplementations()
+{
+	QList<const char *> available;
+	for (const char *name : {"scalar", "SSE2", "AVX2"}) {
+		if (MarkerMatcher::forceImplementation(name)) {
+			available.append(name);
+		}
+	}
+	MarkerMatcher::forceImplementation(nullptr);
+	return available;
+}
+
+static int check(unsigned int seed, int bodies)
+{
+	int failures = 0;
+	for (const char *name : availableImplementations()) {
+		MarkerMatcher::forceImplementation(name);
+		std::mt19937 rng(seed);
+		int hits = 0;
+		for (int i = 0; i < bodies; ++i) {
+			QList<QByteArray> markers = i % 3 == 0 ? randomMarkers(rng) : kDefaultMarkers;
+			QByteArray body = randomBody(rng, markers);
+			bool expected = referenceContains(markers, body);
+			hits += expected ? 1 : 0;
+			if (MarkerMatcher(markers).containsAny(body) != expected) {
+				if (++failures <= 5) {
+					fprintf(stderr, "%s: body %d (seed %u) should%s match: %s\n", name, i, seed,
+						expected ? "" : " not", body.toPercentEncoding().constData());
+				}
+			}
+		}
+		printf("check %-6s %d bodies, %d with a marker, %s\n", name, bodies, hits, failures ? "FAILED" : "ok");
+	}
+	MarkerMatcher::forceImplementation(nullptr);
+	return failures;
+}
+
+// What a probe really gets back: the stage page (a hit near the end, after
+// the styles), a router's admin page and a big page with no marker at all
+static QByteArray stagePage()
+{
+	QByteArray page = "<!DOCTYPE html><html><head><meta charset=\"utf-8\"><title>Text</title><style>";
+	for (int i = 0; i < 60; ++i) {
+		page += ".slide-" + QByteArray::number(i) + " { font-size: 48px; color: #FFFFFF; margin: 0 auto; }\n";
+	}
+	page += "</style></head><body><div id=\"text\"></div><script src=\"/Stage-View/js/main.js\"></script>"
+		"<!-- Holyrics --></body></html>";
+	return page;
+}
+
+static QByteArray missPage(int size)
+{
+	QByteArray page = "<!DOCTYPE html><html><head><title>Router Login</title></head><body>";
+	while (page.size() < size) {
+		page += "<div class=\"row\"><label for=\"user\">Username</label><input id=\"user\" type=\"text\"></div>\n";
+	}
+	page.truncate(size);
+	return page;
+}
+
+// The search isHolyricsResponse did before MarkerMatcher
+static bool qstringContains(const QByteArray &body)
+{
+	QString text = QString::fromUtf8(body);
+	return text.contains("holyrics", Qt::CaseInsensitive) || text.contains("stage-view", Qt::CaseInsensitive);
+}
+
+template<typename Search>
+static void timeSearch(const char *name, const char *bodyName, const QByteArray &body, Search search)
+{
+	volatile bool sink = false;
+	int iterations = 0;
+	QElapsedTimer timer;
+	timer.start();
+	do {
+		for (int i = 0; i < 64; ++i) {
+			sink = search(body);
+		}
+		iterations += 64;
+	} while (timer.elapsed() < 200);
+	double ns = double(timer.nsecsElapsed()) / iterations;
+	(void)sink;
+	printf("%-8s %-14s %8lld B %10.1f ns %8.2f GB/s\n", name, bodyName, static_cast<long long>(body.size()), ns,
+	       body.size() / ns);
+}
+
+static void benchmark()
+{
+	struct Body {
+		const char *name;
+		QByteArray data;
+	};
+	const QList<Body> bodies{{"stage page", stagePage()},
+				 {"router 8 KiB", missPage(8 * 1024)},
+				 {"miss 64 KiB", missPage(64 * 1024)}};
+
+	MarkerMatcher matcher(kDefaultMarkers);
+	for (const Body &body : bodies) {
+		for (const char *name : availableImplementations()) {
+			MarkerMatcher::forceImplementation(name);
+			timeSearch(name, body.name, body.data,
+				   [&matcher](const QByteArray &data) { return matcher.containsAny(data); });
+		}
+		MarkerMatcher::forceImplementation(nullptr);
+		timeSearch("QString", body.name, body.data, qstringContains);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	bool quick = false;
+	unsigned int seed = 20240601;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--quick") == 0) {
+			quick = true;
+		} else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = static_cast<unsigned int>(strtoul(argv[++i], nullptr, 10));
+		}
+	}
+
+	printf("automatic choice: %s\n", MarkerMatcher::implementation());
+	if (check(seed, quick ? 20000 : 200000) > 0) {
+		return 1;
+	}
+	if (!quick) {
+		benchmark();
+	}
+	return 0;
+}
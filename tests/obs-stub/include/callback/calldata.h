@@ -0,0 +1,43 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Zero-initialised like the real one; the values live behind `values`
+struct calldata {
+	void *values;
+};
+
+typedef struct calldata calldata_t;
+
+void calldata_free(calldata_t *data);
+
+void calldata_set_int(calldata_t *data, const char *name, long long val);
+void calldata_set_float(calldata_t *data, const char *name, double val);
+void calldata_set_bool(calldata_t *data, const char *name, bool val);
+void calldata_set_ptr(calldata_t *data, const char *name, void *ptr);
+void calldata_set_string(calldata_t *data, const char *name, const char *str);
+
+long long calldata_int(const calldata_t *data, const char *name);
+double calldata_float(const calldata_t *data, const char *name);
+bool calldata_bool(const calldata_t *data, const char *name);
+void *calldata_ptr(const calldata_t *data, const char *name);
+const char *calldata_string(const calldata_t *data, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "calldata.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct proc_handler proc_handler_t;
+typedef void (*proc_handler_proc_t)(void *data, calldata_t *cd);
+
+void proc_handler_add(proc_handler_t *handler, const char *decl_string, proc_handler_proc_t proc, void *data);
+bool proc_handler_call(proc_handler_t *handler, const char *name, calldata_t *params);
+
+#ifdef __cplusplus
+}
+#endif
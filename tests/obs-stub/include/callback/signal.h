@@ -0,0 +1,31 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "calldata.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct signal_handler signal_handler_t;
+typedef void (*signal_callback_t)(void *data, calldata_t *cd);
+
+bool signal_handler_add(signal_handler_t *handler, const char *signal_decl);
+bool signal_handler_add_array(signal_handler_t *handler, const char **signal_decls);
+void signal_handler_connect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data);
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal, signal_callback_t callback,
+			       void *data);
+void signal_handler_signal(signal_handler_t *handler, const char *signal, calldata_t *params);
+
+#ifdef __cplusplus
+}
+#endif
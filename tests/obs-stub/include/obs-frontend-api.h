@@ -0,0 +1,82 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "obs.h"
+#include "util/config-file.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum obs_frontend_event {
+	OBS_FRONTEND_EVENT_STREAMING_STARTING,
+	OBS_FRONTEND_EVENT_STREAMING_STARTED,
+	OBS_FRONTEND_EVENT_STREAMING_STOPPING,
+	OBS_FRONTEND_EVENT_STREAMING_STOPPED,
+	OBS_FRONTEND_EVENT_RECORDING_STARTING,
+	OBS_FRONTEND_EVENT_RECORDING_STARTED,
+	OBS_FRONTEND_EVENT_RECORDING_STOPPING,
+	OBS_FRONTEND_EVENT_RECORDING_STOPPED,
+	OBS_FRONTEND_EVENT_SCENE_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED,
+	OBS_FRONTEND_EVENT_TRANSITION_CHANGED,
+	OBS_FRONTEND_EVENT_TRANSITION_STOPPED,
+	OBS_FRONTEND_EVENT_TRANSITION_LIST_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_LIST_CHANGED,
+	OBS_FRONTEND_EVENT_PROFILE_CHANGED,
+	OBS_FRONTEND_EVENT_PROFILE_LIST_CHANGED,
+	OBS_FRONTEND_EVENT_EXIT,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTING,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_STARTED,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPING,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_STOPPED,
+	OBS_FRONTEND_EVENT_STUDIO_MODE_ENABLED,
+	OBS_FRONTEND_EVENT_STUDIO_MODE_DISABLED,
+	OBS_FRONTEND_EVENT_PREVIEW_SCENE_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP,
+	OBS_FRONTEND_EVENT_FINISHED_LOADING,
+	OBS_FRONTEND_EVENT_RECORDING_PAUSED,
+	OBS_FRONTEND_EVENT_RECORDING_UNPAUSED,
+	OBS_FRONTEND_EVENT_TRANSITION_DURATION_CHANGED,
+	OBS_FRONTEND_EVENT_REPLAY_BUFFER_SAVED,
+	OBS_FRONTEND_EVENT_VIRTUALCAM_STARTED,
+	OBS_FRONTEND_EVENT_VIRTUALCAM_STOPPED,
+	OBS_FRONTEND_EVENT_TBAR_VALUE_CHANGED,
+	OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING,
+	OBS_FRONTEND_EVENT_PROFILE_CHANGING,
+	OBS_FRONTEND_EVENT_SCRIPTING_SHUTDOWN,
+};
+
+typedef void (*obs_frontend_event_cb)(enum obs_frontend_event event, void *private_data);
+typedef void (*obs_frontend_cb)(void *private_data);
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void *private_data);
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void *private_data);
+
+// A QMainWindow and a QAction, as in OBS
+void *obs_frontend_get_main_window(void);
+void obs_frontend_add_tools_menu_item(const char *name, obs_frontend_cb callback, void *private_data);
+void *obs_frontend_add_tools_menu_qaction(const char *name);
+
+obs_source_t *obs_frontend_get_current_scene(void);
+obs_source_t *obs_frontend_get_current_preview_scene(void);
+obs_source_t *obs_frontend_get_current_transition(void);
+bool obs_frontend_preview_program_mode_active(void);
+bool obs_frontend_streaming_active(void);
+bool obs_frontend_recording_active(void);
+obs_output_t *obs_frontend_get_streaming_output(void);
+config_t *obs_frontend_get_user_config(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,41 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include "obs.h"
+
+#ifdef __cplusplus
+#define MODULE_EXPORT extern "C"
+#else
+#define MODULE_EXPORT
+#endif
+
+// There is no module loader here; the test calls obs_module_load() itself
+#define OBS_DECLARE_MODULE() static_assert(true, "no module pointer in the stand-in");
+#define OBS_MODULE_USE_DEFAULT_LOCALE(module_name, default_locale) \
+	static_assert(true, "no locale lookup in the stand-in");
+
+MODULE_EXPORT bool obs_module_load(void);
+MODULE_EXPORT void obs_module_unload(void);
+MODULE_EXPORT const char *obs_module_name(void);
+MODULE_EXPORT const char *obs_module_description(void);
+MODULE_EXPORT const char *obs_module_author(void);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Under the directory the test set with ObsStub::setConfigDir(); free with bfree()
+char *obs_module_config_path(const char *file);
+
+#ifdef __cplusplus
+}
+#endif
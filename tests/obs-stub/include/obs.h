@@ -0,0 +1,115 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+// Stand-in for the parts of libobs the plugin uses, so its classes can run
+// in a plain Qt process. Sources, scenes and settings live in memory; see
+// tests/obs-stub/obs-stub.h for what a test can set up and inspect.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "util/base.h"
+#include "util/bmem.h"
+#include "callback/calldata.h"
+#include "callback/proc.h"
+#include "callback/signal.h"
+#include "obs-data.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct obs_source obs_source_t;
+typedef struct obs_weak_source obs_weak_source_t;
+typedef struct obs_scene obs_scene_t;
+typedef struct obs_scene_item obs_sceneitem_t;
+typedef struct obs_output obs_output_t;
+typedef struct obs_properties obs_properties_t;
+typedef struct obs_property obs_property_t;
+
+enum obs_property_type {
+	OBS_PROPERTY_INVALID,
+	OBS_PROPERTY_BOOL,
+	OBS_PROPERTY_INT,
+	OBS_PROPERTY_FLOAT,
+	OBS_PROPERTY_TEXT,
+	OBS_PROPERTY_PATH,
+	OBS_PROPERTY_LIST,
+	OBS_PROPERTY_COLOR,
+	OBS_PROPERTY_BUTTON,
+};
+
+enum obs_transition_target {
+	OBS_TRANSITION_SOURCE_A,
+	OBS_TRANSITION_SOURCE_B,
+};
+
+// Sources
+obs_source_t *obs_source_create(const char *id, const char *name, obs_data_t *settings, obs_data_t *hotkey_data);
+obs_source_t *obs_get_source_by_name(const char *name);
+obs_source_t *obs_source_get_ref(obs_source_t *source);
+void obs_source_release(obs_source_t *source);
+const char *obs_source_get_name(const obs_source_t *source);
+const char *obs_source_get_id(const obs_source_t *source);
+const char *obs_source_get_uuid(const obs_source_t *source);
+obs_data_t *obs_source_get_settings(const obs_source_t *source);
+obs_data_t *obs_source_get_private_settings(obs_source_t *source);
+void obs_source_update(obs_source_t *source, obs_data_t *settings);
+bool obs_source_showing(const obs_source_t *source);
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source);
+obs_properties_t *obs_source_properties(const obs_source_t *source);
+const char *obs_get_latest_input_type_id(const char *unversioned_id);
+
+void obs_enum_sources(bool (*enum_proc)(void *, obs_source_t *), void *param);
+void obs_enum_scenes(bool (*enum_proc)(void *, obs_source_t *), void *param);
+
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source);
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak);
+void obs_weak_source_release(obs_weak_source_t *weak);
+
+obs_source_t *obs_transition_get_source(obs_source_t *transition, enum obs_transition_target target);
+
+// Scenes and scene items
+obs_scene_t *obs_scene_from_source(const obs_source_t *source);
+obs_source_t *obs_scene_get_source(const obs_scene_t *scene);
+obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source);
+obs_sceneitem_t *obs_scene_find_source_recursive(obs_scene_t *scene, const char *name);
+void obs_scene_enum_items(obs_scene_t *scene, bool (*callback)(obs_scene_t *, obs_sceneitem_t *, void *),
+			  void *param);
+void obs_scene_atomic_update(obs_scene_t *scene, void (*func)(void *data, obs_scene_t *scene), void *data);
+obs_sceneitem_t *obs_scene_get_group(obs_scene_t *scene, const char *name);
+obs_sceneitem_t *obs_scene_add_group2(obs_scene_t *scene, const char *name, bool signal);
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item);
+bool obs_sceneitem_is_group(obs_sceneitem_t *item);
+void obs_sceneitem_group_add_item(obs_sceneitem_t *group, obs_sceneitem_t *item);
+void obs_sceneitem_group_enum_items(obs_sceneitem_t *group,
+				    bool (*callback)(obs_scene_t *, obs_sceneitem_t *, void *), void *param);
+
+// Properties
+obs_property_t *obs_properties_get(obs_properties_t *props, const char *property);
+void obs_properties_destroy(obs_properties_t *props);
+enum obs_property_type obs_property_get_type(obs_property_t *p);
+bool obs_property_button_clicked(obs_property_t *p, void *obj);
+
+// Outputs
+void obs_output_release(obs_output_t *output);
+int obs_output_get_total_frames(const obs_output_t *output);
+int obs_output_get_frames_dropped(const obs_output_t *output);
+float obs_output_get_congestion(obs_output_t *output);
+
+signal_handler_t *obs_get_signal_handler(void);
+proc_handler_t *obs_get_proc_handler(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,33 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+// Stand-in for libobs, for the headless tests; see tests/obs-stub/obs-stub.h
+
+#pragma once
+
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+	LOG_ERROR = 100,
+	LOG_WARNING = 200,
+	LOG_INFO = 300,
+	LOG_DEBUG = 400,
+};
+
+void blogva(int log_level, const char *format, va_list args);
+void blog(int log_level, const char *format, ...);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,25 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *bmalloc(size_t size);
+void bfree(void *ptr);
+char *bstrdup(const char *str);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,28 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONFIG_SUCCESS 0
+#define CONFIG_ERROR -2
+
+typedef struct config_data config_t;
+
+const char *config_get_string(config_t *config, const char *section, const char *name);
+void config_set_string(config_t *config, const char *section, const char *name, const char *value);
+int config_save_safe(config_t *config, const char *temp_ext, const char *backup_ext);
+
+#ifdef __cplusplus
+}
+#endif
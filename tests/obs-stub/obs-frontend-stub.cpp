@@ -0,0 +1,47 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "obs-stub.h"
+#include <QAction>
+#include <QMainWindow>
+#include <QMenu>
+#include <QMenuBar>
+#include <QPointer>
+
+static QPointer<QMainWindow> s_mainWindow;
+
+static QMainWindow *mainWindow()
+{
+	if (!s_mainWindow) {
+		s_mainWindow = new QMainWindow();
+		s_mainWindow->menuBar()->addMenu("Tools");
+	}
+	return s_mainWindow;
+}
+
+void *obs_frontend_get_main_window(void)
+{
+	return mainWindow();
+}
+
+void *obs_frontend_add_tools_menu_qaction(const char *name)
+{
+	QMenu *tools = mainWindow()->menuBar()->findChild<QMenu *>();
+	return tools->addAction(QString::fromUtf8(name));
+}
+
+namespace ObsStub {
+
+void destroyMainWindow()
+{
+	delete s_mainWindow;
+}
+
+} // namespace ObsStub
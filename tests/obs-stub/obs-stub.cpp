@@ -0,0 +1,1216 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "obs-stub.h"
+#include <obs-module.h>
+#include <util/config-file.h>
+#include <util/platform.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Every object the plugin receives a reference to is counted here, and
+// every release takes it back; the objects' own refcounts also include
+// references the stand-in keeps for itself (the source list, scene items)
+static long long s_outstanding = 0;
+
+static void grant()
+{
+	s_outstanding++;
+}
+
+static void revoke()
+{
+	s_outstanding--;
+}
+
+// obs_data
+
+struct DataValue {
+	enum Kind { String, Int, Double, Bool, Object } kind = String;
+	std::string text;
+	long long integer = 0;
+	double real = 0.0;
+	bool flag = false;
+	obs_data_t *object = nullptr;
+};
+
+struct obs_data {
+	long refs = 1;
+	std::map<std::string, DataValue> values;
+};
+
+static void dataAddRef(obs_data_t *data)
+{
+	if (data) {
+		data->refs++;
+	}
+}
+
+static void dataRelease(obs_data_t *data)
+{
+	if (data && --data->refs == 0) {
+		for (auto &entry : data->values) {
+			dataRelease(entry.second.object);
+		}
+		delete data;
+	}
+}
+
+static const DataValue *findValue(obs_data_t *data, const char *name)
+{
+	if (!data || !name) {
+		return nullptr;
+	}
+	auto it = data->values.find(name);
+	return it == data->values.end() ? nullptr : &it->second;
+}
+
+static DataValue &replaceValue(obs_data_t *data, const char *name, DataValue::Kind kind)
+{
+	DataValue &value = data->values[name];
+	dataRelease(value.object);
+	value = DataValue();
+	value.kind = kind;
+	return value;
+}
+
+obs_data_t *obs_data_create(void)
+{
+	grant();
+	return new obs_data;
+}
+
+void obs_data_addref(obs_data_t *data)
+{
+	if (data) {
+		grant();
+		dataAddRef(data);
+	}
+}
+
+void obs_data_release(obs_data_t *data)
+{
+	if (data) {
+		revoke();
+		dataRelease(data);
+	}
+}
+
+void obs_data_apply(obs_data_t *target, obs_data_t *apply_data)
+{
+	if (!target || !apply_data || target == apply_data) {
+		return;
+	}
+	for (const auto &entry : apply_data->values) {
+		DataValue &value = replaceValue(target, entry.first.c_str(), entry.second.kind);
+		value = entry.second;
+		dataAddRef(value.object);
+	}
+}
+
+void obs_data_erase(obs_data_t *data, const char *name)
+{
+	if (!data || !name) {
+		return;
+	}
+	auto it = data->values.find(name);
+	if (it != data->values.end()) {
+		dataRelease(it->second.object);
+		data->values.erase(it);
+	}
+}
+
+bool obs_data_has_user_value(obs_data_t *data, const char *name)
+{
+	return findValue(data, name) != nullptr;
+}
+
+void obs_data_set_string(obs_data_t *data, const char *name, const char *val)
+{
+	if (data && name) {
+		replaceValue(data, name, DataValue::String).text = val ? val : "";
+	}
+}
+
+void obs_data_set_int(obs_data_t *data, const char *name, long long val)
+{
+	if (data && name) {
+		replaceValue(data, name, DataValue::Int).integer = val;
+	}
+}
+
+void obs_data_set_double(obs_data_t *data, const char *name, double val)
+{
+	if (data && name) {
+		replaceValue(data, name, DataValue::Double).real = val;
+	}
+}
+
+void obs_data_set_bool(obs_data_t *data, const char *name, bool val)
+{
+	if (data && name) {
+		replaceValue(data, name, DataValue::Bool).flag = val;
+	}
+}
+
+void obs_data_set_obj(obs_data_t *data, const char *name, obs_data_t *obj)
+{
+	if (data && name) {
+		dataAddRef(obj);
+		replaceValue(data, name, DataValue::Object).object = obj;
+	}
+}
+
+const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+	const DataValue *value = findValue(data, name);
+	return value && value->kind == DataValue::String ? value->text.c_str() : "";
+}
+
+long long obs_data_get_int(obs_data_t *data, const char *name)
+{
+	const DataValue *value = findValue(data, name);
+	if (!value) {
+		return 0;
+	}
+	return value->kind == DataValue::Double ? static_cast<long long>(value->real) : value->integer;
+}
+
+double obs_data_get_double(obs_data_t *data, const char *name)
+{
+	const DataValue *value = findValue(data, name);
+	if (!value) {
+		return 0.0;
+	}
+	return value->kind == DataValue::Int ? static_cast<double>(value->integer) : value->real;
+}
+
+bool obs_data_get_bool(obs_data_t *data, const char *name)
+{
+	const DataValue *value = findValue(data, name);
+	return value && value->kind == DataValue::Bool && value->flag;
+}
+
+obs_data_t *obs_data_get_obj(obs_data_t *data, const char *name)
+{
+	const DataValue *value = findValue(data, name);
+	if (!value || value->kind != DataValue::Object || !value->object) {
+		return nullptr;
+	}
+	obs_data_addref(value->object);
+	return value->object;
+}
+
+// calldata
+
+struct CallValue {
+	long long integer = 0;
+	double real = 0.0;
+	bool flag = false;
+	void *pointer = nullptr;
+	std::string text;
+};
+
+using CallValues = std::map<std::string, CallValue>;
+
+static CallValue &callValue(calldata_t *data, const char *name)
+{
+	if (!data->values) {
+		data->values = new CallValues;
+	}
+	return (*static_cast<CallValues *>(data->values))[name];
+}
+
+static const CallValue *findCallValue(const calldata_t *data, const char *name)
+{
+	if (!data || !data->values) {
+		return nullptr;
+	}
+	const CallValues &values = *static_cast<const CallValues *>(data->values);
+	auto it = values.find(name);
+	return it == values.end() ? nullptr : &it->second;
+}
+
+void calldata_free(calldata_t *data)
+{
+	if (data) {
+		delete static_cast<CallValues *>(data->values);
+		data->values = nullptr;
+	}
+}
+
+void calldata_set_int(calldata_t *data, const char *name, long long val)
+{
+	callValue(data, name).integer = val;
+}
+
+void calldata_set_float(calldata_t *data, const char *name, double val)
+{
+	callValue(data, name).real = val;
+}
+
+void calldata_set_bool(calldata_t *data, const char *name, bool val)
+{
+	callValue(data, name).flag = val;
+}
+
+void calldata_set_ptr(calldata_t *data, const char *name, void *ptr)
+{
+	callValue(data, name).pointer = ptr;
+}
+
+void calldata_set_string(calldata_t *data, const char *name, const char *str)
+{
+	callValue(data, name).text = str ? str : "";
+}
+
+long long calldata_int(const calldata_t *data, const char *name)
+{
+	const CallValue *value = findCallValue(data, name);
+	return value ? value->integer : 0;
+}
+
+double calldata_float(const calldata_t *data, const char *name)
+{
+	const CallValue *value = findCallValue(data, name);
+	return value ? value->real : 0.0;
+}
+
+bool calldata_bool(const calldata_t *data, const char *name)
+{
+	const CallValue *value = findCallValue(data, name);
+	return value && value->flag;
+}
+
+void *calldata_ptr(const calldata_t *data, const char *name)
+{
+	const CallValue *value = findCallValue(data, name);
+	return value ? value->pointer : nullptr;
+}
+
+const char *calldata_string(const calldata_t *data, const char *name)
+{
+	const CallValue *value = findCallValue(data, name);
+	return value ? value->text.c_str() : nullptr;
+}
+
+// Signals and procedures
+
+struct signal_handler {
+	std::vector<std::string> declared;
+	std::map<std::string, std::vector<std::pair<signal_callback_t, void *>>> connections;
+};
+
+struct proc_handler {
+	std::map<std::string, std::pair<proc_handler_proc_t, void *>> procs;
+};
+
+// "void name(in string ip)" -> "name"
+static std::string declaredName(const char *decl)
+{
+	std::string text = decl ? decl : "";
+	size_t open = text.find('(');
+	size_t start = text.rfind(' ', open);
+	start = start == std::string::npos ? 0 : start + 1;
+	return text.substr(start, open - start);
+}
+
+bool signal_handler_add(signal_handler_t *handler, const char *signal_decl)
+{
+	if (!handler || !signal_decl) {
+		return false;
+	}
+	handler->declared.push_back(declaredName(signal_decl));
+	return true;
+}
+
+bool signal_handler_add_array(signal_handler_t *handler, const char **signal_decls)
+{
+	bool ok = true;
+	for (; signal_decls && *signal_decls; ++signal_decls) {
+		ok = signal_handler_add(handler, *signal_decls) && ok;
+	}
+	return ok;
+}
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal, signal_callback_t callback, void *data)
+{
+	if (handler && signal) {
+		handler->connections[signal].emplace_back(callback, data);
+	}
+}
+
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal, signal_callback_t callback,
+			       void *data)
+{
+	if (!handler || !signal) {
+		return;
+	}
+	auto &list = handler->connections[signal];
+	auto it = std::find(list.begin(), list.end(), std::make_pair(callback, data));
+	if (it != list.end()) {
+		list.erase(it);
+	}
+}
+
+void signal_handler_signal(signal_handler_t *handler, const char *signal, calldata_t *params)
+{
+	if (!handler || !signal) {
+		return;
+	}
+	// Copied: a callback may disconnect itself
+	auto list = handler->connections[signal];
+	for (const auto &connection : list) {
+		connection.first(connection.second, params);
+	}
+}
+
+void proc_handler_add(proc_handler_t *handler, const char *decl_string, proc_handler_proc_t proc, void *data)
+{
+	if (handler && decl_string) {
+		handler->procs[declaredName(decl_string)] = {proc, data};
+	}
+}
+
+bool proc_handler_call(proc_handler_t *handler, const char *name, calldata_t *params)
+{
+	if (!handler || !name) {
+		return false;
+	}
+	auto it = handler->procs.find(name);
+	if (it == handler->procs.end()) {
+		return false;
+	}
+	it->second.first(it->second.second, params);
+	return true;
+}
+
+// Sources and scenes
+
+struct obs_weak_source {
+	obs_source_t *source = nullptr;
+	long refs = 0;
+};
+
+struct obs_source {
+	long refs = 1;
+	std::string id;
+	std::string name;
+	std::string uuid;
+	obs_data_t *settings = nullptr;
+	obs_data_t *privateSettings = nullptr;
+	signal_handler_t signals;
+	obs_scene_t *scene = nullptr;
+	obs_weak_source_t *weak = nullptr;
+	bool showing = false;
+	int updates = 0;
+	int reloads = 0;
+};
+
+struct obs_scene_item {
+	obs_scene_t *parent = nullptr;
+	obs_source_t *source = nullptr;
+};
+
+struct obs_scene {
+	obs_source_t *source = nullptr;
+	std::vector<obs_sceneitem_t *> items;
+};
+
+struct obs_property {
+	std::string name;
+	enum obs_property_type type = OBS_PROPERTY_INVALID;
+};
+
+struct obs_properties {
+	std::vector<obs_property> properties;
+};
+
+static std::vector<obs_source_t *> s_sources;
+static obs_source_t *s_currentScene = nullptr;
+static obs_source_t *s_previewScene = nullptr;
+static obs_source_t *s_transition = nullptr;
+static bool s_studioMode = false;
+static int s_nextUuid = 0;
+static signal_handler_t *s_signals = nullptr;
+static proc_handler_t *s_procs = nullptr;
+
+static bool isSceneType(const obs_source_t *source)
+{
+	return source->id == "scene" || source->id == "group";
+}
+
+static void sourceAddRef(obs_source_t *source)
+{
+	if (source) {
+		source->refs++;
+	}
+}
+
+static void destroyScene(obs_scene_t *scene);
+
+static void sourceRelease(obs_source_t *source)
+{
+	if (!source || --source->refs > 0) {
+		return;
+	}
+	if (source->weak) {
+		source->weak->source = nullptr;
+		if (source->weak->refs == 0) {
+			delete source->weak;
+		}
+	}
+	destroyScene(source->scene);
+	dataRelease(source->settings);
+	dataRelease(source->privateSettings);
+	delete source;
+}
+
+static void destroyScene(obs_scene_t *scene)
+{
+	if (!scene) {
+		return;
+	}
+	for (obs_sceneitem_t *item : scene->items) {
+		sourceRelease(item->source);
+		delete item;
+	}
+	delete scene;
+}
+
+static obs_source_t *newSource(const char *id, const char *name, obs_data_t *settings)
+{
+	obs_source_t *source = new obs_source;
+	source->id = id ? id : "";
+	source->name = name ? name : "";
+
+	char uuid[40];
+	snprintf(uuid, sizeof(uuid), "00000000-0000-4000-8000-%012d", ++s_nextUuid);
+	source->uuid = uuid;
+
+	source->settings = new obs_data;
+	obs_data_apply(source->settings, settings);
+	if (isSceneType(source)) {
+		source->scene = new obs_scene;
+		source->scene->source = source;
+	}
+	return source;
+}
+
+// Listed sources are held by the list itself, like OBS holds them until removed
+static obs_source_t *listSource(obs_source_t *source)
+{
+	s_sources.push_back(source);
+	return source;
+}
+
+obs_source_t *obs_source_create(const char *id, const char *name, obs_data_t *settings, obs_data_t *)
+{
+	obs_source_t *source = listSource(newSource(id, name, settings));
+	sourceAddRef(source);
+	grant();
+	return source;
+}
+
+obs_source_t *obs_get_source_by_name(const char *name)
+{
+	if (!name) {
+		return nullptr;
+	}
+	for (obs_source_t *source : s_sources) {
+		if (source->name == name) {
+			return obs_source_get_ref(source);
+		}
+	}
+	return nullptr;
+}
+
+obs_source_t *obs_source_get_ref(obs_source_t *source)
+{
+	if (!source) {
+		return nullptr;
+	}
+	grant();
+	sourceAddRef(source);
+	return source;
+}
+
+void obs_source_release(obs_source_t *source)
+{
+	if (source) {
+		revoke();
+		sourceRelease(source);
+	}
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+	return source ? source->name.c_str() : nullptr;
+}
+
+const char *obs_source_get_id(const obs_source_t *source)
+{
+	return source ? source->id.c_str() : nullptr;
+}
+
+const char *obs_source_get_uuid(const obs_source_t *source)
+{
+	return source ? source->uuid.c_str() : nullptr;
+}
+
+obs_data_t *obs_source_get_settings(const obs_source_t *source)
+{
+	if (!source) {
+		return nullptr;
+	}
+	obs_data_addref(source->settings);
+	return source->settings;
+}
+
+obs_data_t *obs_source_get_private_settings(obs_source_t *source)
+{
+	if (!source) {
+		return nullptr;
+	}
+	if (!source->privateSettings) {
+		source->privateSettings = new obs_data;
+	}
+	obs_data_addref(source->privateSettings);
+	return source->privateSettings;
+}
+
+void obs_source_update(obs_source_t *source, obs_data_t *settings)
+{
+	if (source) {
+		obs_data_apply(source->settings, settings);
+		source->updates++;
+	}
+}
+
+bool obs_source_showing(const obs_source_t *source)
+{
+	return source && source->showing;
+}
+
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source)
+{
+	return source ? const_cast<signal_handler_t *>(&source->signals) : nullptr;
+}
+
+obs_properties_t *obs_source_properties(const obs_source_t *source)
+{
+	if (!source) {
+		return nullptr;
+	}
+	obs_properties_t *properties = new obs_properties;
+	if (source->id == "browser_source") {
+		properties->properties.push_back({"url", OBS_PROPERTY_TEXT});
+		properties->properties.push_back({"refreshnocache", OBS_PROPERTY_BUTTON});
+	}
+	return properties;
+}
+
+const char *obs_get_latest_input_type_id(const char *unversioned_id)
+{
+	static const char *const kKnownTypes[] = {"browser_source", "text_ft2_source", "text_gdiplus", "color_source"};
+	for (const char *type : kKnownTypes) {
+		if (unversioned_id && strcmp(type, unversioned_id) == 0) {
+			return type;
+		}
+	}
+	return nullptr;
+}
+
+void obs_enum_sources(bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+	// Copied: the callback may create sources
+	std::vector<obs_source_t *> sources = s_sources;
+	for (obs_source_t *source : sources) {
+		if (!isSceneType(source) && !enum_proc(param, source)) {
+			break;
+		}
+	}
+}
+
+void obs_enum_scenes(bool (*enum_proc)(void *, obs_source_t *), void *param)
+{
+	std::vector<obs_source_t *> sources = s_sources;
+	for (obs_source_t *source : sources) {
+		if (isSceneType(source) && !enum_proc(param, source)) {
+			break;
+		}
+	}
+}
+
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source)
+{
+	if (!source) {
+		return nullptr;
+	}
+	if (!source->weak) {
+		source->weak = new obs_weak_source;
+		source->weak->source = source;
+	}
+	source->weak->refs++;
+	grant();
+	return source->weak;
+}
+
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak)
+{
+	return weak ? obs_source_get_ref(weak->source) : nullptr;
+}
+
+void obs_weak_source_release(obs_weak_source_t *weak)
+{
+	if (!weak) {
+		return;
+	}
+	revoke();
+	if (--weak->refs == 0 && !weak->source) {
+		delete weak;
+	}
+}
+
+obs_source_t *obs_transition_get_source(obs_source_t *transition, enum obs_transition_target target)
+{
+	if (!transition || target != OBS_TRANSITION_SOURCE_B) {
+		return nullptr;
+	}
+	return obs_source_get_ref(s_previewScene ? s_previewScene : s_currentScene);
+}
+
+obs_scene_t *obs_scene_from_source(const obs_source_t *source)
+{
+	return source && source->id == "scene" ? source->scene : nullptr;
+}
+
+obs_source_t *obs_scene_get_source(const obs_scene_t *scene)
+{
+	return scene ? scene->source : nullptr;
+}
+
+obs_sceneitem_t *obs_scene_add(obs_scene_t *scene, obs_source_t *source)
+{
+	if (!scene || !source) {
+		return nullptr;
+	}
+	obs_sceneitem_t *item = new obs_scene_item;
+	item->parent = scene;
+	item->source = source;
+	sourceAddRef(source);
+	scene->items.push_back(item);
+	return item;
+}
+
+obs_sceneitem_t *obs_scene_find_source_recursive(obs_scene_t *scene, const char *name)
+{
+	if (!scene || !name) {
+		return nullptr;
+	}
+	for (obs_sceneitem_t *item : scene->items) {
+		if (item->source->name == name) {
+			return item;
+		}
+		if (item->source->scene) {
+			if (obs_sceneitem_t *found = obs_scene_find_source_recursive(item->source->scene, name)) {
+				return found;
+			}
+		}
+	}
+	return nullptr;
+}
+
+void obs_scene_enum_items(obs_scene_t *scene, bool (*callback)(obs_scene_t *, obs_sceneitem_t *, void *),
+			  void *param)
+{
+	if (!scene) {
+		return;
+	}
+	std::vector<obs_sceneitem_t *> items = scene->items;
+	for (obs_sceneitem_t *item : items) {
+		if (!callback(scene, item, param)) {
+			break;
+		}
+	}
+}
+
+void obs_scene_atomic_update(obs_scene_t *scene, void (*func)(void *data, obs_scene_t *scene), void *data)
+{
+	if (scene) {
+		func(data, scene);
+	}
+}
+
+obs_sceneitem_t *obs_scene_get_group(obs_scene_t *scene, const char *name)
+{
+	if (!scene || !name) {
+		return nullptr;
+	}
+	for (obs_sceneitem_t *item : scene->items) {
+		if (item->source->id == "group" && item->source->name == name) {
+			return item;
+		}
+	}
+	return nullptr;
+}
+
+obs_sceneitem_t *obs_scene_add_group2(obs_scene_t *scene, const char *name, bool)
+{
+	if (!scene) {
+		return nullptr;
+	}
+	obs_source_t *group = listSource(newSource("group", name, nullptr));
+	return obs_scene_add(scene, group);
+}
+
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item)
+{
+	return item ? item->source : nullptr;
+}
+
+bool obs_sceneitem_is_group(obs_sceneitem_t *item)
+{
+	return item && item->source->id == "group";
+}
+
+void obs_sceneitem_group_add_item(obs_sceneitem_t *group, obs_sceneitem_t *item)
+{
+	if (!obs_sceneitem_is_group(group) || !item) {
+		return;
+	}
+	auto &items = item->parent->items;
+	items.erase(std::remove(items.begin(), items.end(), item), items.end());
+	item->parent = group->source->scene;
+	item->parent->items.push_back(item);
+}
+
+void obs_sceneitem_group_enum_items(obs_sceneitem_t *group,
+				    bool (*callback)(obs_scene_t *, obs_sceneitem_t *, void *), void *param)
+{
+	if (obs_sceneitem_is_group(group)) {
+		obs_scene_enum_items(group->source->scene, callback, param);
+	}
+}
+
+// Properties
+
+obs_property_t *obs_properties_get(obs_properties_t *props, const char *property)
+{
+	if (!props || !property) {
+		return nullptr;
+	}
+	for (obs_property &candidate : props->properties) {
+		if (candidate.name == property) {
+			return &candidate;
+		}
+	}
+	return nullptr;
+}
+
+void obs_properties_destroy(obs_properties_t *props)
+{
+	delete props;
+}
+
+enum obs_property_type obs_property_get_type(obs_property_t *p)
+{
+	return p ? p->type : OBS_PROPERTY_INVALID;
+}
+
+bool obs_property_button_clicked(obs_property_t *p, void *obj)
+{
+	if (!p || p->type != OBS_PROPERTY_BUTTON || !obj) {
+		return false;
+	}
+	if (p->name == "refreshnocache") {
+		static_cast<obs_source_t *>(obj)->reloads++;
+	}
+	return false;
+}
+
+// Outputs: nothing streams in a test, so these are never handed out
+
+void obs_output_release(obs_output_t *) {}
+
+int obs_output_get_total_frames(const obs_output_t *)
+{
+	return 0;
+}
+
+int obs_output_get_frames_dropped(const obs_output_t *)
+{
+	return 0;
+}
+
+float obs_output_get_congestion(obs_output_t *)
+{
+	return 0.0f;
+}
+
+signal_handler_t *obs_get_signal_handler(void)
+{
+	if (!s_signals) {
+		s_signals = new signal_handler;
+	}
+	return s_signals;
+}
+
+proc_handler_t *obs_get_proc_handler(void)
+{
+	if (!s_procs) {
+		s_procs = new proc_handler;
+	}
+	return s_procs;
+}
+
+// Frontend, except for the Qt objects (obs-frontend-stub.cpp)
+
+struct config_data {
+	std::map<std::string, std::string> values;
+};
+
+static std::vector<std::pair<obs_frontend_event_cb, void *>> s_frontendCallbacks;
+static std::vector<std::pair<obs_frontend_cb, void *>> s_toolsMenuItems;
+static config_data s_userConfig;
+static bool s_userConfigAvailable = true;
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+	s_frontendCallbacks.emplace_back(callback, private_data);
+}
+
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+	auto it = std::find(s_frontendCallbacks.begin(), s_frontendCallbacks.end(),
+			    std::make_pair(callback, private_data));
+	if (it != s_frontendCallbacks.end()) {
+		s_frontendCallbacks.erase(it);
+	}
+}
+
+void obs_frontend_add_tools_menu_item(const char *, obs_frontend_cb callback, void *private_data)
+{
+	s_toolsMenuItems.emplace_back(callback, private_data);
+}
+
+obs_source_t *obs_frontend_get_current_scene(void)
+{
+	return obs_source_get_ref(s_currentScene);
+}
+
+obs_source_t *obs_frontend_get_current_preview_scene(void)
+{
+	return s_studioMode ? obs_source_get_ref(s_previewScene) : nullptr;
+}
+
+obs_source_t *obs_frontend_get_current_transition(void)
+{
+	if (!s_transition) {
+		s_transition = newSource("fade_transition", "Fade", nullptr);
+	}
+	return obs_source_get_ref(s_transition);
+}
+
+bool obs_frontend_preview_program_mode_active(void)
+{
+	return s_studioMode;
+}
+
+bool obs_frontend_streaming_active(void)
+{
+	return false;
+}
+
+bool obs_frontend_recording_active(void)
+{
+	return false;
+}
+
+obs_output_t *obs_frontend_get_streaming_output(void)
+{
+	return nullptr;
+}
+
+config_t *obs_frontend_get_user_config(void)
+{
+	return s_userConfigAvailable ? &s_userConfig : nullptr;
+}
+
+const char *config_get_string(config_t *config, const char *section, const char *name)
+{
+	if (!config || !section || !name) {
+		return nullptr;
+	}
+	auto it = config->values.find(std::string(section) + '/' + name);
+	return it == config->values.end() ? nullptr : it->second.c_str();
+}
+
+void config_set_string(config_t *config, const char *section, const char *name, const char *value)
+{
+	if (config && section && name) {
+		config->values[std::string(section) + '/' + name] = value ? value : "";
+	}
+}
+
+int config_save_safe(config_t *config, const char *, const char *)
+{
+	return config ? CONFIG_SUCCESS : CONFIG_ERROR;
+}
+
+// Module paths, memory, time and logging
+
+static std::string s_configDir = (std::filesystem::temp_directory_path() / "holyrics-finder-stub").string();
+static std::map<int, int> s_logCounts;
+
+char *obs_module_config_path(const char *file)
+{
+	std::string path = s_configDir + '/' + (file ? file : "");
+	return bstrdup(path.c_str());
+}
+
+void *bmalloc(size_t size)
+{
+	return malloc(size ? size : 1);
+}
+
+void bfree(void *ptr)
+{
+	free(ptr);
+}
+
+char *bstrdup(const char *str)
+{
+	if (!str) {
+		return nullptr;
+	}
+	size_t length = strlen(str);
+	char *copy = static_cast<char *>(bmalloc(length + 1));
+	memcpy(copy, str, length + 1);
+	return copy;
+}
+
+uint64_t os_gettime_ns(void)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+						     std::chrono::steady_clock::now().time_since_epoch())
+						     .count());
+}
+
+int os_mkdirs(const char *path)
+{
+	std::error_code error;
+	if (std::filesystem::is_directory(path, error)) {
+		return 1;
+	}
+	return std::filesystem::create_directories(path, error) ? 0 : -1;
+}
+
+void blogva(int log_level, const char *format, va_list args)
+{
+	s_logCounts[log_level]++;
+	if (getenv("OBS_STUB_VERBOSE")) {
+		vfprintf(stderr, format, args);
+		fputc('\n', stderr);
+	}
+}
+
+void blog(int log_level, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	blogva(log_level, format, args);
+	va_end(args);
+}
+
+// Test controls
+
+namespace ObsStub {
+
+void reset()
+{
+	// Sources the plugin still holds stay alive; outstandingReferences()
+	// is how a test finds out about them
+	for (obs_source_t *source : s_sources) {
+		sourceRelease(source);
+	}
+	s_sources.clear();
+	sourceRelease(s_transition);
+	s_transition = nullptr;
+	s_previewScene = nullptr;
+	s_studioMode = false;
+
+	delete s_signals;
+	s_signals = nullptr;
+	delete s_procs;
+	s_procs = nullptr;
+
+	s_frontendCallbacks.clear();
+	s_toolsMenuItems.clear();
+	s_userConfig.values.clear();
+	s_userConfigAvailable = true;
+	s_logCounts.clear();
+	s_outstanding = 0;
+
+	s_currentScene = addScene("Scene");
+}
+
+obs_source_t *addSource(const char *id, const char *name, obs_data_t *settings)
+{
+	obs_source_t *source = listSource(newSource(id, name, settings));
+	if (s_currentScene && !isSceneType(source)) {
+		obs_scene_add(s_currentScene->scene, source);
+	}
+	return source;
+}
+
+obs_source_t *addBrowserSource(const char *name, const char *url)
+{
+	obs_data_t *settings = new obs_data;
+	obs_data_set_string(settings, "url", url);
+	obs_data_set_int(settings, "width", 1920);
+	obs_data_set_int(settings, "height", 1080);
+	obs_source_t *source = addSource("browser_source", name, settings);
+	dataRelease(settings);
+	return source;
+}
+
+obs_source_t *addScene(const char *name)
+{
+	return listSource(newSource("scene", name, nullptr));
+}
+
+obs_sceneitem_t *addToScene(obs_source_t *scene, obs_source_t *source)
+{
+	return obs_scene_add(scene ? scene->scene : nullptr, source);
+}
+
+obs_source_t *currentScene()
+{
+	return s_currentScene;
+}
+
+void setShowing(obs_source_t *source, bool showing)
+{
+	if (source) {
+		source->showing = showing;
+	}
+}
+
+void setStudioMode(bool active, obs_source_t *previewScene)
+{
+	s_studioMode = active;
+	s_previewScene = active ? previewScene : nullptr;
+}
+
+void setConfigDir(const std::string &path)
+{
+	s_configDir = path;
+}
+
+void setUserConfigAvailable(bool available)
+{
+	s_userConfigAvailable = available;
+}
+
+void sendFrontendEvent(enum obs_frontend_event event)
+{
+	// Copied: callbacks remove themselves (and others) while handling EXIT
+	auto callbacks = s_frontendCallbacks;
+	for (const auto &callback : callbacks) {
+		callback.first(event, callback.second);
+	}
+}
+
+size_t frontendCallbackCount()
+{
+	return s_frontendCallbacks.size();
+}
+
+size_t toolsMenuItemCount()
+{
+	return s_toolsMenuItems.size();
+}
+
+void triggerToolsMenuItem(size_t index)
+{
+	if (index < s_toolsMenuItems.size()) {
+		s_toolsMenuItems[index].first(s_toolsMenuItems[index].second);
+	}
+}
+
+size_t signalConnectionCount()
+{
+	size_t count = 0;
+	auto countIn = [&count](const signal_handler_t &handler) {
+		for (const auto &entry : handler.connections) {
+			count += entry.second.size();
+		}
+	};
+	if (s_signals) {
+		countIn(*s_signals);
+	}
+	for (obs_source_t *source : s_sources) {
+		countIn(source->signals);
+	}
+	if (s_transition) {
+		countIn(s_transition->signals);
+	}
+	return count;
+}
+
+long long outstandingReferences()
+{
+	return s_outstanding;
+}
+
+size_t sourceCount()
+{
+	return static_cast<size_t>(std::count_if(s_sources.begin(), s_sources.end(),
+						 [](obs_source_t *source) { return !isSceneType(source); }));
+}
+
+static obs_source_t *listedSource(const char *name)
+{
+	for (obs_source_t *source : s_sources) {
+		if (name && source->name == name) {
+			return source;
+		}
+	}
+	return nullptr;
+}
+
+int updateCount(const char *sourceName)
+{
+	obs_source_t *source = listedSource(sourceName);
+	return source ? source->updates : 0;
+}
+
+int reloadCount(const char *sourceName)
+{
+	obs_source_t *source = listedSource(sourceName);
+	return source ? source->reloads : 0;
+}
+
+int logCount(int level)
+{
+	auto it = s_logCounts.find(level);
+	return it == s_logCounts.end() ? 0 : it->second;
+}
+
+} // namespace ObsStub
@@ -0,0 +1,64 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#pragma once
+
+#include <obs.h>
+#include <obs-frontend-api.h>
+#include <string>
+
+// What a test can set up in the libobs stand-in and read back from it.
+// Pointers returned here are borrowed: the stand-in keeps the reference.
+namespace ObsStub {
+
+// Drops every source, scene, callback and setting and starts over with one
+// empty current scene called "Scene"
+void reset();
+
+obs_source_t *addSource(const char *id, const char *name, obs_data_t *settings = nullptr);
+obs_source_t *addBrowserSource(const char *name, const char *url);
+obs_source_t *addScene(const char *name);
+obs_sceneitem_t *addToScene(obs_source_t *scene, obs_source_t *source);
+obs_source_t *currentScene();
+void setShowing(obs_source_t *source, bool showing);
+void setStudioMode(bool active, obs_source_t *previewScene = nullptr);
+
+// Where obs_module_config_path() points
+void setConfigDir(const std::string &path);
+// With false, obs_frontend_get_user_config() returns null, as it does
+// before OBS has loaded a profile, so user.ini is read from disk
+void setUserConfigAvailable(bool available);
+
+// Runs the callbacks registered with obs_frontend_add_event_callback()
+void sendFrontendEvent(enum obs_frontend_event event);
+size_t frontendCallbackCount();
+size_t toolsMenuItemCount();
+// Runs the callback of the index-th item added with
+// obs_frontend_add_tools_menu_item(), as a click would
+void triggerToolsMenuItem(size_t index);
+size_t signalConnectionCount();
+
+// References handed to the plugin and not released yet: sources, weak
+// sources, settings objects and outputs together. Zero after a clean teardown.
+long long outstandingReferences();
+
+size_t sourceCount();
+int updateCount(const char *sourceName);
+int reloadCount(const char *sourceName);
+
+// Lines logged at `level` since the last reset; printed too when
+// OBS_STUB_VERBOSE is set
+int logCount(int level);
+
+// Defined next to the Qt parts of the frontend; deletes the main window
+// handed out by obs_frontend_get_main_window()
+void destroyMainWindow();
+
+} // namespace ObsStub
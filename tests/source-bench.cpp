@@ -0,0 +1,264 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+// Times the source and dock management paths against collections of 10,
+// 1k and 10k browser sources in the libobs stand-in, and counts heap
+// allocations per operation. --quick runs the small sizes once, as a test.
+
+#include "docks-config.h"
+#include "failover-monitor.h"
+#include "holyrics-dialog.h"
+#include "holyrics-finder.h"
+#include "obs-stub.h"
+#include "source-catalog.h"
+#include "source-governor.h"
+#include "text-mirror.h"
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+
+// Counting malloc catches Qt's containers as well as operator new. The
+// sanitizers replace malloc themselves, so they only get the new count.
+static std::atomic<long long> s_allocations{0};
+
+#if defined(__SANITIZE_ADDRESS__)
+#define BENCH_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define BENCH_ASAN 1
+#endif
+#endif
+
+#if defined(__GLIBC__) && !defined(BENCH_ASAN)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size)
+{
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	return __libc_realloc(ptr, size);
+}
+}
+#else
+void *operator new(size_t size)
+{
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+#endif
+
+static const char *kHolyricsPaths[] = {"/stage-view/text", "/stage-view/text-2", "/stage-view/widescreen"};
+
+static void populateSources(int count)
+{
+	ObsStub::reset();
+
+	// Spread over a few scenes, with some non-Holyrics pages mixed in
+	const int sceneCount = 8;
+	QList<obs_source_t *> scenes;
+	for (int i = 0; i < sceneCount; ++i) {
+		scenes.append(ObsStub::addScene(QString("Scene %1").arg(i).toUtf8().constData()));
+	}
+
+	for (int i = 0; i < count; ++i) {
+		QByteArray name = QString("Holyrics %1").arg(i).toUtf8();
+		QByteArray url = i % 10 == 9 ? QString("https://example.com/overlay/%1").arg(i).toUtf8()
+					     : QString("http://192.168.%1.%2:8091%3")
+						       .arg(i % 3)
+						       .arg(10 + i % 200)
+						       .arg(kHolyricsPaths[i % 3])
+						       .toUtf8();
+		obs_source_t *source = ObsStub::addBrowserSource(name.constData(), url.constData());
+		ObsStub::addToScene(scenes[i % sceneCount], source);
+	}
+}
+
+static QString docksJson(int count)
+{
+	QJsonArray docks;
+	for (int i = 0; i < count; ++i) {
+		QJsonObject dock;
+		dock["title"] = QString("Dock %1").arg(i);
+		dock["url"] = i % 4 == 3 ? QString("https://example.com/chat/%1").arg(i)
+					 : QString("http://192.168.0.%1:8091/stage-view/text").arg(10 + i % 200);
+		dock["uuid"] = QString("00000000-0000-4000-8000-%1").arg(i, 12, 10, QChar('0'));
+		docks.append(dock);
+	}
+	return QString::fromUtf8(QJsonDocument(docks).toJson(QJsonDocument::Compact));
+}
+
+// A user.ini as big as a long-lived OBS profile gets, docks line included
+static bool writeUserIni(const QString &json)
+{
+	QDir().mkpath(DocksConfig::obsConfigPath());
+	QFile file(DocksConfig::obsConfigPath() + "/user.ini");
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+		return false;
+	}
+
+	QTextStream out(&file);
+	for (int section = 0; section < 200; ++section) {
+		out << "[Section" << section << "]\n";
+		for (int key = 0; key < 25; ++key) {
+			out << "Key" << key << "=value-" << section << '-' << key << '\n';
+		}
+	}
+	out << "[BasicWindow]\nExtraBrowserDocks=" << json << '\n';
+	return true;
+}
+
+static void report(const char *operation, int size, const std::function<void()> &run, int minIterations)
+{
+	// Warm once, then repeat for at least 200 ms
+	run();
+
+	int iterations = 0;
+	long long allocations = s_allocations.load();
+	QElapsedTimer timer;
+	timer.start();
+	do {
+		run();
+		iterations++;
+	} while (iterations < minIterations || timer.elapsed() < 200);
+	qint64 elapsedNs = timer.nsecsElapsed();
+	allocations = s_allocations.load() - allocations;
+
+	printf("%-28s %6d %12.3f %14.1f\n", operation, size, elapsedNs / 1e6 / iterations,
+	       double(allocations) / iterations);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+
+	QTemporaryDir home;
+	if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+	// Keeps user.ini and the plugin's settings out of the real profile
+	qputenv("XDG_DATA_HOME", home.path().toUtf8());
+	QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, home.path());
+	QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, home.path());
+
+	QApplication app(argc, argv);
+	ObsStub::setConfigDir(home.path().toStdString());
+	ObsStub::reset();
+
+	HolyricsFinder finder;
+	SourceGovernor governor;
+	TextMirror textMirror;
+	FailoverMonitor failover(&finder);
+	HolyricsDialog dialog(nullptr, &finder, &governor, &textMirror, &failover);
+
+	QList<int> sizes = quick ? QList<int>{10, 1000} : QList<int>{10, 1000, 10000};
+	int minIterations = quick ? 1 : 3;
+
+	printf("%-28s %6s %12s %14s\n", "operation", "size", "ms/op", "allocs/op");
+	for (int size : sizes) {
+		populateSources(size);
+
+		QList<SourceCatalog::RawSource> raw;
+		for (const SourceCatalog::Entry &entry : SourceCatalog::snapshot()) {
+			raw.append({entry.name, entry.url, entry.scenes});
+		}
+
+		report("SourceCatalog::snapshot", size, []() { SourceCatalog::snapshot(); }, minIterations);
+		report("SourceCatalog::build", size, [&raw]() { SourceCatalog::build(raw); }, minIterations);
+		report("refreshSourcesList", size,
+		       [&dialog]() { QMetaObject::invokeMethod(&dialog, "refreshSourcesList", Qt::DirectConnection); },
+		       minIterations);
+		report("onUpdateSources", size,
+		       [&dialog]() {
+			       // "Select matching" with no filter ticks every source
+			       QMetaObject::invokeMethod(&dialog, "onSelectByPredicate", Qt::DirectConnection, Q_ARG(int, 2));
+			       QMetaObject::invokeMethod(&dialog, "onUpdateSources", Qt::DirectConnection);
+		       },
+		       minIterations);
+
+		int port = 8091;
+		report("rebindSources", size,
+		       [&finder, &port]() {
+			       port = port == 8091 ? 8092 : 8091;
+			       finder.rebindSources({}, {"192.168.0.42", port});
+		       },
+		       minIterations);
+		report("createHolyricsSources", size, [&finder]() { finder.createHolyricsSources("192.168.0.42", 8091); },
+		       minIterations);
+
+		QString json = docksJson(size);
+		config_set_string(obs_frontend_get_user_config(), "BasicWindow", "ExtraBrowserDocks", json.toUtf8().constData());
+		if (!writeUserIni(json)) {
+			fprintf(stderr, "could not write %s/user.ini\n", qPrintable(DocksConfig::obsConfigPath()));
+			return 1;
+		}
+
+		QList<DocksConfig::Dock> docks;
+		report("DocksConfig::read (live)", size, [&docks]() { DocksConfig::read(docks); }, minIterations);
+		ObsStub::setUserConfigAvailable(false);
+		report("DocksConfig::read (user.ini)", size, [&docks]() { DocksConfig::read(docks); }, minIterations);
+		ObsStub::setUserConfigAvailable(true);
+		report("refreshDocksList", size,
+		       [&dialog]() { QMetaObject::invokeMethod(&dialog, "refreshDocksList", Qt::DirectConnection); },
+		       minIterations);
+
+		// The load checks queued by the updates above would only hit the network
+		finder.loadVerifier()->cancel();
+
+		if (quick && (docks.size() != size || int(ObsStub::sourceCount()) < size)) {
+			fprintf(stderr, "expected %d docks and sources, got %lld and %lld\n", size,
+				static_cast<long long>(docks.size()), static_cast<long long>(ObsStub::sourceCount()));
+			return 1;
+		}
+	}
+
+	finder.prepareForShutdown();
+	return 0;
+}
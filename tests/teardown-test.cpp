@@ -0,0 +1,192 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "discovery-service.h"
+#include "endpoint-verifier.h"
+#include "failover-monitor.h"
+#include "holyrics-dialog.h"
+#include "holyrics-finder.h"
+#include "network-monitor.h"
+#include "obs-stub.h"
+#include "source-governor.h"
+#include "text-mirror.h"
+#include <obs-module.h>
+#include <QDir>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTest>
+
+// Owned by plugin-main.cpp
+extern HolyricsFinder *g_finder;
+extern HolyricsDialog *g_dialog;
+extern SourceGovernor *g_governor;
+extern TextMirror *g_textMirror;
+extern FailoverMonitor *g_failover;
+extern EndpointVerifier *g_verifier;
+extern NetworkMonitor *g_networkMonitor;
+extern DiscoveryService *g_discovery;
+
+// Loads and unloads the module the way OBS does, EXIT before unload, and
+// checks that nothing it set up outlives it. Build with ENABLE_SANITIZERS
+// to have LeakSanitizer look at the heap as well.
+class TeardownTest : public QObject {
+	Q_OBJECT
+
+private:
+	QTemporaryDir m_dir;
+
+	static bool allGlobalsCleared()
+	{
+		return !g_finder && !g_dialog && !g_governor && !g_textMirror && !g_failover && !g_verifier &&
+		       !g_networkMonitor && !g_discovery;
+	}
+
+	static int openFileDescriptors()
+	{
+		QDir fds("/proc/self/fd");
+		return int(fds.entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size());
+	}
+
+	// One OBS session: load, finish loading with a couple of Holyrics
+	// sources around, open the dialog, exit, close the window, unload
+	static void runSession()
+	{
+		ObsStub::reset();
+		ObsStub::addBrowserSource("Holyrics", "http://192.168.0.20:8091/stage-view/text");
+		ObsStub::addBrowserSource("Holyrics Lower Third", "http://192.168.0.20:8091/stage-view/widescreen");
+
+		QVERIFY(obs_module_load());
+		QCOMPARE(ObsStub::frontendCallbackCount(), size_t(1));
+		ObsStub::sendFrontendEvent(OBS_FRONTEND_EVENT_FINISHED_LOADING);
+		QVERIFY(ObsStub::toolsMenuItemCount() > 0);
+		ObsStub::triggerToolsMenuItem(0);
+		QVERIFY(g_dialog);
+		QTest::qWait(50);
+
+		// OBS may hand EXIT over twice while other plugins tear down
+		ObsStub::sendFrontendEvent(OBS_FRONTEND_EVENT_EXIT);
+		QVERIFY(allGlobalsCleared());
+		ObsStub::sendFrontendEvent(OBS_FRONTEND_EVENT_EXIT);
+
+		QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+		ObsStub::destroyMainWindow();
+		obs_module_unload();
+
+		QVERIFY(allGlobalsCleared());
+		QCOMPARE(ObsStub::outstandingReferences(), 0);
+		QCOMPARE(ObsStub::signalConnectionCount(), size_t(0));
+	}
+
+private slots:
+	void initTestCase()
+	{
+		QVERIFY(m_dir.isValid());
+		QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_dir.path());
+		QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, m_dir.path());
+		ObsStub::setConfigDir(m_dir.path().toStdString());
+	}
+
+	void init() { QSettings("OBS", "HolyricsFinder").clear(); }
+
+	void exitTearsDownInDependencyOrder()
+	{
+		ObsStub::reset();
+		QVERIFY(obs_module_load());
+		ObsStub::sendFrontendEvent(OBS_FRONTEND_EVENT_FINISHED_LOADING);
+		ObsStub::triggerToolsMenuItem(0);
+		QVERIFY(g_dialog);
+
+		QStringList order;
+		auto track = [&order](QObject *object, const QString &name) {
+			QObject::connect(object, &QObject::destroyed, [&order, name]() { order.append(name); });
+		};
+		track(g_dialog, "dialog");
+		track(g_networkMonitor, "network monitor");
+		track(g_discovery, "discovery");
+		track(g_verifier, "verifier");
+		track(g_failover, "failover");
+		track(g_textMirror, "text mirror");
+		track(g_governor, "governor");
+		track(g_finder, "finder");
+
+		ObsStub::sendFrontendEvent(OBS_FRONTEND_EVENT_EXIT);
+
+		// The dialog points at everything and everything points at the
+		// finder, so those two bracket the rest
+		QCOMPARE(order.size(), 8);
+		QCOMPARE(order.first(), QString("dialog"));
+		QCOMPARE(order.last(), QString("finder"));
+		QVERIFY(allGlobalsCleared());
+
+		ObsStub::destroyMainWindow();
+		obs_module_unload();
+		QCOMPARE(ObsStub::outstandingReferences(), 0);
+	}
+
+	void repeatedSessionsLeaveNothingBehind()
+	{
+		// The first session pays for Qt's own one-time setup (network
+		// backends, the offscreen platform), which stays open by design
+		runSession();
+		if (QTest::currentTestFailed()) {
+			return;
+		}
+		int baseline = openFileDescriptors();
+
+		for (int session = 0; session < 5; ++session) {
+			runSession();
+			if (QTest::currentTestFailed()) {
+				return;
+			}
+		}
+
+#ifdef Q_OS_LINUX
+		// A socket or notifier left open per session would show up here
+		QCOMPARE(openFileDescriptors(), baseline);
+#else
+		Q_UNUSED(baseline);
+#endif
+	}
+
+	void unloadWithoutExitLeavesQtAlone()
+	{
+		ObsStub::reset();
+		QVERIFY(obs_module_load());
+		HolyricsFinder *finder = g_finder;
+		SourceGovernor *governor = g_governor;
+		TextMirror *textMirror = g_textMirror;
+		FailoverMonitor *failover = g_failover;
+		EndpointVerifier *verifier = g_verifier;
+		NetworkMonitor *networkMonitor = g_networkMonitor;
+		DiscoveryService *discovery = g_discovery;
+		int warnings = ObsStub::logCount(LOG_WARNING);
+
+		// Qt may already be gone at this point in a real OBS, so unload
+		// only forgets the objects and says so
+		obs_module_unload();
+		QVERIFY(allGlobalsCleared());
+		QCOMPARE(ObsStub::logCount(LOG_WARNING), warnings + 1);
+
+		// Qt is alive here: hand the objects back and let EXIT free them
+		g_finder = finder;
+		g_governor = governor;
+		g_textMirror = textMirror;
+		g_failover = failover;
+		g_verifier = verifier;
+		g_networkMonitor = networkMonitor;
+		g_discovery = discovery;
+		ObsStub::sendFrontendEvent(OBS_FRONTEND_EVENT_EXIT);
+		QVERIFY(allGlobalsCleared());
+		QCOMPARE(ObsStub::outstandingReferences(), 0);
+	}
+};
+
+QTEST_MAIN(TeardownTest)
+#include "teardown-test.moc"
@@ -0,0 +1,257 @@
+/*
+Holyrics Finder Plugin
+Copyright (C) 2024
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+*/
+
+#include "obs-stub.h"
+#include "text-mirror.h"
+#include <QSettings>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QTest>
+
+// Answers like Holyrics' stage view feed: JSON with an ETag, 304 when the
+// client already has the current text, 404 for anything else
+class FakeHolyrics : public QObject {
+	Q_OBJECT
+
+public:
+	FakeHolyrics()
+	{
+		connect(&m_server, &QTcpServer::newConnection, this, &FakeHolyrics::onConnection);
+		m_server.listen(QHostAddress::LocalHost);
+	}
+
+	int port() const { return m_server.serverPort(); }
+
+	void setText(const QString &text)
+	{
+		m_text = text;
+		m_version++;
+	}
+
+	// Hang up on every request, like a Holyrics that is shutting down
+	void setDown(bool down) { m_down = down; }
+
+	int requests = 0;
+	int notModified = 0;
+	QByteArray lastPath;
+
+private slots:
+	void onConnection()
+	{
+		while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+			connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+			connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+		}
+	}
+
+private:
+	QTcpServer m_server;
+	QString m_text;
+	int m_version = 0;
+	bool m_down = false;
+
+	void onReadyRead(QTcpSocket *socket)
+	{
+		QByteArray &buffer = m_buffers[socket];
+		buffer += socket->readAll();
+		if (!buffer.contains("\r\n\r\n")) {
+			return;
+		}
+		QList<QByteArray> lines = buffer.left(buffer.indexOf("\r\n\r\n")).split('\n');
+		m_buffers.remove(socket);
+
+		requests++;
+		if (m_down) {
+			socket->abort();
+			return;
+		}
+
+		lastPath = lines.value(0).split(' ').value(1);
+		QByteArray ifNoneMatch;
+		for (const QByteArray &line : lines) {
+			if (line.toLower().startsWith("if-none-match:")) {
+				ifNoneMatch = line.mid(line.indexOf(':') + 1).trimmed();
+			}
+		}
+
+		QByteArray etag = "\"v" + QByteArray::number(m_version) + "\"";
+		QByteArray response;
+		if (lastPath != "/stage-view/text.json") {
+			response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n";
+		} else if (ifNoneMatch == etag) {
+			notModified++;
+			response = "HTTP/1.1 304 Not Modified\r\nETag: " + etag + "\r\n";
+		} else {
+			QByteArray body = "{\"map\":{\"text\":\"" + m_text.toUtf8() + "\",\"slide\":1}}";
+			response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nETag: " + etag +
+				   "\r\nContent-Length: " + QByteArray::number(body.size()) + "\r\n\r\n" + body;
+		}
+		if (!response.contains("\r\n\r\n")) {
+			response += "\r\n";
+		}
+		socket->write(response);
+		socket->flush();
+	}
+
+	QHash<QTcpSocket *, QByteArray> m_buffers;
+};
+
+class TextMirrorTest : public QObject {
+	Q_OBJECT
+
+private:
+	QTemporaryDir m_settingsDir;
+
+	static QString mirroredText()
+	{
+		obs_source_t *source = obs_get_source_by_name(TextMirror::nativeSourceName().toUtf8().constData());
+		if (!source) {
+			return QString();
+		}
+		obs_data_t *settings = obs_source_get_settings(source);
+		QString text = QString::fromUtf8(obs_data_get_string(settings, "text"));
+		obs_data_release(settings);
+		obs_source_release(source);
+		return text;
+	}
+
+	static int mirroredUpdates() { return ObsStub::updateCount(TextMirror::nativeSourceName().toUtf8().constData()); }
+
+	static int requestsDuring(FakeHolyrics &server, int ms)
+	{
+		int before = server.requests;
+		QTest::qWait(ms);
+		return server.requests - before;
+	}
+
+private slots:
+	void initTestCase()
+	{
+		QVERIFY(m_settingsDir.isValid());
+		QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, m_settingsDir.path());
+		QSettings::setPath(QSettings::NativeFormat, QSettings::UserScope, m_settingsDir.path());
+	}
+
+	void init()
+	{
+		ObsStub::reset();
+		QSettings("OBS", "HolyricsFinder").clear();
+	}
+
+	void cleanup() { QCOMPARE(ObsStub::outstandingReferences(), 0); }
+
+	void extractsTextFromJsonAndHtml()
+	{
+		QCOMPARE(TextMirror::extractText("{\"map\":{\"text\":\" Amazing grace \"}}"), QString("Amazing grace"));
+		QCOMPARE(TextMirror::extractText("[{\"slide\":2},{\"text\":\"How sweet\"}]"), QString("How sweet"));
+		QCOMPARE(TextMirror::extractText("<html><style>p{}</style><body><p>Line one</p><p>Line two</p></body></html>"),
+			 QString("Line one\nLine two"));
+	}
+
+	void mirrorsTextFromTheJsonFeed()
+	{
+		FakeHolyrics server;
+		server.setText("Amazing grace");
+
+		TextMirror mirror;
+		QVERIFY(mirror.start("127.0.0.1", server.port()));
+		QTRY_COMPARE(mirroredText(), QString("Amazing grace"));
+		QCOMPARE(server.lastPath, QByteArray("/stage-view/text.json"));
+
+		server.setText("How sweet the sound");
+		QTRY_COMPARE_WITH_TIMEOUT(mirroredText(), QString("How sweet the sound"), 3000);
+	}
+
+	void unchangedTextLeavesTheSourceAlone()
+	{
+		QSettings("OBS", "HolyricsFinder").setValue("textMirror/pollIntervalMs", 250);
+		FakeHolyrics server;
+		server.setText("Amazing grace");
+
+		TextMirror mirror;
+		QVERIFY(mirror.start("127.0.0.1", server.port()));
+		QTRY_COMPARE(mirroredText(), QString("Amazing grace"));
+		int updates = mirroredUpdates();
+
+		QTRY_VERIFY_WITH_TIMEOUT(server.notModified >= 3, 3000);
+		QCOMPARE(mirroredUpdates(), updates);
+	}
+
+	void pollsOncePerSecondByDefault()
+	{
+		FakeHolyrics server;
+		server.setText("Amazing grace");
+
+		TextMirror mirror;
+		QVERIFY(mirror.start("127.0.0.1", server.port()));
+		QTRY_COMPARE(mirroredText(), QString("Amazing grace"));
+
+		// Three at 1 s; the old 250 ms interval would have made ten
+		int requests = requestsDuring(server, 2500);
+		QVERIFY2(requests >= 1 && requests <= 4, qPrintable(QString::number(requests)));
+	}
+
+	void backsOffWhileHolyricsIsDown()
+	{
+		QSettings("OBS", "HolyricsFinder").setValue("textMirror/pollIntervalMs", 250);
+		FakeHolyrics server;
+		server.setText("Amazing grace");
+
+		TextMirror mirror;
+		QVERIFY(mirror.start("127.0.0.1", server.port()));
+		QTRY_COMPARE(mirroredText(), QString("Amazing grace"));
+
+		// 500, 1000 and 2000 ms apart instead of twelve at 250 ms; Qt may
+		// resend a GET once when a kept-alive connection drops
+		server.setDown(true);
+		int requests = requestsDuring(server, 3000);
+		QVERIFY2(requests <= 8, qPrintable(QString::number(requests)));
+
+		// The last text stays up, and the mirror picks up where it left off
+		QCOMPARE(mirroredText(), QString("Amazing grace"));
+		server.setDown(false);
+		server.setText("How sweet the sound");
+		QTRY_COMPARE_WITH_TIMEOUT(mirroredText(), QString("How sweet the sound"), 5000);
+	}
+
+	void stopEndsPollingForGood()
+	{
+		FakeHolyrics server;
+		server.setText("Amazing grace");
+
+		TextMirror mirror;
+		QVERIFY(mirror.start("127.0.0.1", server.port()));
+		QTRY_COMPARE(mirroredText(), QString("Amazing grace"));
+
+		mirror.stop();
+		QVERIFY(!mirror.isRunning());
+		QCOMPARE(requestsDuring(server, 1500), 0);
+		QCOMPARE(QSettings("OBS", "HolyricsFinder").value("textMirror/enabled").toBool(), false);
+	}
+
+	void restoreResumesTheSavedMirror()
+	{
+		FakeHolyrics server;
+		server.setText("Amazing grace");
+		{
+			TextMirror mirror;
+			QVERIFY(mirror.start("127.0.0.1", server.port()));
+		}
+		// Destroying it isn't stopping it: the next session mirrors again
+		TextMirror mirror;
+		mirror.restore();
+		QVERIFY(mirror.isRunning());
+		QTRY_COMPARE(mirroredText(), QString("Amazing grace"));
+	}
+};
+
+QTEST_MAIN(TextMirrorTest)
+#include "text-mirror-test.moc"